@@ -0,0 +1,107 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+@import XCTest;
+
+#import <SDKMeasurementPlugin/MPDatabaseManager.h>
+#import <SDKMeasurementPlugin/MPEventManager.h>
+
+// Events written by the event manager and read back from a database on disk
+// must keep their type, whether it is stored as a symbol code or as text.
+@interface MPEventStorageTests : XCTestCase
+
+@property (nonatomic, strong) NSURL *storagePath;
+@property (nonatomic, strong) MPDatabaseManager *databaseManager;
+@property (nonatomic, strong) MPEventManager *eventManager;
+
+@end
+
+@implementation MPEventStorageTests
+
+- (void)setUp
+{
+  [super setUp];
+  NSString *fileName = [NSString stringWithFormat:@"MPEventStorageTests-%@.db", [NSUUID UUID].UUIDString];
+  self.storagePath = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+  self.databaseManager = [MPDatabaseManager new];
+  self.databaseManager.storagePath = self.storagePath;
+  self.eventManager = [[MPEventManager alloc] initWithDatabaseManager:self.databaseManager];
+}
+
+- (void)tearDown
+{
+  [[NSFileManager defaultManager] removeItemAtURL:self.storagePath error:nil];
+  [super tearDown];
+}
+
+- (NSArray<MPEvent *> *)roundTripEvents:(NSArray<MPEvent *> *)events
+{
+  __block NSArray<MPEvent *> *storedEvents = nil;
+  XCTestExpectation *expectation = [self expectationWithDescription:@"Round trip"];
+  [self.databaseManager getDatabase:^(sqlite3 *db) {
+    for (MPEvent *event in events) {
+      [self.eventManager insertEvent:event withDatabase:db withCallback:nil];
+    }
+    [self.databaseManager deserializeWithStatementSync:"SELECT * FROM events"
+                                          withDatabase:db
+                               withDeserializeCallback:^id(sqlite3_stmt *pStmt) {
+                                 return [MPEvent deserializeFromSqlite:pStmt];
+                               } withCallback:^(NSMutableArray *array) {
+                                 storedEvents = [array copy];
+                                 [expectation fulfill];
+                               }];
+  }];
+  [self waitForExpectationsWithTimeout:5.0 handler:nil];
+  return storedEvents;
+}
+
+- (void)testEventTypesRoundTrip
+{
+  NSArray<MPEventType> *types = @[MPEventTypeImpression,
+                                   MPEventTypeImpressionMiss,
+                                   MPEventTypeStoreClick,
+                                   MPEventTypeLinkClick,
+                                   MPEventTypeViewReport,
+                                   MPEventTypeVideo,
+                                   MPEventTypeClose,
+                                   MPEventTypeBrowserSession,
+                                   MPEventTypeAdComplete,
+                                   MPEventTypeDebug,
+                                   @"custom_type",
+                                   @"1000"];
+  NSMutableArray<MPEvent *> *events = [NSMutableArray array];
+  NSMutableDictionary<NSUUID *, MPEventType> *typesByEventId = [NSMutableDictionary dictionary];
+  for (MPEventType type in types) {
+    MPEvent *event = [[MPEvent alloc] initWithType:type
+                                      withPriority:MPEventPriorityDeferred
+                                       withTokenId:nil
+                                     withSessionId:[NSUUID UUID]
+                              withSessionStartTime:[NSDate date]
+                                     withExtraData:@{@"vwa": @"0.5"}];
+    [events addObject:event];
+    typesByEventId[event.eventId] = type;
+  }
+
+  NSArray<MPEvent *> *storedEvents = [self roundTripEvents:events];
+  XCTAssertEqual(storedEvents.count, events.count);
+  for (MPEvent *storedEvent in storedEvents) {
+    XCTAssertEqualObjects(storedEvent.type, typesByEventId[storedEvent.eventId]);
+    XCTAssertEqualObjects(storedEvent.extraData, @{@"vwa": @"0.5"});
+  }
+}
+
+@end
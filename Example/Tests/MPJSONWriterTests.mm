@@ -0,0 +1,161 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+@import XCTest;
+
+#import "MPByteBuffer.hpp"
+#import "MPPayloadEncoder.h"
+
+// The event manager stores flat extra data with MPPayloadWriteStringDictionaryJSON
+// and everything else with NSJSONSerialization; both must write the same bytes
+// so stored rows do not depend on which path produced them.
+@interface MPJSONWriterTests : XCTestCase
+
+@end
+
+@implementation MPJSONWriterTests
+
+- (void)assertWritesLikeNSJSONSerialization:(NSDictionary<NSString *, NSString *> *)dictionary
+{
+  NSData *expected = [NSJSONSerialization dataWithJSONObject:dictionary options:(NSJSONWritingOptions)kNilOptions error:nil];
+  mp::ByteBuffer buffer;
+  XCTAssertTrue(MPPayloadWriteStringDictionaryJSON(dictionary, buffer), @"%@ not written", dictionary);
+  NSData *actual = [NSData dataWithBytes:buffer.data() length:buffer.size()];
+  XCTAssertEqualObjects(actual, expected, @"%@ written as %@, expected %@", dictionary,
+                        [[NSString alloc] initWithData:actual encoding:NSUTF8StringEncoding],
+                        [[NSString alloc] initWithData:expected encoding:NSUTF8StringEncoding]);
+}
+
+- (void)testEmptyAndPlain
+{
+  [self assertWritesLikeNSJSONSerialization:@{}];
+  [self assertWritesLikeNSJSONSerialization:@{@"": @""}];
+  [self assertWritesLikeNSJSONSerialization:@{@"key": @"value", @"client_token": @"1234567890|abcdef", @"volume": @"0.5"}];
+}
+
+- (void)testEscapes
+{
+  [self assertWritesLikeNSJSONSerialization:@{@"quote": @"say \"hi\"",
+                                              @"backslash": @"C:\\path\\file",
+                                              @"slash": @"https://example.com/a/b",
+                                              @"whitespace": @"tab\tnewline\nreturn\rformfeed\fbackspace\b",
+                                              @"del": @"\x7f",
+                                              @"key \"with\" / escapes\n": @"value"}];
+}
+
+- (void)testEveryControlCharacter
+{
+  NSMutableDictionary *dictionary = [NSMutableDictionary dictionary];
+  for (unichar character = 0; character < 0x20; character++) {
+    dictionary[[NSString stringWithFormat:@"c%u", character]] = [NSString stringWithFormat:@"<%C>", character];
+  }
+  [self assertWritesLikeNSJSONSerialization:dictionary];
+}
+
+- (void)testUnicode
+{
+  [self assertWritesLikeNSJSONSerialization:@{@"latin": @"üñíçødé",
+                                              @"cjk": @"日本語のテキスト",
+                                              @"emoji": @"😀👍🏽👨‍👩‍👧",
+                                              @"separators": @"\u2028\u2029",
+                                              @"ключ": @"значение"}];
+}
+
+// Non-ASCII strings are transcoded in 512-byte chunks; put multi-byte
+// characters across every chunk boundary offset.
+- (void)testLongStrings
+{
+  for (NSUInteger prefix = 0; prefix < 4; prefix++) {
+    NSMutableString *string = [NSMutableString string];
+    for (NSUInteger i = 0; i < prefix; i++) {
+      [string appendString:@"a"];
+    }
+    for (NSUInteger i = 0; i < 400; i++) {
+      [string appendString:i % 3 == 0 ? @"é" : (i % 3 == 1 ? @"日" : @"😀")];
+    }
+    [self assertWritesLikeNSJSONSerialization:@{string: string}];
+  }
+  NSString *ascii = [@"" stringByPaddingToLength:10000 withString:@"abc/\"\\ " startingAtIndex:0];
+  [self assertWritesLikeNSJSONSerialization:@{@"ascii": ascii}];
+}
+
+- (void)testRandomDictionaries
+{
+  NSArray<NSString *> *pieces = @[@"a", @"Z", @"0", @" ", @"/", @"\"", @"\\", @"\n", @"\t", @"\x01", @"\x1f", @"\x7f",
+                                  @"é", @"ß", @"日", @"😀", @"\u2028", @"%", @"&", @"="];
+  srand48(7);
+  for (NSUInteger round = 0; round < 500; round++) {
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionary];
+    NSUInteger count = (NSUInteger)(drand48() * 8);
+    for (NSUInteger i = 0; i < count; i++) {
+      NSMutableString *key = [NSMutableString string];
+      NSMutableString *value = [NSMutableString string];
+      NSUInteger length = (NSUInteger)(drand48() * 24);
+      for (NSUInteger j = 0; j < length; j++) {
+        [key appendString:pieces[(NSUInteger)(drand48() * pieces.count)]];
+        [value appendString:pieces[(NSUInteger)(drand48() * pieces.count)]];
+      }
+      dictionary[key] = value;
+    }
+    [self assertWritesLikeNSJSONSerialization:dictionary];
+  }
+}
+
+- (void)testRejectsNonStringValues
+{
+  for (NSDictionary *dictionary in @[@{@"number": @1}, @{@"nested": @{@"a": @"b"}}, @{@"null": [NSNull null]}, @{@1: @"one"}]) {
+    mp::ByteBuffer buffer;
+    buffer.append("stale", 5);
+    XCTAssertFalse(MPPayloadWriteStringDictionaryJSON(dictionary, buffer), @"%@", dictionary);
+    XCTAssertEqual(buffer.size(), (size_t)0);
+  }
+}
+
+- (NSDictionary<NSString *, NSString *> *)representativeExtraData
+{
+  return @{@"client_token": @"1234567890|abcdef",
+           @"video_id": @"9876543210",
+           @"url": @"https://example.com/video.mp4?a=1&b=2",
+           @"state": @"playing",
+           @"title": @"Caf\u00e9 \u2014 \u65e5\u672c"};
+}
+
+- (void)testWriterPerformance
+{
+  NSDictionary *extraData = [self representativeExtraData];
+  mp::ByteBuffer buffer;
+  mp::ByteBuffer *bufferPtr = &buffer;
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 10000; i++) {
+      MPPayloadWriteStringDictionaryJSON(extraData, *bufferPtr);
+    }
+  }];
+}
+
+- (void)testNSJSONSerializationPerformance
+{
+  NSDictionary *extraData = [self representativeExtraData];
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 10000; i++) {
+      NSData *data = [NSJSONSerialization dataWithJSONObject:extraData options:(NSJSONWritingOptions)kNilOptions error:nil];
+      (void)[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding].UTF8String;
+    }
+  }];
+}
+
+@end
@@ -0,0 +1,223 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+@import XCTest;
+
+#import <SDKMeasurementPlugin/MPPayloadEncoder.h>
+#import <SDKMeasurementPlugin/MPUtility.h>
+
+// Frozen copy of the string-based form encoder MPPayloadEncoder replaced:
+// +[MPUtility createQueryStringFromParameters:] and its helpers as they were
+// before the rewrite. The encoder must keep producing exactly these bytes.
+static NSString *MPLegacyURLEncodedString(NSString *string)
+{
+  NSMutableString *outputString = [NSMutableString string];
+  const unsigned char *sourceString = (const unsigned char *)string.UTF8String;
+  NSUInteger length = (NSUInteger)strlen((const char *)sourceString);
+  for (NSUInteger i = 0; i < length; ++i) {
+    const unsigned char currentChar = sourceString[i];
+    if (currentChar == ' '){
+      [outputString appendString:@"+"];
+    } else if (currentChar == '.' || currentChar == '-' || currentChar == '_' || currentChar == '~' ||
+               (currentChar >= 'a' && currentChar <= 'z') ||
+               (currentChar >= 'A' && currentChar <= 'Z') ||
+               (currentChar >= '0' && currentChar <= '9')) {
+      [outputString appendFormat:@"%c", currentChar];
+    } else {
+      [outputString appendFormat:@"%%%02X", currentChar];
+    }
+  }
+  return outputString;
+}
+
+static NSString *MPLegacyJSONString(id obj)
+{
+  @try {
+    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:obj options:(NSJSONWritingOptions)kNilOptions error:nil];
+    if (jsonData) {
+      return [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
+    }
+  }
+  @catch (...) {
+  }
+  return nil;
+}
+
+static NSString *MPLegacyRecoveredString(id object)
+{
+  if (!object) {
+    return nil;
+  } else if ([object isKindOfClass:[NSNumber class]]) {
+    return ((NSNumber *)object).stringValue;
+  } else if ([object isKindOfClass:[NSString class]]) {
+    return object;
+  } else if ([object isKindOfClass:[NSDictionary class]]) {
+    return MPLegacyJSONString(object) ?: @"";
+  }
+  return nil;
+}
+
+static NSString *MPLegacyQueryParameter(id key, id obj)
+{
+  NSString *value = MPLegacyRecoveredString(obj);
+  return [NSString stringWithFormat:@"%@=%@", MPLegacyURLEncodedString(key), value ? MPLegacyURLEncodedString(value) : nil];
+}
+
+static NSString *MPLegacyQueryString(NSDictionary *parameters)
+{
+  NSMutableString *paramsString = [NSMutableString stringWithString:@""];
+  [parameters enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *parametersStop) {
+    if ([obj isKindOfClass:[NSArray class]]) {
+      [(NSArray *)obj enumerateObjectsUsingBlock:^(id arrayObj, NSUInteger idx, BOOL *objStop) {
+        if (paramsString.length > 0) {
+          [paramsString appendString:@"&"];
+        }
+        [paramsString appendString:MPLegacyQueryParameter([NSString stringWithFormat:@"%@[]", key], arrayObj)];
+      }];
+    } else {
+      if (paramsString.length > 0) {
+        [paramsString appendString:@"&"];
+      }
+      [paramsString appendString:MPLegacyQueryParameter(key, obj)];
+    }
+  }];
+  return [NSString stringWithString:paramsString];
+}
+
+@interface MPPayloadEncoderTests : XCTestCase
+
+@end
+
+@implementation MPPayloadEncoderTests
+
+- (void)assertEncodesLikeLegacy:(NSDictionary *)parameters
+{
+  NSData *expected = [MPLegacyQueryString(parameters) dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *actual = [MPPayloadEncoder formEncodedDataFromParameters:parameters];
+  XCTAssertEqualObjects(actual, expected, @"%@ encoded as %@, expected %@", parameters,
+                        [[NSString alloc] initWithData:actual encoding:NSASCIIStringEncoding],
+                        [[NSString alloc] initWithData:expected encoding:NSASCIIStringEncoding]);
+  XCTAssertEqualObjects([MPUtility createQueryStringFromParameters:parameters], MPLegacyQueryString(parameters));
+}
+
+- (void)testEmpty
+{
+  [self assertEncodesLikeLegacy:@{}];
+}
+
+- (void)testStrings
+{
+  NSString *withNul = [NSString stringWithFormat:@"before%Cafter", (unichar)0];
+  [self assertEncodesLikeLegacy:@{@"plain": @"hello world",
+                                  @"reserved": @"a&b=c/d?e#f+g%h",
+                                  @"unreserved": @"AZaz09.-_~",
+                                  @"unicode": @"üñí©ødé 😀 日本語",
+                                  @"control": @"tab\tnewline\nreturn\r",
+                                  @"empty": @"",
+                                  @"nul": withNul,
+                                  @"key with spaces & symbols": @"value"}];
+}
+
+- (void)testNumbers
+{
+  [self assertEncodesLikeLegacy:@{@"zero": @0,
+                                  @"negative": @-42,
+                                  @"int64": @(INT64_MAX),
+                                  @"uint64": @(UINT64_MAX),
+                                  @"pi": @3.14159265358979,
+                                  @"tenth": @0.1,
+                                  @"large": @1e20,
+                                  @"float": @1.5f,
+                                  @"yes": @YES,
+                                  @"no": @NO}];
+}
+
+- (void)testUnsupportedValues
+{
+  [self assertEncodesLikeLegacy:@{@"null": [NSNull null],
+                                  @"date": [NSDate dateWithTimeIntervalSince1970:0],
+                                  @"data": [NSData data],
+                                  @"set": [NSSet setWithObject:@"a"]}];
+}
+
+- (void)testArrays
+{
+  [self assertEncodesLikeLegacy:@{@"mixed": @[@"a b", @1, @2.5, [NSNull null], @{@"k": @"v"}, @[@"nested"]],
+                                  @"empty": @[]}];
+}
+
+- (void)testDictionaries
+{
+  [self assertEncodesLikeLegacy:@{@"json": @{@"string": @"quote\" backslash\\ slash/ tab\t bell\a",
+                                             @"unicode": @"üñí 😀",
+                                             @"int": @123456789012,
+                                             @"double": @0.30000000000000004,
+                                             @"exponent": @1e-7,
+                                             @"bool": @YES,
+                                             @"null": [NSNull null],
+                                             @"array": @[@1, @"two", @[], @{}],
+                                             @"object": @{@"inner": @{@"deeper": @"value"}}},
+                                  @"empty": @{}}];
+}
+
+- (void)testInvalidDictionariesEncodeEmpty
+{
+  [self assertEncodesLikeLegacy:@{@"date": @{@"when": [NSDate date]}}];
+  [self assertEncodesLikeLegacy:@{@"nan": @{@"value": @(NAN)}}];
+  [self assertEncodesLikeLegacy:@{@"infinity": @{@"value": @[@(INFINITY)]}}];
+  [self assertEncodesLikeLegacy:@{@"numberKey": @{@1: @"one"}}];
+}
+
+// A batch of 1,000 events shaped like the ones the event manager sends.
+- (NSDictionary *)representativePayload
+{
+  NSMutableArray *events = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 1000; i++) {
+    [events addObject:@{@"id": [NSUUID UUID].UUIDString,
+                        @"type": @"video_progress",
+                        @"time": @(1539900000.123 + i),
+                        @"session_time": @(i * 0.25),
+                        @"data": @{@"client_token": @"1234567890|abcdef",
+                                   @"volume": @0.5,
+                                   @"viewable": @YES,
+                                   @"url": @"https://example.com/video.mp4?a=1&b=2"}}];
+  }
+  return @{@"events": events, @"access_token": @"1234567890|abcdef", @"format": @"json"};
+}
+
+- (void)testEncoderPerformance
+{
+  NSDictionary *payload = [self representativePayload];
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 5; i++) {
+      [MPPayloadEncoder formEncodedDataFromParameters:payload];
+    }
+  }];
+}
+
+- (void)testLegacyEncoderPerformance
+{
+  NSDictionary *payload = [self representativePayload];
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 5; i++) {
+      [MPLegacyQueryString(payload) dataUsingEncoding:NSUTF8StringEncoding];
+    }
+  }];
+}
+
+@end
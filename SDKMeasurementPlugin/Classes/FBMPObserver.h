@@ -19,8 +19,16 @@
 #import <Foundation/Foundation.h>
 @import AVFoundation;
 
+/**
+ Measures every registered AVPlayer separately, each with its own logger and
+ playback state. Registering a player again starts it over. Players are held
+ weakly; a player's session ends when it is deallocated.
+ */
 @interface FBMPObserver : NSObject
 + (instancetype)shareInstance;
+// @"player": the AVPlayer, @"playerView": the UIView it plays in
 - (void)registerObjects:(NSDictionary *)dict;
+// Stops measuring the player and removes the observers added to it
+- (void)unregisterPlayer:(AVPlayer *)player;
 @end
 
@@ -16,24 +16,36 @@
 // IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
-#import "FBMPObserver.h"
-#import "MPVideoLogger.h"
-#import "MPVideoLoggingEvent.h"
-#import "MPDynamicFrameworkLoader.h"
+#import "FBMPObserver+Internal.h"
+#import "FBMPPlayerSession.h"
+#import "MPConfigManager.h"
+#import "MPDefines+Internal.h"
+
+// Associated with each registered player and released with it
+@interface FBMPPlayerReleaseObserver : NSObject
+@property (nonatomic, copy) dispatch_block_t releaseBlock;
+@end
+
+@implementation FBMPPlayerReleaseObserver
+
+- (void)dealloc
+{
+  dispatch_block_t releaseBlock = _releaseBlock;
+  if (releaseBlock) {
+    dispatch_async(dispatch_get_main_queue(), releaseBlock);
+  }
+}
 
-static NSString * const kToken = @"brightcove";
-//static NSString * const kToken = @"_nc_client_token=";
-//static NSString * const kToken = @"redirector";
+@end
 
 @interface FBMPObserver ()
-@property (nonatomic) AVPlayer* player; //observable objects
-@property (nonatomic) AVPlayerItem* playerItem; //observable objects
-@property (nonatomic, strong) UIControl *skipButton; //TBD
-@property (nonatomic) StateType state;
-@property (nonatomic, strong) MPVideoLogger *mpLogger;
-@property (nonatomic, strong) id progressTimeObserver;
-@property (nonatomic) BOOL seeking;
-@property (nonatomic) BOOL continued;
+// Sessions hold their players weakly, so registering does not keep a player
+// alive. A weak-keyed NSMapTable would keep the session of a released player
+// until the table resizes; with only a few players a list is enough.
+@property (nonatomic, strong) NSMutableArray<FBMPPlayerSession *> *sessions;
+// Shared by the sessions, so an item is only matched once
+@property (nonatomic, strong, nullable) MPClientTokenMatcher *tokenMatcher;
+@property (nonatomic, copy, nullable) NSString *tokenMatcherConfiguredPattern;
 @end
 
 
@@ -50,212 +62,67 @@ static FBMPObserver* _instance = nil;
   return _instance ;
 }
 
-- (void)registerObjects:(NSDictionary *)dict {
-  self.player = [dict objectForKey:@"player"];
-  self.mpLogger = (MPVideoLogger *)[[MPVideoLogger alloc] initWithTargetView:[dict objectForKey:@"playerView"]
-                                                           targetVolumeBlock:[self getTargetVolumeBlock]
-                                                                    autoplay:true];
-
-  [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(jumpNotification:) name:AVPlayerItemTimeJumpedNotification object:nil];
-  [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(itemDidFinishPlaying:) name:AVPlayerItemDidPlayToEndTimeNotification object:nil];
-
-  [self.player addObserver:self forKeyPath:@"rate" options:0 context:nil];
-  [self.skipButton addObserver:self forKeyPath:@"highlighted" options:0 context:nil];
-}
-
-- (void)addProgressTimeObserverIfNot
+- (instancetype)init
 {
-  if (!self.progressTimeObserver) {
-    [self.player addObserver:self forKeyPath:@"rate" options:0 context:nil];
-    weakify(self);
-    self.progressTimeObserver = [self addPeriodicTimeObserverForInterval:mpsdk_dfl_CMTimeMakeWithSeconds((NSTimeInterval)0.2, 1000)
-                                                                   queue:dispatch_get_main_queue()
-                                                              usingBlock:^(CMTime time) {
-                                                                strongify(self);
-                                                                [self.mpLogger registerProgressForPlayerItem:self.playerItem state:self.state];
-                                                              }];
+  self = [super init];
+  if (self) {
+    _sessions = [NSMutableArray new];
   }
+  return self;
 }
 
-
-- (id)addPeriodicTimeObserverForInterval:(CMTime)interval
-                                   queue:(nullable dispatch_queue_t)queue
-                              usingBlock:(void (^)(CMTime time))block
-{
-  return [self.player addPeriodicTimeObserverForInterval:interval
-                                                   queue:queue
-                                              usingBlock:block];
-}
-
--(void)itemDidFinishPlaying:(NSNotification *) notification {
-  AVPlayerItem *playerItem = notification.object;
-  AVAsset *currentPlayerAsset = playerItem.asset;
-  if (![currentPlayerAsset isKindOfClass:AVURLAsset.class] || [(AVURLAsset *)currentPlayerAsset URL] == nil) return;
-  
-  NSURL *url = [(AVURLAsset *)currentPlayerAsset URL];
-  if ([self extractClientTokenFrom:url.absoluteString] == nil) {
+- (void)registerObjects:(NSDictionary *)dict {
+  AVPlayer *player = [dict objectForKey:@"player"];
+  UIView *playerView = [dict objectForKey:@"playerView"];
+  if (!player || !playerView) {
     return;
   }
-  if (self.state != kStateTypeComplete) {
-    [self.mpLogger registerComplete:[self.playerItem currentTime]];
-    NSLog(@"MP Complete playing at time: %f", mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]));
-    self.state = kStateTypeComplete;
+  [self removeSessionsOfReleasedPlayers];
+  [self unregisterPlayer:player];
+  FBMPPlayerSession *session = [[FBMPPlayerSession alloc] initWithPlayer:player targetView:playerView];
+  [self.sessions addObject:session];
+  if (!objc_getAssociatedObject(player, @selector(removeSessionsOfReleasedPlayers))) {
+    FBMPPlayerReleaseObserver *releaseObserver = [FBMPPlayerReleaseObserver new];
+    weakify(self);
+    releaseObserver.releaseBlock = ^{
+      strongify(self);
+      [self removeSessionsOfReleasedPlayers];
+    };
+    objc_setAssociatedObject(player, @selector(removeSessionsOfReleasedPlayers), releaseObserver, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
   }
 }
 
--(void)jumpNotification:(NSNotification *)notification
-{
-  //   Will be called when AVPlayer seek to a new point
-  if(![notification.object isKindOfClass:AVPlayerItem.class]) {
-    return;
-  }
-  
-  AVPlayerItem *playerItem = notification.object;
-  AVAsset *currentPlayerAsset = playerItem.asset;
-  if (![currentPlayerAsset isKindOfClass:AVURLAsset.class] || [(AVURLAsset *)currentPlayerAsset URL] == nil) return;
-  
-  NSURL *url = [(AVURLAsset *)currentPlayerAsset URL];
-  if ([self extractClientTokenFrom:url.absoluteString] == nil) {
-    return;
-  }
-  
-  self.playerItem = playerItem;
-  self.player = [playerItem valueForKey:@"player"];
-  
-  [self.mpLogger updateInlineClientToken:[self extractClientTokenFrom:url.absoluteString]];
-  [self addProgressTimeObserverIfNot];
-  [self.mpLogger updateTargetVolumeBlock:[self getTargetVolumeBlock]];
-  
-  NSTimeInterval currentTime = mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]);
-  if (currentTime == 0.0) {
-    if (self.state != kStateTypeResume) {
-      if (self.state == kStateTypeComplete) {
-        self.continued = YES;
-      }
-      [self.mpLogger registerResume:[self.playerItem currentTime]];
-      NSLog(@"MP(notification) Resume to play at time: %f", mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]));
-      self.state = kStateTypeResume;
-    }
-  } else if (self.state == kStateTypeJump){
-    self.state = kStateTypeDoubleJump;
-  } else {
-    self.state = kStateTypeJump;
-  }
+- (void)unregisterPlayer:(AVPlayer *)player {
+  [self removeSessionsPassingTest:^BOOL(FBMPPlayerSession *session) {
+    return session.player == player;
+  }];
 }
 
-- (MPVideoLoggerTargetVolumeBlock) getTargetVolumeBlock {
-  weakify(self);
-  MPVideoLoggerTargetVolumeBlock targetVolumeBlock = ^float{
-    strongify(self);
-    return self.player.volume;
-  };
-  return targetVolumeBlock;
+- (void)removeSessionsOfReleasedPlayers {
+  [self removeSessionsPassingTest:^BOOL(FBMPPlayerSession *session) {
+    return session.player == nil;
+  }];
 }
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context {
-  // skip button
-  if ([object isKindOfClass:UIControl.class]) {
-    if ([keyPath isEqualToString:@"highlighted"]) {
-      NSLog(@"MP Skip");
-      [self.mpLogger registerSkip:[self.playerItem currentTime]];
-    }
-    return;
-  }
-  
-  AVPlayer *player = object;
-  AVAsset *currentPlayerAsset = [player currentItem].asset;
-  if (![currentPlayerAsset isKindOfClass:AVURLAsset.class] || [(AVURLAsset *)currentPlayerAsset URL] == nil) return;
-  
-  NSURL *url = [(AVURLAsset *)currentPlayerAsset URL];
-  if ([self extractClientTokenFrom:url.absoluteString] == nil) {
-    return;
-  }
-
-  if (!self.playerItem) {
-    self.playerItem = [self.player currentItem];
-  }
-  NSTimeInterval currentTime = mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]);
-  [self addProgressTimeObserverIfNot];
-//  NSLog(@"MP(observer) called at: %f", currentTime);
-  if ([keyPath isEqualToString:@"rate"]) {
-    if (currentTime <= 0.000000 || [self.player rate]) {
-      if (self.state == kStateTypePause) {
-        self.state = kStateTypeResume;
-        [self.mpLogger registerResume:[self.playerItem currentTime]];
-        NSLog(@"MP(observer) Resume to play at: %f", currentTime);
-      }
-      [NSTimer scheduledTimerWithTimeInterval:0.9
-                                       target:self
-                                     selector:@selector(checkSeekEnd:)
-                                     userInfo:@{@"scheduledTime": @(currentTime)}
-                                      repeats:NO];
-    } else if (self.state != kStateTypeComplete) {
-      if (self.state != kStateTypePause && self.state != kStateTypeSeekStart) {
-        [NSTimer scheduledTimerWithTimeInterval:0.9
-                                         target:self
-                                       selector:@selector(checkSeekStart:)
-                                       userInfo:@{@"scheduledTime": @(currentTime)}
-                                        repeats:NO];
-      }
-    }
-    return;
-  }
-  
-  if ([keyPath isEqualToString:@"muted"]) {
-    if (self.player.isMuted) {
-      NSLog(@"audio is muted");
-      self.state = kStateTypeMute;
+- (void)removeSessionsPassingTest:(BOOL (^)(FBMPPlayerSession *session))test {
+  NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+  [self.sessions enumerateObjectsUsingBlock:^(FBMPPlayerSession *session, NSUInteger index, BOOL *stop) {
+    if (test(session)) {
+      [session invalidate];
+      [indexes addIndex:index];
     }
-    else {
-      NSLog(@"audio is unmuted");
-      self.state = kStateTypeUnmute;
-    }
-  } else if ([keyPath isEqualToString:@"volume"]){
-    NSLog(@"the volume is changed to %f", self.player.volume);
-    self.state = kStateTypeChangeVolume;
-  }
-}
-
-- (void)checkSeekStart:(NSTimer *)timer {
-  if(self.state == kStateTypeSeekStart || self.state == kStateTypeComplete) return;
-  NSTimeInterval scheduledTime = [[[timer userInfo] objectForKey:@"scheduledTime"] doubleValue];
-  if (self.state == kStateTypeDoubleJump || self.seeking) {
-    NSTimeInterval scheduledTime = [[[timer userInfo] objectForKey:@"scheduledTime"] doubleValue];
-    NSLog(@"MP seek start at time: %f", scheduledTime);
-    self.state = kStateTypeSeekStart;
-    self.seeking = !self.seeking;
-    [self.mpLogger registerSeekStart:mpsdk_dfl_CMTimeMakeWithSeconds(scheduledTime, 1000)];
-  } else if ((self.state == kStateTypeSeekEnd || self.state == kStateTypeResume) && !self.continued) {
-    NSLog(@"MP pause at time: %f",scheduledTime);
-    self.state = kStateTypePause;
-    [self.mpLogger registerPause: mpsdk_dfl_CMTimeMakeWithSeconds(scheduledTime, 1000)];
-  }
-  self.continued = NO;
+  }];
+  [self.sessions removeObjectsAtIndexes:indexes];
 }
 
-- (void)checkSeekEnd:(NSTimer *)timer {
-  if (self.state == kStateTypeDoubleJump || self.state == kStateTypeSeekStart) {
-    NSTimeInterval scheduledTime = [[[timer userInfo] objectForKey:@"scheduledTime"] doubleValue];
-    NSLog(@"MP seek end at time: %f", scheduledTime);
-    self.state = kStateTypeSeekEnd;
-    self.seeking = !self.seeking;
-    [self.mpLogger registerSeekEnd:mpsdk_dfl_CMTimeMakeWithSeconds(scheduledTime, 1000)];
+// Compiled again only when the configured pattern changes
+- (MPClientTokenMatcher *)currentTokenMatcher {
+  NSString *pattern = [MPConfigManager sharedManager].videoClientTokenPattern;
+  if (!self.tokenMatcher || ![self.tokenMatcherConfiguredPattern isEqualToString:pattern]) {
+    self.tokenMatcher = [MPClientTokenMatcher matcherWithConfiguredPattern];
+    self.tokenMatcherConfiguredPattern = pattern;
   }
+  return self.tokenMatcher;
 }
 
-- (BOOL)containsToken:(NSString *)url {
-  return [url rangeOfString:kToken].length != 0;
-}
-
-- (NSString *)extractClientTokenFrom: (NSString *)url {
-  if ([self containsToken:url]) {
-    return [url substringFromIndex: [url rangeOfString:kToken].location + kToken.length];
-  }
-  return nil;
-}
-
-- (void)dealloc {
-  [[NSNotificationCenter defaultCenter] removeObserver:self];
-}
 @end
-
@@ -0,0 +1,61 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+@import AVFoundation;
+
+#import "MPDefines+Internal.h"
+#import "MPVideoLogger.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ One player measured by FBMPObserver: its logger, its playback state machine,
+ and the observers it added to the player and its current item. The session
+ observes the player itself, so KVO callbacks, timers and notifications reach
+ it directly. Item notifications are only observed for the player's current
+ item, and only if that item's asset URL has a client token, so other items
+ in the app never reach the session. The client token is looked up with
+ FBMPObserver's current matcher, so a pattern configured later still applies.
+
+ The player is held weakly, so registering it does not keep it alive; once it
+ is released the session only finishes what is in flight.
+
+ Main thread only.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface FBMPPlayerSession : NSObject
+
+FB_INIT_AND_NEW_UNAVAILABLE_NULLABILITY
+
+- (instancetype)initWithPlayer:(AVPlayer *)player
+                    targetView:(UIView *)targetView NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, weak, readonly, nullable) AVPlayer *player;
+@property (nonatomic, strong, readonly, nullable) AVPlayerItem *playerItem;
+@property (nonatomic, strong, readonly) MPVideoLogger *mpLogger;
+@property (nonatomic, assign, readonly) StateType state;
+
+// Removes the observers from the player and its item; the session ignores
+// everything after.
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
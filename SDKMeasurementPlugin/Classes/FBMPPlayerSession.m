@@ -0,0 +1,260 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "FBMPPlayerSession.h"
+
+#import "FBMPObserver+Internal.h"
+#import "MPAudioStateProviding.h"
+#import "MPDynamicFrameworkLoader.h"
+#import "MPLogger.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static void *FBMPPlayerSessionKVOContext = &FBMPPlayerSessionKVOContext;
+
+@interface FBMPPlayerSession ()
+@property (nonatomic, strong, readwrite, nullable) AVPlayerItem *playerItem;
+// The item whose notifications are observed, if any
+@property (nonatomic, strong, nullable) AVPlayerItem *observedPlayerItem;
+@property (nonatomic, strong, nullable) UIControl *skipButton; //TBD
+@property (nonatomic, assign, readwrite) StateType state;
+@property (nonatomic, strong, nullable) id progressTimeObserver;
+@property (nonatomic, assign) BOOL seeking;
+@property (nonatomic, assign) BOOL continued;
+@property (nonatomic, assign) BOOL invalidated;
+@end
+
+@implementation FBMPPlayerSession
+
+- (instancetype)initWithPlayer:(AVPlayer *)player
+                    targetView:(UIView *)targetView
+{
+  self = [super init];
+  if (self) {
+    _player = player;
+    _mpLogger = (MPVideoLogger *)[[MPVideoLogger alloc] initWithTargetView:targetView
+                                                         targetVolumeBlock:[self getTargetVolumeBlock]
+                                                                  autoplay:true];
+    [_mpLogger updateAudioStateProvider:[MPAudioStateProviderFactory audioStateProviderForPlayer:player]];
+    [_player addObserver:self forKeyPath:@"rate" options:0 context:FBMPPlayerSessionKVOContext];
+    [_player addObserver:self forKeyPath:@"currentItem" options:NSKeyValueObservingOptionInitial context:FBMPPlayerSessionKVOContext];
+    [_skipButton addObserver:self forKeyPath:@"highlighted" options:0 context:FBMPPlayerSessionKVOContext];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  [self invalidate];
+}
+
+- (void)invalidate
+{
+  if (self.invalidated) {
+    return;
+  }
+  self.invalidated = YES;
+  [self.player removeObserver:self forKeyPath:@"rate" context:FBMPPlayerSessionKVOContext];
+  [self.player removeObserver:self forKeyPath:@"currentItem" context:FBMPPlayerSessionKVOContext];
+  [self observeNotificationsOfPlayerItem:nil];
+  [self.skipButton removeObserver:self forKeyPath:@"highlighted" context:FBMPPlayerSessionKVOContext];
+  if (self.progressTimeObserver) {
+    [self.player removeTimeObserver:self.progressTimeObserver];
+    self.progressTimeObserver = nil;
+  }
+}
+
+/**
+ Moves the item notification observers to the given item, or removes them
+ for nil or an item without a client token.
+ */
+- (void)observeNotificationsOfPlayerItem:(nullable AVPlayerItem *)playerItem
+{
+  if (playerItem && [[[FBMPObserver shareInstance] currentTokenMatcher] clientTokenForPlayerItem:playerItem] == nil) {
+    playerItem = nil;
+  }
+  if (playerItem == self.observedPlayerItem) {
+    return;
+  }
+  NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+  if (self.observedPlayerItem) {
+    [notificationCenter removeObserver:self name:AVPlayerItemTimeJumpedNotification object:self.observedPlayerItem];
+    [notificationCenter removeObserver:self name:AVPlayerItemDidPlayToEndTimeNotification object:self.observedPlayerItem];
+  }
+  self.observedPlayerItem = playerItem;
+  if (playerItem) {
+    [notificationCenter addObserver:self selector:@selector(jumpNotification:) name:AVPlayerItemTimeJumpedNotification object:playerItem];
+    [notificationCenter addObserver:self selector:@selector(itemDidFinishPlaying:) name:AVPlayerItemDidPlayToEndTimeNotification object:playerItem];
+  }
+}
+
+- (void)addProgressTimeObserverIfNot
+{
+  if (!self.progressTimeObserver) {
+    weakify(self);
+    self.progressTimeObserver = [self.player addPeriodicTimeObserverForInterval:mpsdk_dfl_CMTimeMakeWithSeconds((NSTimeInterval)0.2, 1000)
+                                                                          queue:dispatch_get_main_queue()
+                                                                     usingBlock:^(CMTime time) {
+                                                                       strongify(self);
+                                                                       [self.mpLogger registerProgressForPlayerItem:self.playerItem state:self.state];
+                                                                     }];
+  }
+}
+
+-(void)itemDidFinishPlaying:(NSNotification *) notification {
+  if (self.invalidated) {
+    return;
+  }
+  if (self.state != kStateTypeComplete) {
+    [self.mpLogger registerComplete:[self.playerItem currentTime]];
+    MPLogDebug(@"Completed playing at %f", mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]));
+    self.state = kStateTypeComplete;
+  }
+}
+
+-(void)jumpNotification:(NSNotification *)notification
+{
+  //   Will be called when AVPlayer seek to a new point
+  AVPlayerItem *playerItem = notification.object;
+  NSString *clientToken = [[[FBMPObserver shareInstance] currentTokenMatcher] clientTokenForPlayerItem:playerItem];
+  if (self.invalidated || clientToken == nil) {
+    return;
+  }
+  self.playerItem = playerItem;
+  
+  [self.mpLogger updateInlineClientToken:clientToken];
+  [self addProgressTimeObserverIfNot];
+  
+  NSTimeInterval currentTime = mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]);
+  if (currentTime == 0.0) {
+    if (self.state != kStateTypeResume) {
+      if (self.state == kStateTypeComplete) {
+        self.continued = YES;
+      }
+      [self.mpLogger registerResume:[self.playerItem currentTime]];
+      MPLogDebug(@"Resumed playing at %f after a jump", mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]));
+      self.state = kStateTypeResume;
+    }
+  } else if (self.state == kStateTypeJump){
+    self.state = kStateTypeDoubleJump;
+  } else {
+    self.state = kStateTypeJump;
+  }
+}
+
+- (MPVideoLoggerTargetVolumeBlock) getTargetVolumeBlock {
+  weakify(self);
+  MPVideoLoggerTargetVolumeBlock targetVolumeBlock = ^float{
+    strongify(self);
+    return self.player.volume;
+  };
+  return targetVolumeBlock;
+}
+
+- (void)observeValueForKeyPath:(nullable NSString *)keyPath
+                      ofObject:(nullable id)object
+                        change:(nullable NSDictionary *)change
+                       context:(nullable void *)context
+{
+  if (context != FBMPPlayerSessionKVOContext) {
+    [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    return;
+  }
+  if (self.invalidated) {
+    return;
+  }
+  
+  if ([keyPath isEqualToString:@"currentItem"]) {
+    [self observeNotificationsOfPlayerItem:self.player.currentItem];
+    return;
+  }
+  
+  // skip button
+  if ([object isKindOfClass:UIControl.class]) {
+    if ([keyPath isEqualToString:@"highlighted"]) {
+      MPLogDebug(@"Skipped");
+      [self.mpLogger registerSkip:[self.playerItem currentTime]];
+    }
+    return;
+  }
+  
+  if ([[[FBMPObserver shareInstance] currentTokenMatcher] clientTokenForPlayerItem:[self.player currentItem]] == nil) {
+    return;
+  }
+
+  if (!self.playerItem) {
+    self.playerItem = [self.player currentItem];
+  }
+  NSTimeInterval currentTime = mpsdk_dfl_CMTimeGetSeconds([self.playerItem currentTime]);
+  [self addProgressTimeObserverIfNot];
+  if ([keyPath isEqualToString:@"rate"]) {
+    if (currentTime <= 0.000000 || [self.player rate]) {
+      if (self.state == kStateTypePause) {
+        self.state = kStateTypeResume;
+        [self.mpLogger registerResume:[self.playerItem currentTime]];
+        MPLogDebug(@"Resumed playing at %f", currentTime);
+      }
+      [NSTimer scheduledTimerWithTimeInterval:0.9
+                                       target:self
+                                     selector:@selector(checkSeekEnd:)
+                                     userInfo:@{@"scheduledTime": @(currentTime)}
+                                      repeats:NO];
+    } else if (self.state != kStateTypeComplete) {
+      if (self.state != kStateTypePause && self.state != kStateTypeSeekStart) {
+        [NSTimer scheduledTimerWithTimeInterval:0.9
+                                         target:self
+                                       selector:@selector(checkSeekStart:)
+                                       userInfo:@{@"scheduledTime": @(currentTime)}
+                                        repeats:NO];
+      }
+    }
+  }
+}
+
+- (void)checkSeekStart:(NSTimer *)timer {
+  if (self.invalidated) return;
+  if(self.state == kStateTypeSeekStart || self.state == kStateTypeComplete) return;
+  NSTimeInterval scheduledTime = [[[timer userInfo] objectForKey:@"scheduledTime"] doubleValue];
+  if (self.state == kStateTypeDoubleJump || self.seeking) {
+    NSTimeInterval scheduledTime = [[[timer userInfo] objectForKey:@"scheduledTime"] doubleValue];
+    MPLogDebug(@"Seek started at %f", scheduledTime);
+    self.state = kStateTypeSeekStart;
+    self.seeking = !self.seeking;
+    [self.mpLogger registerSeekStart:mpsdk_dfl_CMTimeMakeWithSeconds(scheduledTime, 1000)];
+  } else if ((self.state == kStateTypeSeekEnd || self.state == kStateTypeResume) && !self.continued) {
+    MPLogDebug(@"Paused at %f", scheduledTime);
+    self.state = kStateTypePause;
+    [self.mpLogger registerPause: mpsdk_dfl_CMTimeMakeWithSeconds(scheduledTime, 1000)];
+  }
+  self.continued = NO;
+}
+
+- (void)checkSeekEnd:(NSTimer *)timer {
+  if (self.invalidated) return;
+  if (self.state == kStateTypeDoubleJump || self.state == kStateTypeSeekStart) {
+    NSTimeInterval scheduledTime = [[[timer userInfo] objectForKey:@"scheduledTime"] doubleValue];
+    MPLogDebug(@"Seek ended at %f", scheduledTime);
+    self.state = kStateTypeSeekEnd;
+    self.seeking = !self.seeking;
+    [self.mpLogger registerSeekEnd:mpsdk_dfl_CMTimeMakeWithSeconds(scheduledTime, 1000)];
+  }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,161 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace mp {
+
+struct AdaptiveSamplerConfig {
+  // Longest gap between measurements while nothing moves.
+  double stableInterval = 0.5;
+  // Full rate for this long after the last activity.
+  double activeHoldSeconds = 1.0;
+  // Full rate while the last ratio is this close to a threshold.
+  float thresholdMargin = 0.1f;
+  // How far eligible seconds may drift from full-rate sampling: a fixed
+  // allowance plus a fraction of the seconds played.
+  double maxErrorSeconds = 0.2;
+  double maxErrorFraction = 0.02;
+};
+
+/**
+ * Decides, tick by tick, whether the viewable ratio has to be measured again
+ * or the last measurement can stand in for it. Ticks come at the player's
+ * rate; measurements are kept at that rate while the caller reports activity
+ * (geometry, window or volume changes), for activeHoldSeconds after it, and
+ * while the ratio is near one of the thresholds, and drop to one per
+ * stableInterval otherwise.
+ *
+ * Eligible seconds can only be wrong for ticks that used a held ratio, and
+ * only if eligibility changed meanwhile. Each such hold is charged in full
+ * once the next measurement shows the change, and no hold is allowed to be
+ * longer than what is left of the budget (maxErrorSeconds plus
+ * maxErrorFraction of the seconds played), so for changes that last until the
+ * next measurement the error stays within it. While the budget is spent every
+ * tick is measured.
+ */
+class AdaptiveSampler {
+ public:
+  AdaptiveSampler(const AdaptiveSamplerConfig &config, std::vector<float> thresholds)
+    : _config(config), _thresholds(std::move(thresholds)) {}
+
+  // Before each tick: true if the caller must measure and pass the result to
+  // measured(), false if it should use heldRatio().
+  bool shouldMeasure(double progress, bool active)
+  {
+    _ticks++;
+    if (progress > 0) {
+      _playedSeconds += progress;
+    }
+    if (active) {
+      _sinceActivity = 0;
+    } else if (progress > 0) {
+      _sinceActivity += progress;
+    }
+    const double budget = errorBound() - _errorSeconds;
+    const double allowedHold = budget < _config.stableInterval ? budget : _config.stableInterval;
+    const bool measure = !_hasMeasurement ||
+      _sinceActivity < _config.activeHoldSeconds ||
+      nearThreshold(_heldRatio) ||
+      _heldSeconds + (progress > 0 ? progress : 0) > allowedHold;
+    if (!measure) {
+      _heldSeconds += progress > 0 ? progress : 0;
+    }
+    return measure;
+  }
+
+  void measured(float ratio)
+  {
+    _measurements++;
+    if (_hasMeasurement && _heldSeconds > 0 && eligibilityChanged(_heldRatio, ratio)) {
+      _errorSeconds += _heldSeconds;
+    }
+    _heldSeconds = 0;
+    _heldRatio = ratio;
+    _hasMeasurement = true;
+  }
+
+  float heldRatio() const
+  {
+    return _heldRatio;
+  }
+
+  // Worst case drift of eligible seconds so far, and what it may reach.
+  double errorSeconds() const
+  {
+    return _errorSeconds;
+  }
+
+  double errorBound() const
+  {
+    return _config.maxErrorSeconds + _config.maxErrorFraction * _playedSeconds;
+  }
+
+  std::size_t ticks() const
+  {
+    return _ticks;
+  }
+
+  std::size_t measurements() const
+  {
+    return _measurements;
+  }
+
+ private:
+  // Fully visible and fully hidden are where views rest, not where they
+  // cross; only ratios in between count as close.
+  bool nearThreshold(float ratio) const
+  {
+    if (!(ratio > 0.0f && ratio < 1.0f)) {
+      return false;
+    }
+    for (float threshold : _thresholds) {
+      if (std::fabs(ratio - threshold) < _config.thresholdMargin) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool eligibilityChanged(float from, float to) const
+  {
+    for (float threshold : _thresholds) {
+      if ((from >= threshold) != (to >= threshold)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  AdaptiveSamplerConfig _config;
+  std::vector<float> _thresholds;
+  bool _hasMeasurement = false;
+  float _heldRatio = 0;
+  double _heldSeconds = 0;
+  double _sinceActivity = 0;
+  double _playedSeconds = 0;
+  double _errorSeconds = 0;
+  std::size_t _ticks = 0;
+  std::size_t _measurements = 0;
+};
+
+} // namespace mp
@@ -0,0 +1,317 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mp {
+
+/**
+ * Bump allocator for short-lived, trivially destructible data that all dies
+ * together, e.g. everything one dispatch batch builds. Allocation is a pointer
+ * bump; reset() releases the whole batch at once and keeps the largest chunk
+ * for the next one, so a steady-state batch makes no system allocations.
+ *
+ * Not thread-safe; confine an arena to one queue.
+ */
+class Arena {
+ public:
+  struct Stats {
+    // Since the last reset()
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t systemAllocations = 0;
+    // Since construction
+    std::size_t peakBytes = 0;
+  };
+
+  explicit Arena(std::size_t chunkSize = 4096) : _chunkSize(chunkSize) {}
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  ~Arena()
+  {
+    freeChunks(nullptr);
+  }
+
+  void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+  {
+    uintptr_t aligned = alignUp((uintptr_t)_cursor, alignment);
+    if (!_head || aligned + size > (uintptr_t)_limit) {
+      grow(size + alignment);
+      aligned = alignUp((uintptr_t)_cursor, alignment);
+    }
+    _cursor = (char *)(aligned + size);
+    _last = (char *)aligned;
+    _stats.allocations++;
+    _stats.bytes += size;
+    _stats.peakBytes = std::max(_stats.peakBytes, _stats.bytes);
+    return (void *)aligned;
+  }
+
+  // Grows the most recent allocation in place if it still fits in its chunk.
+  bool extend(void *pointer, std::size_t oldSize, std::size_t newSize)
+  {
+    if (pointer != _last || (char *)pointer + oldSize != _cursor || (char *)pointer + newSize > _limit) {
+      return false;
+    }
+    _cursor = (char *)pointer + newSize;
+    _stats.bytes += newSize - oldSize;
+    _stats.peakBytes = std::max(_stats.peakBytes, _stats.bytes);
+    return true;
+  }
+
+  template <typename T, typename... Args>
+  T *make(Args &&... args)
+  {
+    static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  // NUL-terminated copy of `count` bytes.
+  char *copy(const char *bytes, std::size_t count)
+  {
+    char *result = (char *)allocate(count + 1, 1);
+    std::memcpy(result, bytes, count);
+    result[count] = '\0';
+    return result;
+  }
+
+  void reset()
+  {
+    if (_head) {
+      freeChunks(_head);
+      _head->next = nullptr;
+      _cursor = _head->bytes();
+    }
+    _last = nullptr;
+    _stats.allocations = 0;
+    _stats.bytes = 0;
+    _stats.systemAllocations = 0;
+  }
+
+  const Stats &stats() const
+  {
+    return _stats;
+  }
+
+ private:
+  struct Chunk {
+    Chunk *next;
+    std::size_t capacity;
+
+    char *bytes()
+    {
+      return (char *)(this + 1);
+    }
+  };
+
+  static uintptr_t alignUp(uintptr_t value, std::size_t alignment)
+  {
+    return (value + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+  }
+
+  void grow(std::size_t minimum)
+  {
+    // Chunks double, so the newest chunk is always the largest one and is the
+    // one reset() keeps.
+    std::size_t capacity = std::max(std::max(_chunkSize, minimum), _head ? _head->capacity * 2 : 0);
+    Chunk *chunk = (Chunk *)std::malloc(sizeof(Chunk) + capacity);
+    if (!chunk) {
+      throw std::bad_alloc();
+    }
+    chunk->next = _head;
+    chunk->capacity = capacity;
+    _head = chunk;
+    _cursor = chunk->bytes();
+    _limit = _cursor + capacity;
+    _stats.systemAllocations++;
+  }
+
+  // Frees every chunk except `keep`.
+  void freeChunks(Chunk *keep)
+  {
+    Chunk *chunk = _head;
+    while (chunk) {
+      Chunk *next = chunk->next;
+      if (chunk != keep) {
+        std::free(chunk);
+      }
+      chunk = next;
+    }
+    if (!keep) {
+      _head = nullptr;
+      _cursor = _limit = nullptr;
+    }
+  }
+
+  std::size_t _chunkSize;
+  Chunk *_head = nullptr;
+  char *_cursor = nullptr;
+  char *_limit = nullptr;
+  char *_last = nullptr;
+  Stats _stats;
+};
+
+/**
+ * Append-only NUL-terminated string living in an Arena. Grows in place while
+ * it is the arena's most recent allocation.
+ */
+class ArenaString {
+ public:
+  explicit ArenaString(Arena &arena, std::size_t capacity = 64)
+    : _arena(arena), _capacity(std::max<std::size_t>(capacity, 1))
+  {
+    _data = (char *)_arena.allocate(_capacity, 1);
+    _data[0] = '\0';
+  }
+
+  void append(const char *bytes, std::size_t count)
+  {
+    reserve(_size + count + 1);
+    std::memcpy(_data + _size, bytes, count);
+    _size += count;
+    _data[_size] = '\0';
+  }
+
+  void append(const char *string)
+  {
+    append(string, std::strlen(string));
+  }
+
+  const char *c_str() const
+  {
+    return _data;
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+ private:
+  void reserve(std::size_t capacity)
+  {
+    if (capacity <= _capacity) {
+      return;
+    }
+    std::size_t next = std::max(capacity, _capacity * 2);
+    if (!_arena.extend(_data, _capacity, next)) {
+      char *data = (char *)_arena.allocate(next, 1);
+      std::memcpy(data, _data, _size + 1);
+      _data = data;
+    }
+    _capacity = next;
+  }
+
+  Arena &_arena;
+  char *_data;
+  std::size_t _size = 0;
+  std::size_t _capacity;
+};
+
+/**
+ * Growable array of trivially copyable values living in an Arena, for the
+ * id lists of a batch. Grows in place while it is the arena's most recent
+ * allocation. Trivially destructible itself, so Arena::make can hold one that
+ * blocks share by pointer.
+ */
+template <typename T>
+class ArenaVector {
+  static_assert(std::is_trivially_copyable<T>::value, "ArenaVector moves values with memcpy");
+  static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+
+ public:
+  explicit ArenaVector(Arena &arena, std::size_t capacity = 16)
+    : _arena(&arena), _capacity(std::max<std::size_t>(capacity, 1))
+  {
+    _data = (T *)_arena->allocate(_capacity * sizeof(T), alignof(T));
+  }
+
+  void push_back(const T &value)
+  {
+    reserve(_size + 1);
+    _data[_size++] = value;
+  }
+
+  // Drops everything past `size`, e.g. after std::unique.
+  void truncate(std::size_t size)
+  {
+    _size = std::min(_size, size);
+  }
+
+  T *begin()
+  {
+    return _data;
+  }
+
+  T *end()
+  {
+    return _data + _size;
+  }
+
+  const T *begin() const
+  {
+    return _data;
+  }
+
+  const T *end() const
+  {
+    return _data + _size;
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+  bool empty() const
+  {
+    return _size == 0;
+  }
+
+ private:
+  void reserve(std::size_t capacity)
+  {
+    if (capacity <= _capacity) {
+      return;
+    }
+    std::size_t next = std::max(capacity, _capacity * 2);
+    if (!_arena->extend(_data, _capacity * sizeof(T), next * sizeof(T))) {
+      T *data = (T *)_arena->allocate(next * sizeof(T), alignof(T));
+      std::memcpy(data, _data, _size * sizeof(T));
+      _data = data;
+    }
+    _capacity = next;
+  }
+
+  Arena *_arena;
+  T *_data;
+  std::size_t _size = 0;
+  std::size_t _capacity;
+};
+
+} // namespace mp
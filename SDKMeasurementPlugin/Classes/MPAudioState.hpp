@@ -0,0 +1,63 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include <atomic>
+
+namespace mp {
+
+/**
+ * Last known audio state of one player, written from KVO callbacks on
+ * whichever thread they arrive and read on every progress tick. Each field
+ * is its own atomic and the product is formed on read, so concurrent updates
+ * never leave a stale combination behind. Everything starts at 0 until the
+ * first values arrive.
+ */
+class AudioState {
+ public:
+  void setOutputVolume(float volume)
+  {
+    _outputVolume.store(volume, std::memory_order_relaxed);
+  }
+
+  void setPlayerVolume(float volume)
+  {
+    _playerVolume.store(volume, std::memory_order_relaxed);
+  }
+
+  void setMuted(bool muted)
+  {
+    _muted.store(muted, std::memory_order_relaxed);
+  }
+
+  // Device output volume times player volume; 0 when muted.
+  float effectiveVolume() const
+  {
+    if (_muted.load(std::memory_order_relaxed)) {
+      return 0.0f;
+    }
+    return _outputVolume.load(std::memory_order_relaxed) * _playerVolume.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<float> _outputVolume{0.0f};
+  std::atomic<float> _playerVolume{0.0f};
+  std::atomic<bool> _muted{false};
+};
+
+} // namespace mp
@@ -0,0 +1,87 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#import "MPAudioStateObserver.h"
+
+#import "MPAudioState.hpp"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static void *MPAudioStateObserverContext = &MPAudioStateObserverContext;
+static NSString *const kOutputVolumeKeyPath = @"outputVolume";
+static NSString *const kVolumeKeyPath = @"volume";
+static NSString *const kMutedKeyPath = @"muted";
+
+@implementation MPAudioStateObserver
+{
+  mp::AudioState _state;
+  AVAudioSession *_audioSession;
+}
+
+- (instancetype)initWithPlayer:(nullable AVPlayer *)player
+{
+  self = [super init];
+  if (self) {
+    _player = player;
+    _audioSession = [AVAudioSession sharedInstance];
+    NSKeyValueObservingOptions options = NSKeyValueObservingOptionInitial | NSKeyValueObservingOptionNew;
+    [_audioSession addObserver:self forKeyPath:kOutputVolumeKeyPath options:options context:MPAudioStateObserverContext];
+    [_player addObserver:self forKeyPath:kVolumeKeyPath options:options context:MPAudioStateObserverContext];
+    [_player addObserver:self forKeyPath:kMutedKeyPath options:options context:MPAudioStateObserverContext];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  [_audioSession removeObserver:self forKeyPath:kOutputVolumeKeyPath context:MPAudioStateObserverContext];
+  // nil once the player is gone, which took its observations with it
+  AVPlayer *player = _player;
+  [player removeObserver:self forKeyPath:kVolumeKeyPath context:MPAudioStateObserverContext];
+  [player removeObserver:self forKeyPath:kMutedKeyPath context:MPAudioStateObserverContext];
+}
+
+- (float)effectiveVolume
+{
+  return _state.effectiveVolume();
+}
+
+- (void)observeValueForKeyPath:(nullable NSString *)keyPath
+                      ofObject:(nullable id)object
+                        change:(nullable NSDictionary *)change
+                       context:(nullable void *)context
+{
+  if (context != MPAudioStateObserverContext) {
+    [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    return;
+  }
+  id value = change[NSKeyValueChangeNewKey];
+  if (![value isKindOfClass:[NSNumber class]]) {
+    return;
+  }
+  if (object == _audioSession && [keyPath isEqualToString:kOutputVolumeKeyPath]) {
+    _state.setOutputVolume([value floatValue]);
+  } else if ([keyPath isEqualToString:kVolumeKeyPath]) {
+    _state.setPlayerVolume([value floatValue]);
+  } else if ([keyPath isEqualToString:kMutedKeyPath]) {
+    _state.setMuted([value boolValue]);
+  }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,44 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#import <AVFoundation/AVFoundation.h>
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+NS_PROTOCOL_REQUIRES_EXPLICIT_IMPLEMENTATION
+@protocol MPAudioStateProviding <NSObject>
+
+/**
+ The volume the user hears from the player: device output volume times the
+ player's volume, 0 when the player is muted. Called on every progress tick,
+ so it must only read cached state.
+ */
+- (float)effectiveVolume;
+
+@end
+
+@interface MPAudioStateProviderFactory : NSObject
+
+// Replaces the KVO-backed MPAudioStateObserver, e.g. with a fake in tests.
++ (void)setAudioStateProviderBlock:(id<MPAudioStateProviding>(^)(AVPlayer * _Nullable player))providerBlock;
++ (void)resetAudioStateProviderBlock;
++ (id<MPAudioStateProviding>)audioStateProviderForPlayer:(nullable AVPlayer *)player;
+
+@end
+
+NS_ASSUME_NONNULL_END
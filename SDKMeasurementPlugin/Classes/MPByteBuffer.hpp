@@ -0,0 +1,140 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace mp {
+
+/**
+ * Growable malloc-backed byte buffer. release() hands the allocation to the
+ * caller (e.g. -[NSData initWithBytesNoCopy:length:freeWhenDone:]) so a
+ * finished payload never has to be copied.
+ */
+class ByteBuffer {
+ public:
+  ByteBuffer() = default;
+  explicit ByteBuffer(std::size_t capacity)
+  {
+    reserve(capacity);
+  }
+  ByteBuffer(const ByteBuffer &) = delete;
+  ByteBuffer &operator=(const ByteBuffer &) = delete;
+  ~ByteBuffer()
+  {
+    std::free(_data);
+  }
+
+  const uint8_t *data() const
+  {
+    return _data;
+  }
+
+  uint8_t *data()
+  {
+    return _data;
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+  std::size_t capacity() const
+  {
+    return _capacity;
+  }
+
+  void clear()
+  {
+    _size = 0;
+  }
+
+  void reserve(std::size_t capacity)
+  {
+    if (capacity <= _capacity) {
+      return;
+    }
+    void *data = std::realloc(_data, capacity);
+    if (!data) {
+      throw std::bad_alloc();
+    }
+    _data = static_cast<uint8_t *>(data);
+    _capacity = capacity;
+  }
+
+  // Returns a pointer to `count` writable bytes at the end of the buffer;
+  // commit() them once written.
+  uint8_t *prepare(std::size_t count)
+  {
+    if (_size + count > _capacity) {
+      grow(_size + count);
+    }
+    return _data + _size;
+  }
+
+  void commit(std::size_t count)
+  {
+    _size += count;
+  }
+
+  void push(uint8_t byte)
+  {
+    *prepare(1) = byte;
+    _size++;
+  }
+
+  void append(const void *bytes, std::size_t count)
+  {
+    if (count) {
+      std::memcpy(prepare(count), bytes, count);
+      _size += count;
+    }
+  }
+
+  // Transfers ownership of the allocation to the caller, who must free() it.
+  uint8_t *release()
+  {
+    uint8_t *data = _data;
+    _data = nullptr;
+    _size = 0;
+    _capacity = 0;
+    return data;
+  }
+
+ private:
+  void grow(std::size_t required)
+  {
+    std::size_t capacity = _capacity ? _capacity : 64;
+    while (capacity < required) {
+      capacity *= 2;
+    }
+    reserve(capacity);
+  }
+
+  uint8_t *_data = nullptr;
+  std::size_t _size = 0;
+  std::size_t _capacity = 0;
+};
+
+} // namespace mp
@@ -0,0 +1,57 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+@import AVFoundation;
+
+#import "MPDefines+Internal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Finds the client token in the asset URL of a player item. A pattern starting
+ with "re:" is compiled once into an NSRegularExpression from the rest of it;
+ any other pattern is searched for as a plain string, so "cdn.example.com"
+ only matches itself. The token is the first capture group if the expression
+ has one, and what follows the match otherwise.
+
+ The result is remembered per player item (held weakly), so every later
+ callback for the same item costs a pointer lookup, and one for the item
+ seen last not even that. Safe to use from any thread.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface MPClientTokenMatcher : NSObject
+
+FB_INIT_AND_NEW_UNAVAILABLE_NULLABILITY
+
+// nil if the pattern is empty, or has the "re:" prefix and no valid regular expression after it
+- (nullable instancetype)initWithPattern:(NSString *)pattern NS_DESIGNATED_INITIALIZER;
+
+// -[MPConfigManager videoClientTokenPattern], or the default if that does not compile
++ (instancetype)matcherWithConfiguredPattern;
+
+@property (nonatomic, copy, readonly) NSString *pattern;
+
+- (nullable NSString *)clientTokenInString:(NSString *)string;
+
+// nil unless the item has a URL asset whose URL matches
+- (nullable NSString *)clientTokenForPlayerItem:(nullable AVPlayerItem *)playerItem;
+
+@end
+
+NS_ASSUME_NONNULL_END
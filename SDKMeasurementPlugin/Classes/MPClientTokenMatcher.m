@@ -0,0 +1,120 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPClientTokenMatcher.h"
+
+#import "MPConfigManager.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSString * const kDefaultClientTokenPattern = @"brightcove";
+static NSString * const kRegularExpressionPatternPrefix = @"re:";
+
+@interface MPClientTokenMatcher ()
+// nil for a plain string pattern
+@property (nonatomic, strong, nullable) NSRegularExpression *expression;
+// Item -> token, or NSNull for items that do not match
+@property (nonatomic, strong) NSMapTable<AVPlayerItem *, id> *tokensByPlayerItem;
+@property (nonatomic, weak, nullable) AVPlayerItem *lastPlayerItem;
+@property (nonatomic, strong, nullable) id lastToken;
+@end
+
+@implementation MPClientTokenMatcher
+
+- (nullable instancetype)initWithPattern:(NSString *)pattern
+{
+  if (pattern.length == 0) {
+    return nil;
+  }
+  self = [super init];
+  if (self) {
+    _pattern = [pattern copy];
+    if ([pattern hasPrefix:kRegularExpressionPatternPrefix]) {
+      NSString *expressionPattern = [pattern substringFromIndex:kRegularExpressionPatternPrefix.length];
+      NSError *error = nil;
+      _expression = expressionPattern.length ? [NSRegularExpression regularExpressionWithPattern:expressionPattern options:0 error:&error] : nil;
+      if (!_expression) {
+        return nil;
+      }
+    }
+    _tokensByPlayerItem = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                                valueOptions:NSPointerFunctionsStrongMemory];
+  }
+  return self;
+}
+
++ (instancetype)matcherWithConfiguredPattern
+{
+  MPClientTokenMatcher *matcher = [[self alloc] initWithPattern:[MPConfigManager sharedManager].videoClientTokenPattern];
+  return matcher ?: (MPClientTokenMatcher *)[[self alloc] initWithPattern:kDefaultClientTokenPattern];
+}
+
+- (nullable NSString *)clientTokenInString:(NSString *)string
+{
+  if (!self.expression) {
+    NSRange range = [string rangeOfString:self.pattern];
+    if (range.location == NSNotFound) {
+      return nil;
+    }
+    return [string substringFromIndex:NSMaxRange(range)];
+  }
+  NSTextCheckingResult *match = [self.expression firstMatchInString:string options:0 range:NSMakeRange(0, string.length)];
+  if (!match) {
+    return nil;
+  }
+  if (match.numberOfRanges > 1) {
+    NSRange group = [match rangeAtIndex:1];
+    return group.location == NSNotFound ? @"" : [string substringWithRange:group];
+  }
+  return [string substringFromIndex:NSMaxRange(match.range)];
+}
+
+- (nullable NSString *)clientTokenForPlayerItem:(nullable AVPlayerItem *)playerItem
+{
+  if (!playerItem) {
+    return nil;
+  }
+  id token;
+  @synchronized(self) {
+    if (playerItem == self.lastPlayerItem) {
+      token = self.lastToken;
+    } else {
+      token = [self.tokensByPlayerItem objectForKey:playerItem];
+      if (token) {
+        self.lastPlayerItem = playerItem;
+        self.lastToken = token;
+      }
+    }
+  }
+  if (!token) {
+    // First sight; the asset of an item never changes
+    AVAsset *asset = playerItem.asset;
+    NSURL *url = [asset isKindOfClass:AVURLAsset.class] ? [(AVURLAsset *)asset URL] : nil;
+    token = (url ? [self clientTokenInString:url.absoluteString] : nil) ?: [NSNull null];
+    @synchronized(self) {
+      [self.tokensByPlayerItem setObject:token forKey:playerItem];
+      self.lastPlayerItem = playerItem;
+      self.lastToken = token;
+    }
+  }
+  return token == [NSNull null] ? nil : token;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -18,18 +18,31 @@
 
 #import "MPConcurrentArray.h"
 
-#import <mutex>
+#import <algorithm>
 
+#import "MPSnapshotVector.hpp"
 #import "MPUtility.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface MPConcurrentArray ()
+typedef mp::SnapshotVector<id> MPConcurrentArrayStorage;
+
+// Keeps a storage version alive for the duration of a fast enumeration.
+@interface MPConcurrentArraySnapshot : NSObject
 {
-  std::recursive_mutex _storageLock;
+@public
+  MPConcurrentArrayStorage::Snapshot _snapshot;
+  unsigned long _mutations;
 }
+@end
 
-@property (nonatomic, strong) NSMutableArray *storage;
+@implementation MPConcurrentArraySnapshot
+@end
+
+@interface MPConcurrentArray ()
+{
+  MPConcurrentArrayStorage _storage;
+}
 
 @end
 
@@ -37,29 +50,28 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)init
 {
-  self = [super init];
-  if (self) {
-    _storage = [NSMutableArray array];
-  }
-  return self;
+  return [super init];
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems
 {
-  self = [super init];
-  if (self) {
-    _storage = [[NSMutableArray alloc] initWithCapacity:numItems];
-  }
-  return self;
+  // Appends grow the shared buffer geometrically, so a capacity hint buys little.
+  return [super init];
 }
 
 - (nullable instancetype)initWithCoder:(NSCoder *)aDecoder
 {
   self = [super init];
   if (self) {
-    NSArray * __nullable storage = [[NSMutableArray alloc] initWithCoder:aDecoder];
+    NSArray * __nullable storage = [[NSArray alloc] initWithCoder:aDecoder];
     if (storage) {
-      _storage = MPUnwrap(storage);
+      NSArray *decoded = MPUnwrap(storage);
+      _storage.update([decoded](MPConcurrentArrayStorage::Storage &items) {
+        items.reserve(decoded.count);
+        for (id object in decoded) {
+          items.push_back(object);
+        }
+      });
     } else {
       return nil;
     }
@@ -79,93 +91,128 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSUInteger)count
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  return self.storage.count;
+  return _storage.size();
 }
 
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
                                   objects:(id __nullable __unsafe_unretained [])buffer
                                     count:(NSUInteger)len
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  return [self.storage countByEnumeratingWithState:state
-                                           objects:buffer
-                                             count:len];
+  // The whole snapshot is handed out in one chunk; later mutations publish new
+  // versions and never invalidate the one being enumerated.
+  if (state->state != 0) {
+    return 0;
+  }
+  MPConcurrentArraySnapshot *holder = [MPConcurrentArraySnapshot new];
+  holder->_snapshot = _storage.snapshot();
+  CFAutorelease((__bridge_retained CFTypeRef)holder);
+  state->state = 1;
+  state->mutationsPtr = &holder->_mutations;
+  state->itemsPtr = (id __unsafe_unretained *)(void *)holder->_snapshot->data();
+  return holder->_snapshot->size();
 }
 
 - (nullable id)objectAtIndex:(NSUInteger)index
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  return(self.storage)[index];
+  MPConcurrentArrayStorage::Snapshot snapshot = _storage.snapshot();
+  if (index >= snapshot->size()) {
+    [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)snapshot->size()];
+  }
+  return (*snapshot)[index];
 }
 
 - (void)addObject:(id)anObject
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage addObject:anObject];
+  _storage.push_back(anObject);
 }
 
 - (void)insertObject:(id)anObject atIndex:(NSUInteger)index
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage insertObject:anObject atIndex:index];
+  _storage.update([anObject, index](MPConcurrentArrayStorage::Storage &items) {
+    if (index > items.size()) {
+      [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)items.size()];
+    }
+    items.insert(items.begin() + index, anObject);
+  });
 }
 
 - (void)removeLastObject
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage removeLastObject];
+  _storage.update([](MPConcurrentArrayStorage::Storage &items) {
+    if (items.empty()) {
+      [NSException raise:NSRangeException format:@"removeLastObject called on an empty array"];
+    }
+    items.pop_back();
+  });
 }
 
 - (void)removeObjectAtIndex:(NSUInteger)index
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage removeObjectAtIndex:index];
+  _storage.update([index](MPConcurrentArrayStorage::Storage &items) {
+    if (index >= items.size()) {
+      [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)items.size()];
+    }
+    items.erase(items.begin() + index);
+  });
 }
 
 - (void)removeObjectIdenticalTo:(id)anObject
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage removeObjectIdenticalTo:anObject];
+  _storage.update([anObject](MPConcurrentArrayStorage::Storage &items) {
+    items.erase(std::remove_if(items.begin(), items.end(), [anObject](id object) {
+      return object == anObject;
+    }), items.end());
+  });
 }
 
 - (void)replaceObjectAtIndex:(NSUInteger)index withObject:(id)anObject
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  (self.storage)[index] = anObject;
+  _storage.update([anObject, index](MPConcurrentArrayStorage::Storage &items) {
+    if (index >= items.size()) {
+      [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)items.size()];
+    }
+    items[index] = anObject;
+  });
 }
 
 - (void)removeObject:(id)anObject
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage removeObject:anObject];
+  _storage.update([anObject](MPConcurrentArrayStorage::Storage &items) {
+    items.erase(std::remove_if(items.begin(), items.end(), [anObject](id object) {
+      return [object isEqual:anObject];
+    }), items.end());
+  });
 }
 
 - (void)removeAllObjects
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage removeAllObjects];
+  _storage.clear();
 }
 
 - (nullable id)objectAtIndexedSubscript:(NSUInteger)idx
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  return [self.storage objectAtIndexedSubscript:idx];
+  return [self objectAtIndex:idx];
 }
 
 - (void)setObject:(id)obj atIndexedSubscript:(NSUInteger)idx
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  [self.storage setObject:obj atIndexedSubscript:idx];
+  _storage.update([obj, idx](MPConcurrentArrayStorage::Storage &items) {
+    if (idx == items.size()) {
+      items.push_back(obj);
+    } else if (idx < items.size()) {
+      items[idx] = obj;
+    } else {
+      [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)idx, (unsigned long)items.size()];
+    }
+  });
 }
 
 - (NSArray *)nonConcurrentCopy
 {
-  std::lock_guard<std::recursive_mutex> lock(_storageLock);
-  return [self.storage copy];
+  MPConcurrentArrayStorage::Snapshot snapshot = _storage.snapshot();
+  return [NSArray arrayWithObjects:(id __unsafe_unretained const *)(const void *)snapshot->data() count:snapshot->size()];
 }
 
 @end
 
 NS_ASSUME_NONNULL_END
-
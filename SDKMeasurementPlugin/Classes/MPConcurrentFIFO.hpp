@@ -0,0 +1,217 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace mp {
+
+/**
+ * Multi-producer, multi-consumer FIFO.
+ *
+ * Producers do not contend with consumers: a push is a CAS onto an incoming
+ * stack, and only takes the consumer lock to wake a thread blocked in
+ * popWait. Consumers are not lock-free; they serialize on a mutex and drain
+ * the incoming stack in one atomic exchange, reversing it into an outgoing
+ * list, so pop is amortized O(1) and popAll is a constant-time swap of both
+ * segments.
+ */
+template <typename T>
+class ConcurrentFIFO {
+  struct Node {
+    explicit Node(T &&value) : value(std::move(value)) {}
+    T value;
+    Node *next = nullptr;
+  };
+
+ public:
+  // Detached run of elements in FIFO order, as returned by popAll().
+  class Batch {
+   public:
+    Batch() = default;
+    Batch(Batch &&other) noexcept : _head(other._head), _count(other._count)
+    {
+      other._head = nullptr;
+      other._count = 0;
+    }
+    Batch(const Batch &) = delete;
+    Batch &operator=(const Batch &) = delete;
+    ~Batch()
+    {
+      while (_head) {
+        Node *next = _head->next;
+        delete _head;
+        _head = next;
+      }
+    }
+
+    std::size_t size() const
+    {
+      return _count;
+    }
+
+    template <typename Function>
+    void forEach(Function &&function)
+    {
+      for (Node *node = _head; node; node = node->next) {
+        function(node->value);
+      }
+    }
+
+   private:
+    friend class ConcurrentFIFO;
+    Batch(Node *head, std::size_t count) : _head(head), _count(count) {}
+    Node *_head = nullptr;
+    std::size_t _count = 0;
+  };
+
+  ConcurrentFIFO() = default;
+  ConcurrentFIFO(const ConcurrentFIFO &) = delete;
+  ConcurrentFIFO &operator=(const ConcurrentFIFO &) = delete;
+
+  ~ConcurrentFIFO()
+  {
+    Batch drained = popAll();
+  }
+
+  void push(T value)
+  {
+    Node *node = new Node(std::move(value));
+    Node *head = _incoming.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!_incoming.compare_exchange_weak(head, node, std::memory_order_seq_cst, std::memory_order_relaxed));
+    if (_waiters.load(std::memory_order_seq_cst) > 0) {
+      // Taking the lock orders us after a waiter's emptiness check.
+      { std::lock_guard<std::mutex> lock(_consumerLock); }
+      _available.notify_one();
+    }
+  }
+
+  bool tryPop(T &value)
+  {
+    std::lock_guard<std::mutex> lock(_consumerLock);
+    return popLocked(value);
+  }
+
+  bool tryPeek(T &value)
+  {
+    std::lock_guard<std::mutex> lock(_consumerLock);
+    refillLocked();
+    if (!_outgoingHead) {
+      return false;
+    }
+    value = _outgoingHead->value;
+    return true;
+  }
+
+  // Blocks until an element is available or `timeout` elapses.
+  template <typename Rep, typename Period>
+  bool popWait(T &value, const std::chrono::duration<Rep, Period> &timeout)
+  {
+    std::unique_lock<std::mutex> lock(_consumerLock);
+    if (popLocked(value)) {
+      return true;
+    }
+    _waiters.fetch_add(1, std::memory_order_seq_cst);
+    bool popped = _available.wait_for(lock, timeout, [&] {
+      return popLocked(value);
+    });
+    _waiters.fetch_sub(1, std::memory_order_relaxed);
+    return popped;
+  }
+
+  Batch popAll()
+  {
+    std::lock_guard<std::mutex> lock(_consumerLock);
+    refillLocked();
+    Batch batch(_outgoingHead, _outgoingCount);
+    _outgoingHead = nullptr;
+    _outgoingTail = nullptr;
+    _outgoingCount = 0;
+    return batch;
+  }
+
+  bool empty() const
+  {
+    std::lock_guard<std::mutex> lock(_consumerLock);
+    return !_outgoingHead && !_incoming.load(std::memory_order_acquire);
+  }
+
+ private:
+  bool popLocked(T &value)
+  {
+    if (!_outgoingHead) {
+      refillLocked();
+      if (!_outgoingHead) {
+        return false;
+      }
+    }
+    Node *node = _outgoingHead;
+    _outgoingHead = node->next;
+    if (!_outgoingHead) {
+      _outgoingTail = nullptr;
+    }
+    _outgoingCount--;
+    value = std::move(node->value);
+    delete node;
+    return true;
+  }
+
+  // Moves everything pushed so far behind the outgoing list, oldest first.
+  void refillLocked()
+  {
+    Node *stack = _incoming.exchange(nullptr, std::memory_order_seq_cst);
+    if (!stack) {
+      return;
+    }
+    Node *segmentHead = nullptr;
+    Node *segmentTail = stack;
+    std::size_t count = 0;
+    while (stack) {
+      Node *next = stack->next;
+      stack->next = segmentHead;
+      segmentHead = stack;
+      stack = next;
+      count++;
+    }
+    if (_outgoingTail) {
+      _outgoingTail->next = segmentHead;
+    } else {
+      _outgoingHead = segmentHead;
+    }
+    _outgoingTail = segmentTail;
+    _outgoingCount += count;
+  }
+
+  std::atomic<Node *> _incoming{nullptr};
+  std::atomic<int> _waiters{0};
+  mutable std::mutex _consumerLock;
+  std::condition_variable _available;
+  Node *_outgoingHead = nullptr;
+  Node *_outgoingTail = nullptr;
+  std::size_t _outgoingCount = 0;
+};
+
+} // namespace mp
@@ -25,10 +25,16 @@ NS_ASSUME_NONNULL_BEGIN
 FB_SUBCLASSING_RESTRICTED
 @interface MPConcurrentQueue<__covariant ObjectType> : NSObject
 
+// All methods run synchronously on the calling thread. Pushes only wait on
+// consumers when one is blocked in popWithTimeout:. Pops and peeks return nil
+// when the queue is empty.
 - (void)pushObject:(ObjectType)object;
-- (void)pop:(void (^)(ObjectType object))block;
-- (void)peek:(void (^)(ObjectType object))block;
-- (void)popAll:(void (^)(NSEnumerator<ObjectType> *enumerator))block;
+- (nullable ObjectType)popObject;
+- (nullable ObjectType)popWithTimeout:(NSTimeInterval)timeout;
+- (nullable ObjectType)peekObject;
+- (NSArray<ObjectType> *)popAllObjects;
+
+@property (nonatomic, readonly, getter=isEmpty) BOOL empty;
 
 @end
 
@@ -18,12 +18,14 @@
 
 #import "MPConcurrentQueue.h"
 
+#import "MPConcurrentFIFO.hpp"
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface MPConcurrentQueue ()
-
-@property (nonatomic, strong) NSMutableArray *storage;
-@property (nonatomic, strong) dispatch_queue_t queue;
+{
+  mp::ConcurrentFIFO<id> _storage;
+}
 
 @end
 
@@ -31,53 +33,45 @@ NS_ASSUME_NONNULL_BEGIN
 
 FB_FINAL_CLASS(objc_getClass("MPConcurrentQueue"));
 
-- (instancetype)init
+- (void)pushObject:(id)object
 {
-  self = [super init];
-  if (self) {
-    _queue = dispatch_queue_create("com.facebook.ads.util.queue", DISPATCH_QUEUE_SERIAL);
-    _storage = [NSMutableArray array];
-  }
-  return self;
+  _storage.push(object);
 }
 
-- (void)pushObject:(id)object
+- (nullable id)popObject
 {
-  dispatch_async(self.queue, ^{
-    [self.storage addObject:object];
-  });
+  id object = nil;
+  _storage.tryPop(object);
+  return object;
 }
 
-- (void)pop:(void (^)(id object))block
+- (nullable id)popWithTimeout:(NSTimeInterval)timeout
 {
-  dispatch_async(self.queue, ^{
-    id object = self.storage.firstObject;
-    [self.storage removeObject:object];
-    if (block) {
-      block(object);
-    }
-  });
+  id object = nil;
+  _storage.popWait(object, std::chrono::duration<double>(MAX(timeout, 0.0)));
+  return object;
 }
 
-- (void)peek:(void (^)(id object))block
+- (nullable id)peekObject
 {
-  dispatch_async(self.queue, ^{
-    id object = self.storage.firstObject;
-    if (block) {
-      block(object);
-    }
-  });
+  id object = nil;
+  _storage.tryPeek(object);
+  return object;
 }
 
-- (void)popAll:(void (^)(NSEnumerator<id> *enumerator))block
+- (NSArray *)popAllObjects
 {
-  dispatch_async(self.queue, ^{
-    NSEnumerator *enumerator = [[self.storage copy] objectEnumerator];
-    [self.storage removeAllObjects];
-    if (block) {
-      block(enumerator);
-    }
+  mp::ConcurrentFIFO<id>::Batch batch = _storage.popAll();
+  NSMutableArray *objects = [NSMutableArray arrayWithCapacity:batch.size()];
+  batch.forEach([objects](id object) {
+    [objects addObject:object];
   });
+  return objects;
+}
+
+- (BOOL)isEmpty
+{
+  return _storage.empty();
 }
 
 @end
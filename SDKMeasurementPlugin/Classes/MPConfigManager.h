@@ -58,7 +58,9 @@ FB_SUBCLASSING_RESTRICTED
 @property (nonatomic, assign, readonly, getter=isFNFShouldSyncBeforeRunloopStopEnabled) BOOL fnfShouldSyncBeforeRunloopStopEnabled;
 @property (nonatomic, assign, readonly, getter=isMetalImageRendererEnabled) BOOL metalImageRendererEnabled;
 @property (nonatomic, assign, readonly) NSTimeInterval unifiedLoggingImmediateDelay;
+@property (nonatomic, assign, readonly) NSTimeInterval unifiedLoggingImmediateMaxDelay;
 @property (nonatomic, assign, readonly) NSInteger unifiedLoggingEventLimit;
+@property (nonatomic, assign, readonly, getter=isUnifiedLoggingSymbolCodedPayloadEnabled) BOOL unifiedLoggingSymbolCodedPayloadEnabled;
 @property (nonatomic, assign, readonly) CGFloat adTapMargin;
 @property (nonatomic, assign, readonly) NSTimeInterval minimumElapsedTimeAfterImpression;
 @property (nonatomic, assign, readonly, getter=isAdClickabilityRestrictedUntilImpression) BOOL adClickabilityRestrictedUntilImpression;
@@ -66,6 +68,15 @@ FB_SUBCLASSING_RESTRICTED
 @property (nonatomic, assign, readonly) NSInteger visibleAreaPercentage;
 @property (nonatomic, assign, readonly) NSInteger adTapMarginPercentage; //valid range 0 - 50
 @property (nonatomic, copy, readonly) NSString *rvAutoRotate;
+// Extra video viewability standards, in the format of +[MPQualityRule rulesWithSpecification:endCallback:]
+@property (nonatomic, copy, readonly) NSString *videoQualityRuleSpecification;
+// Picks the measured videos by asset URL: a plain string, or "re:" and a regular expression, see MPClientTokenMatcher
+@property (nonatomic, copy, readonly) NSString *videoClientTokenPattern;
+// Measure viewability less often while nothing changes, see MPAdaptiveSampler.hpp
+@property (nonatomic, assign, readonly, getter=isQualityAdaptiveSamplingEnabled) BOOL qualityAdaptiveSamplingEnabled;
+@property (nonatomic, assign, readonly) NSInteger qualityAdaptiveSamplingMaxErrorPercentage; // of the seconds played
+// Leave all but the geometry capture of each viewability tick to a background queue
+@property (nonatomic, assign, readonly, getter=isQualityBackgroundProcessingEnabled) BOOL qualityBackgroundProcessingEnabled;
 @property (nonatomic, assign, readonly, getter=isInAppAppStoreDisabled) BOOL inAppAppStoreDisabled;
 @property (nonatomic, assign, readonly) BOOL useCachedImageContextForSoftwareRenderer;
 @property (nonatomic, assign, readonly) BOOL useCachedImageContextForMetalRenderer;
@@ -34,13 +34,20 @@ static MPConfigurationKey const fb_config_fnf_should_sync_before_runloop_stop =
 static MPConfigurationKey const fb_config_fnf_should_use_typed_internals = @"ios_fnf_should_use_typed_internals";
 static MPConfigurationKey const fb_config_metal_image_renderer_enabled = @"ios_metal_image_renderer_enabled";
 static MPConfigurationKey const fb_config_unified_logging_immediate_delay_ms = @"unified_logging_immediate_delay_ms";
+static MPConfigurationKey const fb_config_unified_logging_immediate_max_delay_ms = @"unified_logging_immediate_max_delay_ms";
 static MPConfigurationKey const fb_config_unified_logging_event_limit = @"unified_logging_event_limit";
+static MPConfigurationKey const fb_config_unified_logging_symbol_coded_payload = @"unified_logging_symbol_coded_payload";
 static MPConfigurationKey const fb_config_ad_viewability_tick_duration = @"ad_viewability_tick_duration";
 static MPConfigurationKey const fb_config_ad_viewability_tap_margin = @"ad_viewability_tap_margin";
 static MPConfigurationKey const fb_config_minimum_elapsed_time_after_impression = @"minimum_elapsed_time_after_impression";
 static MPConfigurationKey const fb_config_visible_area_check_enabled = @"visible_area_check_enabled";
 static MPConfigurationKey const fb_config_visible_area_percentage = @"visible_area_percentage";
 static MPConfigurationKey const fb_config_video_and_endcard_autorotate = @"video_and_endcard_autorotate";
+static MPConfigurationKey const fb_config_video_quality_rules = @"video_quality_rules";
+static MPConfigurationKey const fb_config_video_client_token_pattern = @"video_client_token_pattern";
+static MPConfigurationKey const fb_config_quality_adaptive_sampling_enabled = @"quality_adaptive_sampling_enabled";
+static MPConfigurationKey const fb_config_quality_adaptive_sampling_max_error_percentage = @"quality_adaptive_sampling_max_error_percentage";
+static MPConfigurationKey const fb_config_quality_background_processing_enabled = @"quality_background_processing_enabled";
 static MPConfigurationKey const fb_config_in_app_app_store_disabled = @"disable_in_app_app_store";
 static MPConfigurationKey const fb_config_use_cached_image_context_for_software_renderer
 = @"use_cached_image_context_for_software_renderer";
@@ -246,11 +253,21 @@ FB_FINAL_CLASS(objc_getClass("MPConfigManager"));
   return [self timeIntervalforKey:fb_config_unified_logging_immediate_delay_ms defaultReturnValue:500];
 }
 
+- (NSTimeInterval)unifiedLoggingImmediateMaxDelay
+{
+  return [self timeIntervalforKey:fb_config_unified_logging_immediate_max_delay_ms defaultReturnValue:2000];
+}
+
 - (NSInteger)unifiedLoggingEventLimit
 {
   return [self integerForKey:fb_config_unified_logging_event_limit defaultReturnValue:0];
 }
 
+- (BOOL)isUnifiedLoggingSymbolCodedPayloadEnabled
+{
+  return [self boolForKey:fb_config_unified_logging_symbol_coded_payload defaultReturnValue:NO];
+}
+
 - (NSInteger)adTapMarginPercentage
 {
   return [self integerForKey:fb_config_ad_viewability_tap_margin defaultReturnValue:0];
@@ -292,6 +309,31 @@ FB_FINAL_CLASS(objc_getClass("MPConfigManager"));
   return [self stringForKey:fb_config_video_and_endcard_autorotate defaultReturnValue:@"autorotate_disabled"];
 }
 
+- (NSString *)videoQualityRuleSpecification
+{
+  return [self stringForKey:fb_config_video_quality_rules defaultReturnValue:@""];
+}
+
+- (NSString *)videoClientTokenPattern
+{
+  return [self stringForKey:fb_config_video_client_token_pattern defaultReturnValue:@"brightcove"];
+}
+
+- (BOOL)isQualityAdaptiveSamplingEnabled
+{
+  return [self boolForKey:fb_config_quality_adaptive_sampling_enabled defaultReturnValue:NO];
+}
+
+- (NSInteger)qualityAdaptiveSamplingMaxErrorPercentage
+{
+  return [self integerForKey:fb_config_quality_adaptive_sampling_max_error_percentage defaultReturnValue:2];
+}
+
+- (BOOL)isQualityBackgroundProcessingEnabled
+{
+  return [self boolForKey:fb_config_quality_background_processing_enabled defaultReturnValue:YES];
+}
+
 - (BOOL)isRVPlayPauseButtonEnabled
 {
   return [self boolForKey:fb_config_rv_play_pause_button_enabled defaultReturnValue:NO];
@@ -0,0 +1,71 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+
+namespace mp {
+
+/**
+ * Debounce with a max wait. The first request arms a deadline `delay` from
+ * now; later requests push the deadline out by `delay` again, but never past
+ * `maxWait` after the first request. Delivery latency is therefore bounded
+ * by `maxWait` no matter how steady the stream of requests is.
+ *
+ * Times are plain monotonic seconds; the caller owns synchronization.
+ */
+class DispatchDebouncer {
+ public:
+  // Returns the deadline the pending flush should fire at.
+  double request(double now, double delay, double maxWait)
+  {
+    maxWait = std::max(maxWait, delay);
+    if (!_armed) {
+      _armed = true;
+      _firstRequest = now;
+      _deadline = now + delay;
+    } else {
+      _deadline = std::min(std::max(_deadline, now + delay), _firstRequest + maxWait);
+    }
+    return _deadline;
+  }
+
+  // Call once the flush has run (or been superseded).
+  void reset()
+  {
+    _armed = false;
+  }
+
+  bool armed() const
+  {
+    return _armed;
+  }
+
+  double deadline() const
+  {
+    return _deadline;
+  }
+
+ private:
+  bool _armed = false;
+  double _firstRequest = 0;
+  double _deadline = 0;
+};
+
+} // namespace mp
@@ -0,0 +1,77 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "MPArena.hpp"
+#include "MPUUID.hpp"
+
+namespace mp {
+
+// Formats straight into the arena; no NSString is created.
+inline void appendUUIDString(ArenaString &string, MPUUID uuid)
+{
+  char text[MPUUIDStringLength + 1];
+  MPUUIDFormat(uuid, text);
+  string.append(text, MPUUIDStringLength);
+}
+
+/**
+ * `prefix` followed by an eventId = "..." term for every id, joined by OR:
+ * the SELECT and DELETE statements run once the server has answered a batch.
+ */
+inline const char *eventIdQuery(Arena &arena, const char *prefix, const ArenaVector<MPUUID> &eventIds)
+{
+  ArenaString query(arena, std::strlen(prefix) + eventIds.size() * 52 + 1);
+  query.append(prefix);
+  bool next = false;
+  for (const MPUUID &eventId : eventIds) {
+    if (next) {
+      query.append(" OR ");
+    }
+    query.append("eventId = \"");
+    appendUUIDString(query, eventId);
+    query.append("\"");
+    next = true;
+  }
+  return query.c_str();
+}
+
+/**
+ * The tokens query of a dispatch batch. Sorts `tokenIds` and drops the
+ * duplicates in place, so each token is asked for once.
+ */
+inline const char *tokenQuery(Arena &arena, ArenaVector<MPUUID> &tokenIds)
+{
+  std::sort(tokenIds.begin(), tokenIds.end());
+  tokenIds.truncate((std::size_t)(std::unique(tokenIds.begin(), tokenIds.end()) - tokenIds.begin()));
+  ArenaString query(arena, 32 + tokenIds.size() * 50);
+  query.append("SELECT * FROM tokens WHERE ");
+  for (const MPUUID &tokenId : tokenIds) {
+    query.append("tokenId = \"");
+    appendUUIDString(query, tokenId);
+    query.append("\" OR ");
+  }
+  query.append("1");
+  return query.c_str();
+}
+
+} // namespace mp
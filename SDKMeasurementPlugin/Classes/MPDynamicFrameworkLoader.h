@@ -374,6 +374,7 @@ SQLITE_API const unsigned char * SQLITE_STDCALL mpsdk_dfl_sqlite3_column_text(sq
 SQLITE_API int SQLITE_STDCALL mpsdk_dfl_sqlite3_column_int(sqlite3_stmt *pStmt, int iCol);
 SQLITE_API sqlite3_int64 SQLITE_STDCALL mpsdk_dfl_sqlite3_column_int64(sqlite3_stmt*, int iCol);
 SQLITE_API double SQLITE_STDCALL mpsdk_dfl_sqlite3_column_double(sqlite3_stmt*, int iCol);
+SQLITE_API int SQLITE_STDCALL mpsdk_dfl_sqlite3_column_type(sqlite3_stmt*, int iCol);
 
 SQLITE_API int SQLITE_STDCALL mpsdk_dfl_sqlite3_extended_errcode(sqlite3 *db);
 SQLITE_API const char * SQLITE_STDCALL mpsdk_dfl_sqlite3_errmsg(sqlite3 *db);
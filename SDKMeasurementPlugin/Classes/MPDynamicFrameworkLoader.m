@@ -1664,6 +1664,7 @@ typedef const unsigned char * (*sqlite3_column_text_type)(sqlite3_stmt*, int);
 typedef int (*sqlite3_column_int_type)(sqlite3_stmt*, int);
 typedef sqlite3_int64 (*sqlite3_column_int64_type)(sqlite3_stmt*, int);
 typedef double (*sqlite3_column_double_type)(sqlite3_stmt*, int);
+typedef int (*sqlite3_column_type_type)(sqlite3_stmt*, int);
 
 typedef int (*sqlite3_extended_errcode_type)(sqlite3 *);
 typedef const char * (*sqlite3_errmsg_type)(sqlite3 *);
@@ -1738,6 +1739,12 @@ SQLITE_API double SQLITE_STDCALL mpsdk_dfl_sqlite3_column_double(sqlite3_stmt *p
   return f(pStmt, iCol);
 }
 
+SQLITE_API int SQLITE_STDCALL mpsdk_dfl_sqlite3_column_type(sqlite3_stmt *pStmt, int iCol)
+{
+  _mpsdk_dfl_sqlite3_get_f(sqlite3_column_type);
+  return f(pStmt, iCol);
+}
+
 SQLITE_API int SQLITE_STDCALL mpsdk_dfl_sqlite3_extended_errcode(sqlite3 *db)
 {
   _mpsdk_dfl_sqlite3_get_f(sqlite3_extended_errcode);
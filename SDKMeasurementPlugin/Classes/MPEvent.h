@@ -21,6 +21,7 @@
 #import <Foundation/Foundation.h>
 
 #import "MPUtility.h"
+#import "MPUUID.h"
 
 @class MPEventToken;
 
@@ -46,11 +47,25 @@ static MPEventType const MPEventTypeDebug = @"debug";
 
 @interface MPEvent : NSObject
 
+/**
+ Ids are held as plain 128-bit values; eventId and tokenId build an NSUUID
+ from them on every call, so hot paths should use the MPUUID forms.
+ */
+@property (nonatomic, assign, readonly) MPUUID eventUUID;
 @property (nonatomic, copy, readonly) NSUUID *eventId;
 @property (nonatomic, copy, readonly) MPEventType type;
 @property (nonatomic, copy, readonly) NSDate *time;
 @property (nonatomic, assign, readonly) MPEventPriority priority;
 @property (nonatomic, copy, readonly, nullable) NSDictionary<NSString *, id> *extraData;
+/**
+ The extra data JSON exactly as stored, for events read back from the
+ database. extraData is decoded from it lazily, only if asked for.
+ */
+@property (nonatomic, copy, readonly, nullable) NSData *rawExtraData;
+/**
+ The nil UUID when the event has no token.
+ */
+@property (nonatomic, assign, readonly) MPUUID tokenUUID;
 @property (nonatomic, copy, readonly, nullable) NSUUID *tokenId;
 @property (nonatomic, copy) NSUUID *sessionId;
 @property (nonatomic, copy) NSDate *sessionStartTime;
@@ -20,19 +20,23 @@
 
 #import "MPDebugLogging.h"
 #import "MPDynamicFrameworkLoader.h"
+#import "MPMonotonicTime.h"
+#import "MPPayloadDecoder.h"
+#import "MPSymbols.h"
 #import "MPUtilityFunctions.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @interface MPEvent ()
 
-@property (nonatomic, copy, readwrite) NSUUID *eventId;
+@property (nonatomic, assign, readwrite) MPUUID eventUUID;
 @property (nonatomic, copy, readwrite) MPEventType type;
 @property (nonatomic, copy, readwrite) NSDate *time;
 @property (nonatomic, copy, readwrite) NSDate *expiration;
 @property (nonatomic, assign, readwrite) MPEventPriority priority;
 @property (nonatomic, copy, readwrite, nullable) NSDictionary<NSString *, id> *extraData;
-@property (nonatomic, copy, readwrite, nullable) NSUUID *tokenId;
+@property (nonatomic, copy, readwrite, nullable) NSData *rawExtraData;
+@property (nonatomic, assign, readwrite) MPUUID tokenUUID;
 
 @end
 
@@ -48,11 +52,12 @@ NS_ASSUME_NONNULL_BEGIN
   self = [super init];
   if (self) {
     _type = type;
-    _eventId = [NSUUID UUID];
+    // Time-ordered so inserts land at the right edge of the eventId index
+    _eventUUID = MPUUIDGenerateV7(FBMonotonicTimeGetUnixMilliseconds());
     _time = [NSDate date];
     _priority = priority;
     _extraData = extraData;
-    _tokenId = tokenId;
+    _tokenUUID = tokenId ? MPUUIDFromNSUUID(MPUnwrap(tokenId)) : (MPUUID){0, 0};
     _sessionId = sessionId;
     _sessionStartTime = sessionStartTime;
     _attemptsCount = 1;
@@ -68,16 +73,24 @@ NS_ASSUME_NONNULL_BEGIN
   const char *eventId = (const char *)mpsdk_dfl_sqlite3_column_text(queryStatement, 0);
   const char *tokenId = (const char *)mpsdk_dfl_sqlite3_column_text(queryStatement, 1);
   sqlite3_int64 priority = mpsdk_dfl_sqlite3_column_int64(queryStatement, 2);
-  const char *type = (const char *)mpsdk_dfl_sqlite3_column_text(queryStatement, 3);
+  // Known types are stored as their symbol code, which the TEXT column keeps
+  // as decimal text; older rows and unknown types hold the string.
+  const char *storedType = (const char *)mpsdk_dfl_sqlite3_column_text(queryStatement, 3);
+  NSString *symbolType = MPSymbolStringForStoredText(storedType);
+  const char *type = symbolType ? symbolType.UTF8String : storedType;
   double time = mpsdk_dfl_sqlite3_column_double(queryStatement, 4);
   const char *sessionId = (const char *)mpsdk_dfl_sqlite3_column_text(queryStatement, 5);
   double sessionStartTime = mpsdk_dfl_sqlite3_column_double(queryStatement, 6);
   const char *jsonExtraData = (const char *)mpsdk_dfl_sqlite3_column_text(queryStatement, 7);
   sqlite3_int64 attemptsCount = mpsdk_dfl_sqlite3_column_int64(queryStatement, 8);
   
-  id extraData = nil;
+  // Validated in place; decoding is deferred until someone reads extraData.
+  NSData *rawExtraData = nil;
   if (jsonExtraData) {
-    extraData = [MPUtility getObjectFromJSONString:@(jsonExtraData)];
+    size_t length = strlen(jsonExtraData);
+    if ([MPPayloadDecoder isJSONObjectBytes:jsonExtraData length:length]) {
+      rawExtraData = [NSData dataWithBytes:jsonExtraData length:length];
+    }
   }
   
   if (!eventId || !type || !sessionId) {
@@ -91,28 +104,55 @@ NS_ASSUME_NONNULL_BEGIN
     return nil;
   }
   
-  NSUUID * __nullable tokenUUID = nil;
+  // Parsed straight from the column text, without building NSStrings
+  MPUUID tokenUUID = {0, 0};
   if (tokenId) {
-    tokenUUID = [[NSUUID alloc] initWithUUIDString:@(tokenId)];
+    MPUUIDParse(tokenId, strlen(tokenId), &tokenUUID);
+  }
+  MPUUID eventUUID;
+  if (!MPUUIDParse(eventId, strlen(eventId), &eventUUID)) {
+    eventUUID = MPUUIDGenerateV4();
   }
   NSUUID *sessionUUID = [[NSUUID alloc] initWithUUIDString:@(sessionId)];
-  NSUUID *eventUUID = [[NSUUID alloc] initWithUUIDString:@(eventId)];
   
-  MPEvent *event = [[MPEvent alloc] initWithType:@(type)
+  MPEvent *event = [[MPEvent alloc] initWithType:symbolType ?: @(type)
                                         withPriority:(MPEventPriority)priority
-                                         withTokenId:tokenUUID
+                                         withTokenId:nil
                                        withSessionId:sessionUUID ?: [NSUUID UUID]
                                 withSessionStartTime:[NSDate dateWithTimeIntervalSince1970:sessionStartTime]
-                                       withExtraData:extraData];
-  event.eventId = eventUUID ?: [NSUUID UUID];
+                                       withExtraData:nil];
+  event.rawExtraData = rawExtraData;
+  event.eventUUID = eventUUID;
+  event.tokenUUID = tokenUUID;
   event.time = [NSDate dateWithTimeIntervalSince1970:time];
   event.attemptsCount = attemptsCount;
   
   return event;
 }
 
+- (NSUUID *)eventId
+{
+  return MPUUIDToNSUUID(_eventUUID);
+}
+
+- (nullable NSUUID *)tokenId
+{
+  return MPUUIDIsNil(_tokenUUID) ? nil : MPUUIDToNSUUID(_tokenUUID);
+}
+
+- (nullable NSDictionary<NSString *, id> *)extraData
+{
+  if (!_extraData && _rawExtraData) {
+    _extraData = [MPPayloadDecoder extraDataFromJSONData:_rawExtraData];
+  }
+  return _extraData;
+}
+
 - (nullable NSString *)jsonExtraData
 {
+  if (_rawExtraData) {
+    return [[NSString alloc] initWithData:MPUnwrap(_rawExtraData) encoding:NSUTF8StringEncoding];
+  }
   return [MPUtility getJSONStringFromObject:self.extraData];
 }
 
@@ -59,6 +59,7 @@ typedef void (^MPEventTokenIdCallback)(NSUUID * __nullable tokenId);
 // test purpose only
 + (char const *)tokenTableString;
 + (char const *)eventTableString;
+- (void)insertEvent:(MPEvent *)event withDatabase:(sqlite3 *)db withCallback:(nullable FB_NOESCAPE MPEventVoidCallback)callback;
 //- (void)updateAttemptCountForEvent:(MPEvent *)event withDatabase:(sqlite3 *)db withCallback:(nullable FB_NOESCAPE MPEventVoidCallback)callback;
 
 @end
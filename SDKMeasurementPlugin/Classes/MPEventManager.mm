@@ -20,15 +20,27 @@
 
 #import <sqlite3.h>
 
-#import "MPConcurrentArray.h"
+#import <memory>
+#import <vector>
+
 #import "MPConfigManager.h"
+#import "MPArena.hpp"
+#import "MPByteBuffer.hpp"
 #import "MPDatabaseManager.h"
 #import "MPDebugLogging.h"
 #import "MPDefines+Internal.h"
+#import "MPDispatchDebouncer.hpp"
+#import "MPDispatchQuery.hpp"
 #import "MPDynamicFrameworkLoader.h"
+#import "MPMonotonicTime.h"
+#import "MPPayloadDecoder.h"
+#import "MPPayloadEncoder.h"
 #import "MPSettings+Internal.h"
+#import "MPShardedSet.hpp"
+#import "MPSymbols.h"
 #import "MPTimer.h"
 #import "MPURLSession.h"
+#import "MPUUID.hpp"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -49,13 +61,23 @@ static const NSTimeInterval FB_EVENT_RETRY_TIME = 5.0;
 static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
 
 @interface MPEventManager ()
+{
+  // Event ids waiting on a server response
+  mp::ShardedSet<MPUUID, mp::UUIDHash> _eventsInTransit;
+  // Only touched on dispatchTimerQueue
+  mp::DispatchDebouncer _dispatchDebouncer;
+  // Reused for every insert; only touched on the database queue
+  mp::ByteBuffer _extraDataBuffer;
+  // Per-batch scratch for the ids and SQL of a dispatch and of its response;
+  // reset at the start of each database queue block that uses it
+  mp::Arena _dispatchArena;
+}
 
 @property (nonatomic, strong, readwrite) NSUUID *sessionId;
 @property (nonatomic, strong) NSDate *sessionStartTime;
 @property (nonatomic, strong) MPDatabaseManager *databaseManager;
 @property (nonatomic, strong) MPTimer *dispatchTimer;
 @property (nonatomic, strong) dispatch_queue_t dispatchTimerQueue;
-@property (nonatomic, strong) MPConcurrentArray<NSString *> *eventsInTransit;
 @property (nonatomic, assign) NSUInteger sendAttempts;
 
 @end
@@ -79,7 +101,6 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
     _sessionId = [NSUUID UUID];
     _sessionStartTime = [NSDate date];
     _databaseManager = databaseManager;
-    _eventsInTransit = [MPConcurrentArray array];
     _dispatchTimerQueue = dispatch_queue_create("com.facebook.ads.serialTimerQueue", nullptr);
     [self setupDatabaseWithCallback:nil];
     [self resetDispatchTimerWithTimeInterval:FB_EVENT_MUST_DISPATCH_TIME];
@@ -92,16 +113,27 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
   weakify(self);
   dispatch_async(self.dispatchTimerQueue, ^{
     strongify(self);
-    [self.dispatchTimer invalidate];
-    weakify(self);
-    self.dispatchTimer = [MPTimer scheduledTimerWithTimeInterval:timeInterval repeats:NO queue:self.dispatchTimerQueue block:^(MPTimer *timer) {
-      strongify(self);
-      [self dispatchEventsImmediately];
-      [self resetDispatchTimerWithTimeInterval:FB_EVENT_MUST_DISPATCH_TIME];
-    }];
+    self->_dispatchDebouncer.reset();
+    [self armDispatchTimerWithTimeInterval:timeInterval];
   });
 }
 
+// Must be called on dispatchTimerQueue. Moves the pending timer when there is
+// one instead of tearing it down and creating a new one.
+- (void)armDispatchTimerWithTimeInterval:(NSTimeInterval)timeInterval
+{
+  if ([self.dispatchTimer rescheduleWithTimeInterval:timeInterval]) {
+    return;
+  }
+  weakify(self);
+  self.dispatchTimer = [MPTimer scheduledTimerWithTimeInterval:timeInterval repeats:NO queue:self.dispatchTimerQueue block:^(MPTimer *timer) {
+    strongify(self);
+    self->_dispatchDebouncer.reset();
+    [self dispatchEventsImmediately];
+    [self resetDispatchTimerWithTimeInterval:FB_EVENT_MUST_DISPATCH_TIME];
+  }];
+}
+
 - (void)migrateDatabaseV1ToV2:(sqlite3 *)db
 {
   [self.databaseManager insertWithStatementSync:"ALTER TABLE events ADD attempt BIGINT DEFAULT 1"
@@ -160,10 +192,13 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
                             if (!tokenId && token) {
                               MPEventToken *tokenObj = [[MPEventToken alloc] initWithToken:MPUnwrap(token)];
                               tokenId = tokenObj.tokenId;
+                              char tokenIdBuffer[MPUUIDStringLength + 1];
+                              MPUUIDFormat(tokenObj.tokenUUID, tokenIdBuffer);
+                              const char *tokenIdText = tokenIdBuffer;
                               [self.databaseManager insertWithStatementSync:"INSERT INTO tokens (tokenId, token) VALUES (?, ?);"
                                                                withDatabase:db
                                                       withStatementCallback:^(sqlite3_stmt *pStmt) {
-                                                        mpsdk_dfl_sqlite3_bind_text(pStmt, 1, tokenObj.tokenId.UUIDString.UTF8String, -1, nil);
+                                                        mpsdk_dfl_sqlite3_bind_text(pStmt, 1, tokenIdText, MPUUIDStringLength, SQLITE_STATIC);
                                                         mpsdk_dfl_sqlite3_bind_text(pStmt, 2, tokenObj.token.UTF8String, -1, nil);
                                                       } withCompletionCallback:^(NSError *error) {
                                                         if ([error.domain isEqualToString:MPDatabaseManagerCriticalErrorDomain]) {
@@ -287,7 +322,17 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
 
 - (void)dispatchEvents
 {
-  [self resetDispatchTimerWithTimeInterval:[[MPConfigManager sharedManager] unifiedLoggingImmediateDelay]];
+  // Debounced: a steady stream of immediate events keeps extending the wait,
+  // but never past the max delay after the first one.
+  NSTimeInterval delay = [[MPConfigManager sharedManager] unifiedLoggingImmediateDelay];
+  NSTimeInterval maxDelay = [[MPConfigManager sharedManager] unifiedLoggingImmediateMaxDelay];
+  weakify(self);
+  dispatch_async(self.dispatchTimerQueue, ^{
+    strongify(self);
+    FBMonotonicTimeSeconds now = FBMonotonicTimeGetCurrentSeconds();
+    FBMonotonicTimeSeconds deadline = self->_dispatchDebouncer.request(now, delay, maxDelay);
+    [self armDispatchTimerWithTimeInterval:deadline - now];
+  });
 }
 
 - (void)dispatchEventsImmediately
@@ -295,26 +340,32 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
   self.sendAttempts++;
   
   [self.databaseManager getDatabase:^(sqlite3 *db) {
-    NSMutableString *eventQueryString = [NSMutableString stringWithFormat:@"SELECT * FROM events"];
+    mp::Arena &arena = self->_dispatchArena;
+    arena.reset();
+    mp::ArenaString eventQueryString(arena);
+    eventQueryString.append("SELECT * FROM events");
     NSInteger eventLimit = [[MPConfigManager sharedManager] unifiedLoggingEventLimit];
     if (eventLimit > 0) {
-      [eventQueryString appendFormat:@" LIMIT %ld", (long)eventLimit];
+      char limit[32];
+      eventQueryString.append(limit, (size_t)snprintf(limit, sizeof(limit), " LIMIT %ld", (long)eventLimit));
     }
     
-    [self queryEventsSyncWithStatement:(const char *)eventQueryString.UTF8String withDatabase:db withCallback:^(NSMutableArray<MPEvent *> *events) {
+    [self queryEventsSyncWithStatement:eventQueryString.c_str() withDatabase:db withCallback:^(NSMutableArray<MPEvent *> *events) {
       try {
         // Exclude events waiting on a response and update transit list
-        NSArray *eventIdsInTransit = [self.eventsInTransit nonConcurrentCopy];
-        NSMutableArray<MPEvent *> *eventsToRemove = [NSMutableArray arrayWithCapacity:eventIdsInTransit.count];
-        NSMutableSet<NSString*> *newTransitEvents = [NSMutableSet set];
+        BOOL hadEventsInTransit = !self->_eventsInTransit.empty();
+        NSMutableArray<MPEvent *> *eventsToRemove = [NSMutableArray array];
+        // Shared with the retry block below, which outlives this one and so
+        // cannot use the arena
+        auto newTransitEvents = std::make_shared<std::vector<MPUUID>>();
+        newTransitEvents->reserve(events.count);
         for (MPEvent *event in events) {
-          if ([eventIdsInTransit containsObject:event.eventId.UUIDString]) {
-            [eventsToRemove addObject:event];
+          const MPUUID eventUUID = event.eventUUID;
+          // Add event to transit list unless it is already there
+          if (self->_eventsInTransit.insert(eventUUID)) {
+            newTransitEvents->push_back(eventUUID);
           } else {
-            // Add event to transit list
-            NSString *eventId = event.eventId.UUIDString;
-            [newTransitEvents addObject:eventId];
-            [self.eventsInTransit addObject:eventId];
+            [eventsToRemove addObject:event];
           }
         }
         [events removeObjectsInArray:eventsToRemove];
@@ -322,46 +373,41 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
         
         // Exit early if no events are found
         if (events.count == 0) {
-          if (eventIdsInTransit.count == 0) {
+          if (!hadEventsInTransit) {
             self.sendAttempts = 0;
           }
           return;
         }
         
-        // Get all event ids to query
-        NSMutableSet *tokenIds = [NSMutableSet setWithCapacity:events.count];
+        // Get all token ids to query
+        mp::Arena &batchArena = self->_dispatchArena;
+        mp::ArenaVector<MPUUID> tokenIds(batchArena, events.count);
         for (MPEvent *event in events) {
-          if (event.tokenId) {
-            [tokenIds addObject:MPUnwrap(event.tokenId)];
+          if (!MPUUIDIsNil(event.tokenUUID)) {
+            tokenIds.push_back(event.tokenUUID);
           }
         }
+        const char *tokenQueryString = mp::tokenQuery(batchArena, tokenIds);
         
-        // Construct token query string
-        NSMutableString *tokenQueryString = [NSMutableString stringWithFormat:@"SELECT * FROM tokens WHERE "];
-        for (NSUUID *tokenId in tokenIds) {
-          [tokenQueryString appendFormat:@"tokenId = \"%@\" OR ", tokenId.UUIDString];
-        }
-        [tokenQueryString appendString:@"1"];
-        
-        [self queryTokensSyncWithStatement:(const char *)tokenQueryString.UTF8String withDatabase:db withCallback:^(NSArray<MPEventToken *> *tokens) {
+        [self queryTokensSyncWithStatement:tokenQueryString withDatabase:db withCallback:^(NSArray<MPEventToken *> *tokens) {
           try {
             NSURL *eventURL = [MPSettings getBaseEventURL];
             MPLogDebug(@"Logging %lu event%s with %lu token%s to %@...", (unsigned long)events.count, events.count > 1 ? "s" : "", (unsigned long)tokens.count, tokens.count > 1 ? "s" : "", eventURL.absoluteString);
             // Construct request data
             NSMutableDictionary *tokenDict = [NSMutableDictionary dictionaryWithCapacity:tokens.count];
             NSMutableArray *eventArray = [NSMutableArray arrayWithCapacity:events.count];
+            const BOOL symbolCoded = [MPConfigManager sharedManager].isUnifiedLoggingSymbolCodedPayloadEnabled;
             for (MPEvent *event in events) {
-              NSMutableDictionary *mutableEventData = [@{@"id": event.eventId.UUIDString,
-                                                         @"type": event.type,
+              NSMutableDictionary *mutableEventData = [@{@"id": MPUUIDToString(event.eventUUID),
+                                                         @"type": symbolCoded ? [self symbolCodedString:event.type] : event.type,
                                                          @"time": @(event.time.timeIntervalSince1970).stringValue,
                                                          @"session_id": event.sessionId.UUIDString,
                                                          @"session_time": @(event.sessionStartTime.timeIntervalSince1970).stringValue,
-                                                         @"data": event.extraData ? MPUnwrap(event.extraData) : @{},
+                                                         @"data": symbolCoded ? [self symbolCodedExtraDataForEvent:event] : [self payloadExtraDataForEvent:event],
                                                          @"attempt": [@(event.attemptsCount) stringValue]
                                                          } mutableCopy];
-              NSUUID *tokenId = event.tokenId;
-              if (tokenId) {
-                mutableEventData[@"token_id"] = MPUnwrap(tokenId.UUIDString);
+              if (!MPUUIDIsNil(event.tokenUUID)) {
+                mutableEventData[@"token_id"] = MPUUIDToString(event.tokenUUID);
               }
               NSDictionary *eventData = [NSDictionary dictionaryWithDictionary:mutableEventData];
               [eventArray addObject:eventData];
@@ -369,15 +415,21 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
               //                            [event logStatusMessage];
             }
             for (MPEventToken *token in tokens) {
-              [tokenDict setObject:token.token forKey:token.tokenId.UUIDString];
-              MPLogDebug(@"Logging token with token ID: %@", token.tokenId.UUIDString);
+              NSString *tokenId = MPUUIDToString(token.tokenUUID);
+              [tokenDict setObject:token.token forKey:tokenId];
+              MPLogDebug(@"Logging token with token ID: %@", tokenId);
+            }
+            NSMutableDictionary *payload = [@{
+                                              @"tokens": tokenDict,
+                                              @"events": eventArray
+                                              } mutableCopy];
+            if (symbolCoded) {
+              payload[@"symbols"] = @(MPSymbolTableVersion).stringValue;
             }
-            NSDictionary *extraData = @{@"payload":
-                                          @{
-                                            @"tokens": tokenDict,
-                                            @"events": eventArray
-                                            }
-                                        };
+            NSDictionary *extraData = @{@"payload": payload};
+            const mp::Arena::Stats &arenaStats = self->_dispatchArena.stats();
+            MPLogDebug(@"Dispatch batch used %zu arena allocations (%zu bytes, %zu system allocations)",
+                       arenaStats.allocations, arenaStats.bytes, arenaStats.systemAllocations);
             
             [self sendRequestInternal:eventURL withExtraData:extraData onRetry:^{
               [self.databaseManager getDatabase:^(sqlite3 *database) {
@@ -387,8 +439,8 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
                 }
               }];
               
-              for (NSString *eventId in newTransitEvents) {
-                [self.eventsInTransit removeObject:eventId];
+              for (const MPUUID &eventUUID : *newTransitEvents) {
+                self->_eventsInTransit.erase(eventUUID);
               }
             }];
           } catch (...) {
@@ -429,7 +481,7 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
                                        [self.databaseManager getDatabase:^(sqlite3 *db) {
                                          [self.databaseManager deleteWithStatementSync:"DELETE FROM events" withDatabase:db withCallback:nil];
                                          [self.databaseManager deleteWithStatementSync:"DELETE FROM tokens" withDatabase:db withCallback:nil];
-                                         [self.eventsInTransit removeAllObjects];
+                                         self->_eventsInTransit.clear();
                                          self.sendAttempts = 0;
                                        }];
                                        return;
@@ -442,21 +494,27 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
                                      return;
                                    }
                                    [self.databaseManager getDatabase:^(sqlite3 *db) {
-                                     NSArray *jsonObj = [MPUtility getObjectFromJSONData:data];
-                                     BOOL shouldRetry = NO;
-                                     NSMutableArray<NSString *> *eventIdsToCleanup = [NSMutableArray arrayWithCapacity:jsonObj.count];
-                                     for (NSDictionary *eventResult in jsonObj) {
-                                       NSString *eventId = [eventResult stringForKeyOrNil:@"id"];
-                                       NSString *eventStatus = [eventResult stringForKeyOrNil:@"code"];
+                                     __block BOOL shouldRetry = NO;
+                                     mp::Arena &arena = self->_dispatchArena;
+                                     arena.reset();
+                                     // Held by pointer so the enumeration and query blocks share it
+                                     auto *eventIdsToCleanup = arena.make<mp::ArenaVector<MPUUID>>(arena, 64);
+                                     [MPPayloadDecoder enumerateDispatchResultsInData:data usingBlock:^(NSString * __nullable eventId, NSString * __nullable eventStatus) {
+                                       // Ids that do not parse cannot match anything we sent
+                                       MPUUID eventUUID = {0, 0};
+                                       const char *eventIdText = eventId.UTF8String;
+                                       const BOOL hasEventUUID = eventIdText && MPUUIDParse(eventIdText, strlen(eventIdText), &eventUUID);
                                        // Remove event from transit status
-                                       [self.eventsInTransit removeObject:eventId];
+                                       if (hasEventUUID) {
+                                         self->_eventsInTransit.erase(eventUUID);
+                                       }
                                        
                                        // Check if successful, if it's retriable, or just remove the event
                                        if ([self isEventSuccessful:eventStatus]) {
                                          // Success, remove old events
                                          MPLogDebug(@"Event with event ID %@ logged successfully.", eventId);
-                                         if (eventId) {
-                                           [eventIdsToCleanup addObject:eventId];
+                                         if (hasEventUUID) {
+                                           eventIdsToCleanup->push_back(eventUUID);
                                          }
                                        } else if ([self isEventRetriable:eventStatus]) {
                                          // Failure, retry
@@ -464,25 +522,17 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
                                          shouldRetry = YES;
                                        } else {
                                          MPLogDebug(@"Event with event ID %@ failed.", eventId);
-                                         if (eventId) {
-                                           [eventIdsToCleanup addObject:eventId];
+                                         if (hasEventUUID) {
+                                           eventIdsToCleanup->push_back(eventUUID);
                                          }
                                        }
-                                     }
-                                     NSMutableString *queryString = [NSMutableString stringWithFormat:@"SELECT * FROM events WHERE "];
-                                     BOOL next = NO;
-                                     for (NSUUID *eventId in eventIdsToCleanup) {
-                                       if (next) {
-                                         [queryString appendString:@" OR "];
-                                       }
-                                       [queryString appendFormat:@"eventId = \"%@\"", eventId];
-                                       next = YES;
-                                     }
-                                     [self queryEventsSyncWithStatement:(const char *)queryString.UTF8String withDatabase:db withCallback:^(NSMutableArray<MPEvent *> *eventsToBeCleanedUp) {
+                                     }];
+                                     const char *queryString = mp::eventIdQuery(arena, "SELECT * FROM events WHERE ", *eventIdsToCleanup);
+                                     [self queryEventsSyncWithStatement:queryString withDatabase:db withCallback:^(NSMutableArray<MPEvent *> *eventsToBeCleanedUp) {
                                        for (MPEvent *eventToBeCleanedUp in eventsToBeCleanedUp) {
                                          MPLogDebug(@"Event %@ has been finalized and will be cleaned up.", eventToBeCleanedUp);
                                        }
-                                       [self cleanupEventsSync:eventIdsToCleanup withDatabase:db];
+                                       [self cleanupEventsSync:*eventIdsToCleanup withDatabase:db];
                                      }];
                                      if (shouldRetry) {
                                        FB_BLOCK_CALL_SAFE(onRetryBlock);
@@ -494,6 +544,38 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
                                  }];
 }
 
+// Stored extra data goes back out verbatim instead of being decoded and re-encoded.
+- (id)payloadExtraDataForEvent:(MPEvent *)event
+{
+  NSData *rawExtraData = event.rawExtraData;
+  if (rawExtraData) {
+    return [[MPPayloadJSONFragment alloc] initWithData:rawExtraData];
+  }
+  return event.extraData ? MPUnwrap(event.extraData) : @{};
+}
+
+// Dictionary-coded wire format: known event types and parameter keys are sent
+// as their decimal symbol code, and the payload carries the table version in
+// "symbols" so the server can map them back.
+- (NSString *)symbolCodedString:(NSString *)string
+{
+  MPSymbolCode code = MPSymbolCodeForString(string);
+  return code != 0 ? @(code).stringValue : string;
+}
+
+- (NSDictionary *)symbolCodedExtraDataForEvent:(MPEvent *)event
+{
+  NSDictionary<NSString *, id> *extraData = event.extraData;
+  if (!extraData) {
+    return @{};
+  }
+  NSMutableDictionary *coded = [NSMutableDictionary dictionaryWithCapacity:extraData.count];
+  [extraData enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop) {
+    coded[[self symbolCodedString:key]] = obj;
+  }];
+  return coded;
+}
+
 - (BOOL)isEventSuccessful:(NSString *)eventStatus
 {
   return (eventStatus.integerValue == MPEventStatusCodeSuccess);
@@ -506,20 +588,13 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
   return !(code >= 2000 && code < 3000);
 }
 
-- (void)cleanupEventsSync:(NSMutableArray<NSString *> *)eventIds withDatabase:(sqlite3 *)db
+- (void)cleanupEventsSync:(const mp::ArenaVector<MPUUID> &)eventIds withDatabase:(sqlite3 *)db
 {
   FBAssertNotMainThread();
-  if (eventIds.count) {
-    NSMutableString *deleteQueryString = [NSMutableString stringWithFormat:@"DELETE FROM events WHERE "];
-    BOOL next = NO;
-    for (NSUUID *eventId in eventIds) {
-      if (next) {
-        [deleteQueryString appendString:@" OR "];
-      }
-      [deleteQueryString appendFormat:@"eventId = \"%@\"", eventId];
-      next = YES;
-    }
-    [self.databaseManager deleteWithStatementSync:(const char *)deleteQueryString.UTF8String withDatabase:db withCallback:^(NSError *error) {
+  if (!eventIds.empty()) {
+    // Called from the response handler's block, which owns the arena batch.
+    const char *deleteQueryString = mp::eventIdQuery(_dispatchArena, "DELETE FROM events WHERE ", eventIds);
+    [self.databaseManager deleteWithStatementSync:deleteQueryString withDatabase:db withCallback:^(NSError *error) {
       // Cleanup unused tokens
       [self removeAllOrphanedTokensSyncWithDatabase:db withCallback:nil];
     }];
@@ -559,17 +634,49 @@ static const NSTimeInterval FB_EVENT_MUST_DISPATCH_TIME = 5 * 60;
 - (void)insertEvent:(MPEvent *)event withDatabase:(sqlite3 *)db withCallback:(nullable FB_NOESCAPE MPEventVoidCallback)callback
 {
   FBAssertNotMainThread();
+  const MPSymbolCode typeCode = MPSymbolCodeForString(event.type);
+  // Ids are formatted on the stack; a NULL tokenIdText binds SQL NULL.
+  char eventIdBuffer[MPUUIDStringLength + 1];
+  char tokenIdBuffer[MPUUIDStringLength + 1];
+  MPUUIDFormat(event.eventUUID, eventIdBuffer);
+  const char *eventIdText = eventIdBuffer;
+  const char *tokenIdText = NULL;
+  if (!MPUUIDIsNil(event.tokenUUID)) {
+    MPUUIDFormat(event.tokenUUID, tokenIdBuffer);
+    tokenIdText = tokenIdBuffer;
+  }
+  // Bound with SQLITE_STATIC: the bytes outlive the synchronous step.
+  const char *extraDataBytes = NULL;
+  int extraDataLength = -1;
+  NSData *rawExtraData = event.rawExtraData;
+  NSDictionary *extraData = rawExtraData ? nil : event.extraData;
+  NSString *jsonExtraData = nil;
+  if (rawExtraData) {
+    extraDataBytes = (const char *)rawExtraData.bytes;
+    extraDataLength = (int)rawExtraData.length;
+  } else if (extraData && MPPayloadWriteStringDictionaryJSON(MPUnwrap(extraData), _extraDataBuffer)) {
+    extraDataBytes = (const char *)_extraDataBuffer.data();
+    extraDataLength = (int)_extraDataBuffer.size();
+  } else if (extraData) {
+    jsonExtraData = event.jsonExtraData;
+    extraDataBytes = jsonExtraData.UTF8String;
+  }
   [self.databaseManager insertWithStatementSync:"INSERT INTO events (eventId, tokenId, priority, type, time, sessionId, sessionStartTime, data, attempt) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);"
                                    withDatabase:db
                           withStatementCallback:^(sqlite3_stmt *pStmt) {
-                            mpsdk_dfl_sqlite3_bind_text(pStmt, 1, event.eventId.UUIDString.UTF8String, -1, nil);
-                            mpsdk_dfl_sqlite3_bind_text(pStmt, 2, event.tokenId.UUIDString.UTF8String, -1, nil);
+                            mpsdk_dfl_sqlite3_bind_text(pStmt, 1, eventIdText, MPUUIDStringLength, SQLITE_STATIC);
+                            mpsdk_dfl_sqlite3_bind_text(pStmt, 2, tokenIdText, MPUUIDStringLength, SQLITE_STATIC);
                             mpsdk_dfl_sqlite3_bind_int64(pStmt, 3, (sqlite3_int64)event.priority);
-                            mpsdk_dfl_sqlite3_bind_text(pStmt, 4, event.type.UTF8String, -1, nil);
+                            if (typeCode != 0) {
+                              // Stored as decimal text by the column's affinity, see MPSymbolStringForStoredText
+                              mpsdk_dfl_sqlite3_bind_int64(pStmt, 4, (sqlite3_int64)typeCode);
+                            } else {
+                              mpsdk_dfl_sqlite3_bind_text(pStmt, 4, event.type.UTF8String, -1, nil);
+                            }
                             mpsdk_dfl_sqlite3_bind_double(pStmt, 5, (double)event.time.timeIntervalSince1970);
                             mpsdk_dfl_sqlite3_bind_text(pStmt, 6, event.sessionId.UUIDString.UTF8String, -1, nil);
                             mpsdk_dfl_sqlite3_bind_double(pStmt, 7, (double)event.sessionStartTime.timeIntervalSince1970);
-                            mpsdk_dfl_sqlite3_bind_text(pStmt, 8, event.jsonExtraData.UTF8String, -1, nil);
+                            mpsdk_dfl_sqlite3_bind_text(pStmt, 8, extraDataBytes, extraDataLength, SQLITE_STATIC);
                             mpsdk_dfl_sqlite3_bind_int64(pStmt, 9, (sqlite3_int64)event.attemptsCount);
                           } withCompletionCallback:^(NSError *error) {
                             if ([error.domain isEqualToString:MPDatabaseManagerCriticalErrorDomain]) {
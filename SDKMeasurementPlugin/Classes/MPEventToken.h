@@ -21,12 +21,15 @@
 #import <Foundation/Foundation.h>
 
 #import "MPUtility.h"
+#import "MPUUID.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 FB_SUBCLASSING_RESTRICTED
 @interface MPEventToken : NSObject
 
+@property (nonatomic, assign, readonly) MPUUID tokenUUID;
+// Built from tokenUUID on each call
 @property (nonatomic, copy, readonly) NSUUID *tokenId;
 @property (nonatomic, copy, readonly) NSString *token;
 
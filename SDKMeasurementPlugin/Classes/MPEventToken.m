@@ -24,7 +24,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface MPEventToken ()
 
-@property (nonatomic, copy, readwrite) NSUUID *tokenId;
+@property (nonatomic, assign, readwrite) MPUUID tokenUUID;
 @property (nonatomic, copy, readwrite) NSString *token;
 
 @end
@@ -37,7 +37,7 @@ FB_FINAL_CLASS(objc_getClass("MPEventToken"));
 {
   self = [super init];
   if (self) {
-    _tokenId = [NSUUID UUID];
+    _tokenUUID = MPUUIDGenerateV4();
     _token = token;
   }
   return self;
@@ -53,12 +53,19 @@ FB_FINAL_CLASS(objc_getClass("MPEventToken"));
   }
   
   MPEventToken *tokenObj = [[MPEventToken alloc] initWithToken:@(token)];
-  NSUUID *tokenUUID = [[NSUUID alloc] initWithUUIDString:@(tokenId)];
-  tokenObj.tokenId = tokenUUID ?: [NSUUID UUID];
+  MPUUID tokenUUID;
+  if (MPUUIDParse(tokenId, strlen(tokenId), &tokenUUID)) {
+    tokenObj.tokenUUID = tokenUUID;
+  }
   
   return tokenObj;
 }
 
+- (NSUUID *)tokenId
+{
+  return MPUUIDToNSUUID(_tokenUUID);
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,58 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MPByteBuffer.hpp"
+#include "MPURLEncoding.h"
+
+namespace mp {
+
+/**
+ * JSONWriter sink that application/x-www-form-urlencodes everything written
+ * to it, with the same rules as -[NSString fb_URLEncodedString]: unreserved
+ * characters pass through, ' ' becomes '+', everything else is %XX.
+ */
+struct FormEncodingSink {
+  explicit FormEncodingSink(ByteBuffer &buffer) : buffer(buffer) {}
+
+  void push(char byte)
+  {
+    append(&byte, 1);
+  }
+
+  void append(const char *bytes, std::size_t count)
+  {
+    // Worst case every byte expands to three.
+    uint8_t *out = buffer.prepare(count * 3);
+    buffer.commit(FBURLEncode(bytes, count, (char *)out));
+  }
+
+  // Writes bytes that are already form-safe ('=', '&', encoded keys).
+  void appendVerbatim(const char *bytes, std::size_t count)
+  {
+    buffer.append(bytes, count);
+  }
+
+  ByteBuffer &buffer;
+};
+
+} // namespace mp
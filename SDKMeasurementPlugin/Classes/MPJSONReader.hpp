@@ -0,0 +1,500 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mp {
+
+/**
+ * On-demand JSON reader over a byte range. Nothing is materialized unless the
+ * caller asks for it: containers are walked with beginObject/nextKey and
+ * beginArray/nextElement, unwanted values are skipped in place, and strings
+ * without escapes are returned as pointers into the input.
+ *
+ * Every call returns false once the input turns out to be malformed, and the
+ * reader stays failed from then on.
+ */
+class JSONReader {
+ public:
+  enum class Type { Invalid, Object, Array, String, Number, Boolean, Null };
+
+  static constexpr int kMaxDepth = 512;
+
+  JSONReader(const char *bytes, std::size_t length) : _cursor(bytes), _end(bytes + length) {}
+
+  bool failed() const
+  {
+    return _failed;
+  }
+
+  // True when only whitespace remains.
+  bool atEnd()
+  {
+    skipWhitespace();
+    return !_failed && _cursor == _end;
+  }
+
+  Type peek()
+  {
+    skipWhitespace();
+    if (_failed || _cursor == _end) {
+      return Type::Invalid;
+    }
+    switch (*_cursor) {
+      case '{': return Type::Object;
+      case '[': return Type::Array;
+      case '"': return Type::String;
+      case 't':
+      case 'f': return Type::Boolean;
+      case 'n': return Type::Null;
+      default:
+        return (*_cursor == '-' || (*_cursor >= '0' && *_cursor <= '9')) ? Type::Number : Type::Invalid;
+    }
+  }
+
+  bool beginObject()
+  {
+    return open('{');
+  }
+
+  // Advances to the next member and reads its key, or consumes the closing
+  // brace and returns false.
+  bool nextKey(const char *&key, std::size_t &keyLength, std::string &scratch)
+  {
+    if (!next('}')) {
+      return false;
+    }
+    if (!readString(key, keyLength, scratch)) {
+      return false;
+    }
+    skipWhitespace();
+    if (_cursor == _end || *_cursor != ':') {
+      return fail();
+    }
+    _cursor++;
+    return true;
+  }
+
+  bool beginArray()
+  {
+    return open('[');
+  }
+
+  // Advances to the next element, or consumes the closing bracket and returns false.
+  bool nextElement()
+  {
+    return next(']');
+  }
+
+  // Reads a string value. Unescaped strings point into the input; escaped ones
+  // are decoded into `scratch`.
+  bool readString(const char *&value, std::size_t &length, std::string &scratch)
+  {
+    skipWhitespace();
+    if (_failed || _cursor == _end || *_cursor != '"') {
+      return fail();
+    }
+    const char *start = ++_cursor;
+    while (_cursor < _end) {
+      const uint8_t c = (uint8_t)*_cursor;
+      if (c == '"') {
+        value = start;
+        length = (std::size_t)(_cursor - start);
+        _cursor++;
+        return true;
+      }
+      if (c == '\\') {
+        scratch.assign(start, (std::size_t)(_cursor - start));
+        if (!decodeEscapedTail(scratch)) {
+          return false;
+        }
+        value = scratch.data();
+        length = scratch.size();
+        return true;
+      }
+      if (c < 0x20) {
+        return fail();
+      }
+      _cursor++;
+    }
+    return fail();
+  }
+
+  // Validates a number and returns its literal text.
+  bool readNumber(const char *&value, std::size_t &length)
+  {
+    skipWhitespace();
+    const char *start = _cursor;
+    if (_cursor < _end && *_cursor == '-') {
+      _cursor++;
+    }
+    if (_cursor < _end && *_cursor == '0') {
+      _cursor++;
+    } else if (!skipDigits()) {
+      return fail();
+    }
+    if (_cursor < _end && *_cursor == '.') {
+      _cursor++;
+      if (!skipDigits()) {
+        return fail();
+      }
+    }
+    if (_cursor < _end && (*_cursor == 'e' || *_cursor == 'E')) {
+      _cursor++;
+      if (_cursor < _end && (*_cursor == '+' || *_cursor == '-')) {
+        _cursor++;
+      }
+      if (!skipDigits()) {
+        return fail();
+      }
+    }
+    value = start;
+    length = (std::size_t)(_cursor - start);
+    return true;
+  }
+
+  bool readBoolean(bool &value)
+  {
+    skipWhitespace();
+    if (literal("true", 4)) {
+      value = true;
+      return true;
+    }
+    if (literal("false", 5)) {
+      value = false;
+      return true;
+    }
+    return fail();
+  }
+
+  bool readNull()
+  {
+    skipWhitespace();
+    return literal("null", 4) || fail();
+  }
+
+  // Validates and steps over the next value without decoding it.
+  bool skipValue()
+  {
+    const char *begin;
+    std::size_t length;
+    return rawValue(begin, length);
+  }
+
+  // Validates the next value and returns the exact bytes it spans.
+  bool rawValue(const char *&begin, std::size_t &length)
+  {
+    skipWhitespace();
+    begin = _cursor;
+    if (!skipValueAtDepth(0)) {
+      return false;
+    }
+    length = (std::size_t)(_cursor - begin);
+    return true;
+  }
+
+ private:
+  bool fail()
+  {
+    _failed = true;
+    return false;
+  }
+
+  void skipWhitespace()
+  {
+    while (_cursor < _end && (*_cursor == ' ' || *_cursor == '\n' || *_cursor == '\r' || *_cursor == '\t')) {
+      _cursor++;
+    }
+  }
+
+  bool skipDigits()
+  {
+    const char *start = _cursor;
+    while (_cursor < _end && *_cursor >= '0' && *_cursor <= '9') {
+      _cursor++;
+    }
+    return _cursor != start;
+  }
+
+  bool literal(const char *text, std::size_t length)
+  {
+    if ((std::size_t)(_end - _cursor) < length || std::char_traits<char>::compare(_cursor, text, length) != 0) {
+      return false;
+    }
+    _cursor += length;
+    return true;
+  }
+
+  bool open(char brace)
+  {
+    skipWhitespace();
+    if (_failed || _cursor == _end || *_cursor != brace) {
+      return fail();
+    }
+    _cursor++;
+    _first = true;
+    return true;
+  }
+
+  bool next(char closing)
+  {
+    skipWhitespace();
+    if (_failed || _cursor == _end) {
+      return fail();
+    }
+    if (*_cursor == closing) {
+      _cursor++;
+      // An empty nested container must not let its parent skip the comma.
+      _first = false;
+      return false;
+    }
+    if (!_first) {
+      if (*_cursor != ',') {
+        return fail();
+      }
+      _cursor++;
+    }
+    _first = false;
+    return true;
+  }
+
+  bool skipValueAtDepth(int depth)
+  {
+    if (depth > kMaxDepth) {
+      return fail();
+    }
+    const char *text;
+    std::size_t length;
+    bool boolean;
+    switch (peek()) {
+      case Type::Object:
+        beginObject();
+        while (nextKey(text, length, _scratch)) {
+          if (!skipValueAtDepth(depth + 1)) {
+            return false;
+          }
+        }
+        return !_failed;
+      case Type::Array:
+        beginArray();
+        while (nextElement()) {
+          if (!skipValueAtDepth(depth + 1)) {
+            return false;
+          }
+        }
+        return !_failed;
+      case Type::String:
+        return readString(text, length, _scratch);
+      case Type::Number:
+        return readNumber(text, length);
+      case Type::Boolean:
+        return readBoolean(boolean);
+      case Type::Null:
+        return readNull();
+      case Type::Invalid:
+        return fail();
+    }
+    return fail();
+  }
+
+  bool readHex4(uint32_t &value)
+  {
+    if (_end - _cursor < 4) {
+      return fail();
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+      const char c = *_cursor++;
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= (uint32_t)(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        value |= (uint32_t)(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        value |= (uint32_t)(c - 'A' + 10);
+      } else {
+        return fail();
+      }
+    }
+    return true;
+  }
+
+  static void appendUTF8(std::string &out, uint32_t codePoint)
+  {
+    if (codePoint < 0x80) {
+      out.push_back((char)codePoint);
+    } else if (codePoint < 0x800) {
+      out.push_back((char)(0xC0 | (codePoint >> 6)));
+      out.push_back((char)(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+      out.push_back((char)(0xE0 | (codePoint >> 12)));
+      out.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+      out.push_back((char)(0x80 | (codePoint & 0x3F)));
+    } else {
+      out.push_back((char)(0xF0 | (codePoint >> 18)));
+      out.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+      out.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+      out.push_back((char)(0x80 | (codePoint & 0x3F)));
+    }
+  }
+
+  // Continues a string from its first backslash, decoding into `out`.
+  bool decodeEscapedTail(std::string &out)
+  {
+    while (_cursor < _end) {
+      const uint8_t c = (uint8_t)*_cursor++;
+      if (c == '"') {
+        return true;
+      }
+      if (c < 0x20) {
+        return fail();
+      }
+      if (c != '\\') {
+        out.push_back((char)c);
+        continue;
+      }
+      if (_cursor == _end) {
+        return fail();
+      }
+      switch (*_cursor++) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+          uint32_t codePoint;
+          if (!readHex4(codePoint)) {
+            return false;
+          }
+          if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+            uint32_t low;
+            if (_end - _cursor < 2 || _cursor[0] != '\\' || _cursor[1] != 'u') {
+              return fail();
+            }
+            _cursor += 2;
+            if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+              return fail();
+            }
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+          } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+            return fail();
+          }
+          appendUTF8(out, codePoint);
+          break;
+        }
+        default:
+          return fail();
+      }
+    }
+    return fail();
+  }
+
+  const char *_cursor;
+  const char *_end;
+  std::string _scratch;
+  bool _first = false;
+  bool _failed = false;
+};
+
+/**
+ * One entry of the dispatch response, [{"id": ..., "code": ...}, ...].
+ * Numbers are kept as their literal text, as -[NSDictionary stringForKeyOrNil:]
+ * would have returned them.
+ */
+struct DispatchResult {
+  std::string eventId;
+  std::string code;
+  bool hasEventId = false;
+  bool hasCode = false;
+};
+
+/**
+ * Parses the dispatch response into `results`, skipping every member other
+ * than "id" and "code". Non-object elements are ignored. Returns false, and
+ * leaves `results` empty, if the response is not a well-formed JSON array.
+ */
+inline bool parseDispatchResults(const char *bytes, std::size_t length, std::vector<DispatchResult> &results)
+{
+  results.clear();
+  JSONReader reader(bytes, length);
+  std::string keyScratch;
+  std::string valueScratch;
+  if (!reader.beginArray()) {
+    return false;
+  }
+  while (reader.nextElement()) {
+    if (reader.peek() != JSONReader::Type::Object) {
+      if (!reader.skipValue()) {
+        break;
+      }
+      continue;
+    }
+    results.emplace_back();
+    DispatchResult &result = results.back();
+    reader.beginObject();
+    const char *key;
+    std::size_t keyLength;
+    while (reader.nextKey(key, keyLength, keyScratch)) {
+      std::string *target = nullptr;
+      bool *present = nullptr;
+      if (keyLength == 2 && key[0] == 'i' && key[1] == 'd') {
+        target = &result.eventId;
+        present = &result.hasEventId;
+      } else if (keyLength == 4 && std::char_traits<char>::compare(key, "code", 4) == 0) {
+        target = &result.code;
+        present = &result.hasCode;
+      }
+      const JSONReader::Type type = reader.peek();
+      if (!target || (type != JSONReader::Type::String && type != JSONReader::Type::Number)) {
+        if (target) {
+          // Later duplicates win, as they do in NSJSONSerialization.
+          *present = false;
+        }
+        if (!reader.skipValue()) {
+          break;
+        }
+        continue;
+      }
+      const char *value;
+      std::size_t valueLength;
+      const bool ok = type == JSONReader::Type::String ? reader.readString(value, valueLength, valueScratch)
+                                                       : reader.readNumber(value, valueLength);
+      if (!ok) {
+        break;
+      }
+      target->assign(value, valueLength);
+      *present = true;
+    }
+  }
+  if (reader.failed() || !reader.atEnd()) {
+    results.clear();
+    return false;
+  }
+  return true;
+}
+
+} // namespace mp
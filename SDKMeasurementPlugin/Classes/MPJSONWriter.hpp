@@ -0,0 +1,209 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "MPByteBuffer.hpp"
+
+namespace mp {
+
+// Appends bytes verbatim.
+struct ByteBufferSink {
+  explicit ByteBufferSink(ByteBuffer &buffer) : buffer(buffer) {}
+  void push(char byte)
+  {
+    buffer.push((uint8_t)byte);
+  }
+  void append(const char *bytes, std::size_t count)
+  {
+    buffer.append(bytes, count);
+  }
+  ByteBuffer &buffer;
+};
+
+/**
+ * Streaming JSON writer. Output matches NSJSONSerialization with no options:
+ * compact, '/' escaped as "\/", other control characters as \u00xx, and
+ * non-ASCII UTF-8 passed through untouched.
+ *
+ * Sink must provide push(char) and append(const char *, size_t).
+ */
+template <typename Sink>
+class JSONWriter {
+ public:
+  explicit JSONWriter(Sink &sink) : _sink(sink) {}
+
+  void beginObject()
+  {
+    separate();
+    _sink.push('{');
+    _first.push_back(true);
+  }
+
+  void endObject()
+  {
+    _first.pop_back();
+    _sink.push('}');
+  }
+
+  void beginArray()
+  {
+    separate();
+    _sink.push('[');
+    _first.push_back(true);
+  }
+
+  void endArray()
+  {
+    _first.pop_back();
+    _sink.push(']');
+  }
+
+  void key(const char *bytes, std::size_t count)
+  {
+    separate();
+    writeString(bytes, count);
+    _sink.push(':');
+    _afterKey = true;
+  }
+
+  void key(const char *string)
+  {
+    key(string, std::strlen(string));
+  }
+
+  void string(const char *bytes, std::size_t count)
+  {
+    separate();
+    writeString(bytes, count);
+  }
+
+  void string(const char *string)
+  {
+    this->string(string, std::strlen(string));
+  }
+
+  // Writes a string whose UTF-8 bytes are produced in chunks by `producer`,
+  // which is called with a callback taking (bytes, count).
+  template <typename Producer>
+  void stringChunks(Producer &&producer)
+  {
+    separate();
+    _sink.push('"');
+    producer([this](const char *bytes, std::size_t count) {
+      writeEscaped(bytes, count);
+    });
+    _sink.push('"');
+  }
+
+  // Writes a key whose UTF-8 bytes are produced in chunks, as stringChunks.
+  template <typename Producer>
+  void keyChunks(Producer &&producer)
+  {
+    stringChunks(std::forward<Producer>(producer));
+    _sink.push(':');
+    _afterKey = true;
+  }
+
+  // Numbers and other pre-formatted literals.
+  void raw(const char *bytes, std::size_t count)
+  {
+    separate();
+    _sink.append(bytes, count);
+  }
+
+  void boolean(bool value)
+  {
+    value ? raw("true", 4) : raw("false", 5);
+  }
+
+  void null()
+  {
+    raw("null", 4);
+  }
+
+ private:
+  void separate()
+  {
+    if (_afterKey) {
+      _afterKey = false;
+      return;
+    }
+    if (!_first.empty()) {
+      if (!_first.back()) {
+        _sink.push(',');
+      }
+      _first.back() = false;
+    }
+  }
+
+  void writeString(const char *bytes, std::size_t count)
+  {
+    _sink.push('"');
+    writeEscaped(bytes, count);
+    _sink.push('"');
+  }
+
+  void writeEscaped(const char *bytes, std::size_t count)
+  {
+    static const char kHex[] = "0123456789abcdef";
+    std::size_t runStart = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      uint8_t c = (uint8_t)bytes[i];
+      if (c >= 0x20 && c != '"' && c != '\\' && c != '/') {
+        continue;
+      }
+      _sink.append(bytes + runStart, i - runStart);
+      runStart = i + 1;
+      char escape[6] = {'\\', 0, 0, 0, 0, 0};
+      std::size_t escapeLength = 2;
+      switch (c) {
+        case '"': escape[1] = '"'; break;
+        case '\\': escape[1] = '\\'; break;
+        case '/': escape[1] = '/'; break;
+        case '\b': escape[1] = 'b'; break;
+        case '\f': escape[1] = 'f'; break;
+        case '\n': escape[1] = 'n'; break;
+        case '\r': escape[1] = 'r'; break;
+        case '\t': escape[1] = 't'; break;
+        default:
+          escape[1] = 'u';
+          escape[2] = '0';
+          escape[3] = '0';
+          escape[4] = kHex[c >> 4];
+          escape[5] = kHex[c & 0xF];
+          escapeLength = 6;
+          break;
+      }
+      _sink.append(escape, escapeLength);
+    }
+    _sink.append(bytes + runStart, count - runStart);
+  }
+
+  Sink &_sink;
+  std::vector<bool> _first;
+  bool _afterKey = false;
+};
+
+} // namespace mp
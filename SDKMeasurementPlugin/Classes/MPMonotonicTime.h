@@ -54,6 +54,14 @@ FB_WEAK FBMonotonicTimeSeconds FBMonotonicTimeGetCurrentSeconds(void);
  */
 FB_WEAK FBMonotonicTimeNanoseconds FBMonotonicTimeGetCurrentNanoseconds(void);
 
+/**
+ * return Unix time in Milliseconds, advanced by the monotonic clock.
+ * Anchored to the wall clock on first use and never goes backwards when the
+ * system clock is set back. Moves forward to the wall clock when that is
+ * more than a second ahead, which covers time the device spent asleep.
+ */
+FB_WEAK FBMonotonicTimeMilliseconds FBMonotonicTimeGetUnixMilliseconds(void);
+
 /**
  * return number of MachTimeUnits for given number of seconds
  * this is useful when you want to use the really fast mach_absolute_time() function
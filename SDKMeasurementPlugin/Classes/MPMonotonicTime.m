@@ -21,6 +21,8 @@
 #include <assert.h>
 #include <mach/mach.h>
 #include <mach/mach_time.h>
+#include <stdatomic.h>
+#include <sys/time.h>
 
 #include <dispatch/dispatch.h>
 
@@ -60,6 +62,27 @@ FBMonotonicTimeNanoseconds FBMonotonicTimeGetCurrentNanoseconds(void)
   return _get_time_nanoseconds();
 }
 
+FBMonotonicTimeMilliseconds FBMonotonicTimeGetUnixMilliseconds(void)
+{
+  // Wall clock minus monotonic clock; 0 until the first call
+  static _Atomic(int64_t) unixOffset = 0;
+  static const int64_t kResyncThreshold = 1000;
+  
+  const int64_t monotonic = (int64_t)(_get_time_nanoseconds() / 1000000);
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  const int64_t candidate = ((int64_t)now.tv_sec * 1000 + now.tv_usec / 1000) - monotonic;
+  
+  int64_t offset = atomic_load_explicit(&unixOffset, memory_order_relaxed);
+  while (offset == 0 || candidate - offset > kResyncThreshold) {
+    if (atomic_compare_exchange_weak_explicit(&unixOffset, &offset, candidate, memory_order_relaxed, memory_order_relaxed)) {
+      offset = candidate;
+      break;
+    }
+  }
+  return (FBMonotonicTimeMilliseconds)(monotonic + offset);
+}
+
 FBMachAbsoluteTimeUnits FBMonotonicTimeConvertSecondsToMachUnits(FBMonotonicTimeSeconds seconds)
 {
   static double ratio = 0;
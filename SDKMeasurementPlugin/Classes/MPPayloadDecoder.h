@@ -0,0 +1,54 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+#import "MPDefines+Internal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Reads the JSON the SDK consumes without building mutable Foundation trees.
+ Values that are only passed along are validated in place and never decoded.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface MPPayloadDecoder : NSObject
+
+/**
+ Calls `block` for each {"id", "code"} entry of a dispatch response. Numeric
+ values are reported as strings. Returns NO, without calling `block`, if the
+ response is not a well-formed JSON array.
+ */
++ (BOOL)enumerateDispatchResultsInData:(nullable NSData *)data
+                            usingBlock:(void (NS_NOESCAPE ^)(NSString * __nullable eventId, NSString * __nullable code))block;
+
+/**
+ Returns YES if `bytes` hold exactly one well-formed JSON object.
+ */
++ (BOOL)isJSONObjectBytes:(const char *)bytes length:(NSUInteger)length;
+
+/**
+ Decodes a JSON object of string values into an immutable dictionary. Falls
+ back to +[MPUtility getObjectFromJSONData:] for any other shape, and returns
+ nil unless that yields a dictionary.
+ */
++ (nullable NSDictionary<NSString *, id> *)extraDataFromJSONData:(nullable NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
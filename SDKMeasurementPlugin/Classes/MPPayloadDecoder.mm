@@ -0,0 +1,101 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPPayloadDecoder.h"
+
+#import <string>
+#import <vector>
+
+#import "MPJSONReader.hpp"
+#import "MPUtility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSString * __nullable MPPayloadDecoderString(const char *bytes, size_t length)
+{
+  return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+}
+
+@implementation MPPayloadDecoder
+
+FB_FINAL_CLASS(objc_getClass("MPPayloadDecoder"));
+
++ (BOOL)enumerateDispatchResultsInData:(nullable NSData *)data
+                            usingBlock:(void (NS_NOESCAPE ^)(NSString * __nullable eventId, NSString * __nullable code))block
+{
+  if (data.length == 0) {
+    return NO;
+  }
+  std::vector<mp::DispatchResult> results;
+  if (!mp::parseDispatchResults((const char *)data.bytes, data.length, results)) {
+    return NO;
+  }
+  for (const mp::DispatchResult &result : results) {
+    NSString *eventId = result.hasEventId ? MPPayloadDecoderString(result.eventId.data(), result.eventId.size()) : nil;
+    NSString *code = result.hasCode ? MPPayloadDecoderString(result.code.data(), result.code.size()) : nil;
+    block(eventId, code);
+  }
+  return YES;
+}
+
++ (BOOL)isJSONObjectBytes:(const char *)bytes length:(NSUInteger)length
+{
+  mp::JSONReader reader(bytes, length);
+  return reader.peek() == mp::JSONReader::Type::Object && reader.skipValue() && reader.atEnd();
+}
+
++ (nullable NSDictionary<NSString *, id> *)extraDataFromJSONData:(nullable NSData *)data
+{
+  if (data.length == 0) {
+    return nil;
+  }
+  mp::JSONReader reader((const char *)data.bytes, data.length);
+  std::string keyScratch;
+  std::string valueScratch;
+  if (!reader.beginObject()) {
+    return nil;
+  }
+  NSMutableDictionary<NSString *, id> *dictionary = [NSMutableDictionary new];
+  const char *key;
+  size_t keyLength;
+  while (reader.nextKey(key, keyLength, keyScratch)) {
+    NSString *keyString = MPPayloadDecoderString(key, keyLength);
+    const char *value;
+    size_t valueLength;
+    if (reader.peek() != mp::JSONReader::Type::String) {
+      // Extra data is string to string; anything else is rare enough to leave
+      // to NSJSONSerialization, as long as it still decodes to a dictionary.
+      id object = [MPUtility getObjectFromJSONData:data];
+      return [object isKindOfClass:[NSDictionary class]] ? [(NSDictionary *)object copy] : nil;
+    }
+    const BOOL ok = reader.readString(value, valueLength, valueScratch);
+    NSString *valueString = ok ? MPPayloadDecoderString(value, valueLength) : nil;
+    if (!keyString || !valueString) {
+      return nil;
+    }
+    dictionary[keyString] = valueString;
+  }
+  if (reader.failed() || !reader.atEnd()) {
+    return nil;
+  }
+  return [dictionary copy];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
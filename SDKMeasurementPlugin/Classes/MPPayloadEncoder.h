@@ -0,0 +1,70 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+#import "MPDefines+Internal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Writes request parameters as an application/x-www-form-urlencoded body in a
+ single pass. Nested dictionaries are serialized to JSON and form-encoded on
+ the fly into the same buffer, so no intermediate NSStrings are created.
+ 
+ The bytes are the same as the string-based encoder this replaced produced,
+ including "(null)" for values it could not convert. MPPayloadJSONFragment
+ values are written verbatim.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface MPPayloadEncoder : NSObject
+
++ (NSData *)formEncodedDataFromParameters:(NSDictionary *)parameters;
+
+@end
+
+#ifdef __cplusplus
+namespace mp {
+class ByteBuffer;
+}
+
+/**
+ Replaces the contents of `buffer` with the compact JSON for `dictionary`,
+ byte-identical to NSJSONSerialization with no options. Only flat string to
+ string dictionaries are handled; returns NO, leaving `buffer` empty, for
+ anything else.
+ */
+BOOL MPPayloadWriteStringDictionaryJSON(NSDictionary *dictionary, mp::ByteBuffer &buffer);
+#endif
+
+/**
+ Already-serialized JSON that MPPayloadEncoder writes into a payload verbatim,
+ e.g. event extra data read back from the database.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface MPPayloadJSONFragment : NSObject
+
+@property (nonatomic, copy, readonly) NSData *data;
+
+FB_INIT_AND_NEW_UNAVAILABLE_NULLABILITY
+
+- (instancetype)initWithData:(NSData *)data NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,270 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPPayloadEncoder.h"
+
+#import <cmath>
+#import <cstring>
+
+#import "MPByteBuffer.hpp"
+#import "MPFormEncodingSink.hpp"
+#import "MPJSONWriter.hpp"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static const size_t kMPPayloadEncoderInitialCapacity = 4096;
+
+typedef mp::JSONWriter<mp::FormEncodingSink> MPPayloadJSONWriter;
+
+// Hands the UTF-8 bytes of `string` to `emit` without allocating: ASCII
+// strings expose their storage directly, anything else is transcoded through
+// a stack buffer.
+template <typename Emit>
+static void MPPayloadEnumerateUTF8(NSString *string, Emit &&emit)
+{
+  CFStringRef cfString = (__bridge CFStringRef)string;
+  const char *bytes = CFStringGetCStringPtr(cfString, kCFStringEncodingASCII);
+  if (bytes) {
+    emit(bytes, (size_t)CFStringGetLength(cfString));
+    return;
+  }
+  char chunk[512];
+  NSRange remaining = NSMakeRange(0, string.length);
+  while (remaining.length > 0) {
+    NSUInteger used = 0;
+    if (![string getBytes:chunk
+                maxLength:sizeof(chunk)
+               usedLength:&used
+                 encoding:NSUTF8StringEncoding
+                  options:NSStringEncodingConversionAllowLossy
+                    range:remaining
+           remainingRange:&remaining] || used == 0) {
+      break;
+    }
+    emit(chunk, (size_t)used);
+  }
+}
+
+// Integers print the same through -stringValue and NSJSONSerialization.
+// Floating point does not, and NSJSONSerialization's own formatting has
+// changed between OS releases, so those go through it, wrapped in an array
+// because top-level fragments need iOS 13.
+static void MPPayloadWriteJSONNumber(MPPayloadJSONWriter &writer, NSNumber *number)
+{
+  const char type = number.objCType[0];
+  if (type != 'f' && type != 'd') {
+    const char *integer = [[number stringValue] UTF8String];
+    writer.raw(integer, strlen(integer));
+    return;
+  }
+  NSData *data = [NSJSONSerialization dataWithJSONObject:@[number] options:(NSJSONWritingOptions)kNilOptions error:nil];
+  if (data.length < 2) {
+    writer.null();
+    return;
+  }
+  writer.raw((const char *)data.bytes + 1, data.length - 2);
+}
+
+// What NSJSONSerialization accepts, plus already-serialized fragments. It
+// rejects the whole object when any part fails, and the old encoder then
+// sent an empty value.
+static BOOL MPPayloadIsJSONEncodable(id value)
+{
+  if ([value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSNull class]] || [value isKindOfClass:[MPPayloadJSONFragment class]]) {
+    return YES;
+  } else if ([value isKindOfClass:[NSNumber class]]) {
+    double doubleValue = [value doubleValue];
+    return !std::isnan(doubleValue) && !std::isinf(doubleValue);
+  } else if ([value isKindOfClass:[NSArray class]]) {
+    for (id element in (NSArray *)value) {
+      if (!MPPayloadIsJSONEncodable(element)) {
+        return NO;
+      }
+    }
+    return YES;
+  } else if ([value isKindOfClass:[NSDictionary class]]) {
+    __block BOOL encodable = YES;
+    [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+      if (![key isKindOfClass:[NSString class]] || !MPPayloadIsJSONEncodable(obj)) {
+        encodable = NO;
+        *stop = YES;
+      }
+    }];
+    return encodable;
+  }
+  return NO;
+}
+
+static void MPPayloadWriteJSONValue(MPPayloadJSONWriter &writer, id __nullable value)
+{
+  if ([value isKindOfClass:[NSString class]]) {
+    writer.stringChunks([value](auto &&write) {
+      MPPayloadEnumerateUTF8(value, write);
+    });
+  } else if ([value isKindOfClass:[NSNumber class]]) {
+    if (CFGetTypeID((__bridge CFTypeRef)value) == CFBooleanGetTypeID()) {
+      writer.boolean([value boolValue]);
+    } else {
+      MPPayloadWriteJSONNumber(writer, value);
+    }
+  } else if ([value isKindOfClass:[MPPayloadJSONFragment class]]) {
+    NSData *data = ((MPPayloadJSONFragment *)value).data;
+    writer.raw((const char *)data.bytes, data.length);
+  } else if ([value isKindOfClass:[NSDictionary class]]) {
+    writer.beginObject();
+    MPPayloadJSONWriter *writerPtr = &writer;
+    [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+      NSString *keyString = [key description];
+      writerPtr->keyChunks([keyString](auto &&write) {
+        MPPayloadEnumerateUTF8(keyString, write);
+      });
+      MPPayloadWriteJSONValue(*writerPtr, obj);
+    }];
+    writer.endObject();
+  } else if ([value isKindOfClass:[NSArray class]]) {
+    writer.beginArray();
+    for (id element in (NSArray *)value) {
+      MPPayloadWriteJSONValue(writer, element);
+    }
+    writer.endArray();
+  } else {
+    writer.null();
+  }
+}
+
+// -[NSString fb_URLEncodedString] works on the UTF8String, so it stops at
+// the first NUL character.
+static void MPPayloadWriteFormString(mp::FormEncodingSink &sink, NSString *string)
+{
+  bool terminated = false;
+  MPPayloadEnumerateUTF8(string, [&sink, &terminated](const char *bytes, size_t count) {
+    if (terminated) {
+      return;
+    }
+    const char *nul = (const char *)memchr(bytes, 0, count);
+    if (nul) {
+      count = (size_t)(nul - bytes);
+      terminated = true;
+    }
+    sink.append(bytes, count);
+  });
+}
+
+// Mirrors +[MPUtility attemptRecoveryOfObject:ofClass:] for NSString followed
+// by fb_URLEncodedString, formatted with %@, so unsupported values such as
+// NSNull come out as "(null)".
+static void MPPayloadWriteFormValue(mp::FormEncodingSink &sink, id value)
+{
+  if ([value isKindOfClass:[NSString class]]) {
+    MPPayloadWriteFormString(sink, value);
+  } else if ([value isKindOfClass:[NSNumber class]]) {
+    MPPayloadWriteFormString(sink, [value stringValue]);
+  } else if ([value isKindOfClass:[NSDictionary class]]) {
+    if (MPPayloadIsJSONEncodable(value)) {
+      MPPayloadJSONWriter writer(sink);
+      MPPayloadWriteJSONValue(writer, value);
+    }
+  } else {
+    sink.appendVerbatim("(null)", 6);
+  }
+}
+
+static void MPPayloadWriteFormPair(mp::FormEncodingSink &sink, NSString *key, id value)
+{
+  if (sink.buffer.size() > 0) {
+    sink.appendVerbatim("&", 1);
+  }
+  MPPayloadWriteFormString(sink, key);
+  sink.appendVerbatim("=", 1);
+  MPPayloadWriteFormValue(sink, value);
+}
+
+BOOL MPPayloadWriteStringDictionaryJSON(NSDictionary *dictionary, mp::ByteBuffer &buffer)
+{
+  buffer.clear();
+  mp::ByteBufferSink sink(buffer);
+  mp::JSONWriter<mp::ByteBufferSink> writer(sink);
+  mp::JSONWriter<mp::ByteBufferSink> *writerPtr = &writer;
+  __block BOOL flat = YES;
+  writer.beginObject();
+  [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+    if (![key isKindOfClass:[NSString class]] || ![obj isKindOfClass:[NSString class]]) {
+      flat = NO;
+      *stop = YES;
+      return;
+    }
+    writerPtr->keyChunks([key](auto &&write) {
+      MPPayloadEnumerateUTF8(key, write);
+    });
+    writerPtr->stringChunks([obj](auto &&write) {
+      MPPayloadEnumerateUTF8(obj, write);
+    });
+  }];
+  if (!flat) {
+    buffer.clear();
+    return NO;
+  }
+  writer.endObject();
+  return YES;
+}
+
+@implementation MPPayloadEncoder
+
+FB_FINAL_CLASS(objc_getClass("MPPayloadEncoder"));
+
++ (NSData *)formEncodedDataFromParameters:(NSDictionary *)parameters
+{
+  mp::ByteBuffer buffer(kMPPayloadEncoderInitialCapacity);
+  mp::FormEncodingSink sink(buffer);
+  mp::FormEncodingSink *sinkPtr = &sink;
+  [parameters enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+    NSString *keyString = [key description];
+    if ([obj isKindOfClass:[NSArray class]]) {
+      NSString *arrayKey = [keyString stringByAppendingString:@"[]"];
+      for (id element in (NSArray *)obj) {
+        MPPayloadWriteFormPair(*sinkPtr, arrayKey, element);
+      }
+    } else {
+      MPPayloadWriteFormPair(*sinkPtr, keyString, obj);
+    }
+  }];
+  size_t length = buffer.size();
+  if (length == 0) {
+    return [NSData data];
+  }
+  return [[NSData alloc] initWithBytesNoCopy:buffer.release() length:length freeWhenDone:YES];
+}
+
+@end
+
+@implementation MPPayloadJSONFragment
+
+FB_FINAL_CLASS(objc_getClass("MPPayloadJSONFragment"));
+
+- (instancetype)initWithData:(NSData *)data
+{
+  self = [super init];
+  if (self) {
+    _data = [data copy];
+  }
+  return self;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
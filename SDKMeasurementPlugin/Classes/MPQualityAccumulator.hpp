@@ -0,0 +1,154 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "MPUnitHistogram.hpp"
+
+namespace mp {
+
+/**
+ * The state and update rules behind MPQualityMetric as a plain value.
+ * mp::QualityRuleEngine keeps two per rule inline and resets them in place.
+ */
+struct QualityAccumulator {
+  explicit QualityAccumulator(float eligibleThreshold = 0) : eligibleThreshold(eligibleThreshold) {}
+
+  void registerProgress(double progress, float value)
+  {
+    registerProgress(progress, value, value >= eligibleThreshold);
+  }
+
+  // For callers whose eligibility depends on more than this value.
+  void registerProgress(double progress, float value, bool eligible)
+  {
+    if (measurementCount == 0) {
+      min = value;
+      max = value;
+    } else {
+      min = std::fmin(min, value);
+      max = std::fmax(max, value);
+    }
+
+    // Still in the run the window started with, for merge()
+    const bool leading = leadingEligibleSeconds >= measurementSeconds;
+    measurementCount++;
+    measurementSeconds += progress;
+
+    current = value;
+    sum += value * progress;
+    histogram.add(value, progress);
+    avg = (float)(sum / measurementSeconds);
+
+    if (eligible) {
+      if (leading) {
+        leadingEligibleSeconds += progress;
+      }
+      eligibleSeconds += progress;
+      continuousEligibleSeconds += progress;
+      maxContinuousEligibleSeconds = std::fmax(maxContinuousEligibleSeconds, continuousEligibleSeconds);
+    } else {
+      continuousEligibleSeconds = 0;
+    }
+  }
+
+  // `other` covers the window that follows this one.
+  void merge(const QualityAccumulator &other)
+  {
+    if (other.measurementCount == 0) {
+      return;
+    }
+    if (measurementCount == 0) {
+      min = other.min;
+      max = other.max;
+    } else {
+      min = std::fmin(min, other.min);
+      max = std::fmax(max, other.max);
+    }
+
+    // Our last run and the later window's first one meet at the boundary; a
+    // run that fills a whole window carries on past it. Sums of the same
+    // ticks in the same order, so a full run compares equal.
+    const double joinedRun = continuousEligibleSeconds + other.leadingEligibleSeconds;
+    maxContinuousEligibleSeconds = std::max({maxContinuousEligibleSeconds, other.maxContinuousEligibleSeconds, joinedRun});
+    continuousEligibleSeconds = other.leadingEligibleSeconds >= other.measurementSeconds ? joinedRun : other.continuousEligibleSeconds;
+    if (leadingEligibleSeconds >= measurementSeconds) {
+      leadingEligibleSeconds += other.leadingEligibleSeconds;
+    }
+
+    measurementCount += other.measurementCount;
+    measurementSeconds += other.measurementSeconds;
+    eligibleSeconds += other.eligibleSeconds;
+    current = other.current;
+    sum += other.sum;
+    avg = measurementSeconds > 0 ? (float)(sum / measurementSeconds) : 0.0f;
+    histogram.merge(other.histogram);
+  }
+
+  // Clamped to [min, max]; 0 when nothing was registered.
+  float percentile(float percentile) const
+  {
+    if (histogram.total() <= 0) {
+      return 0;
+    }
+    return std::fmin(std::fmax((float)histogram.quantile(percentile), min), max);
+  }
+
+  // As -[MPQualityMetric reset] always has, leaves the continuous-run
+  // counters alone.
+  void resetTotals()
+  {
+    avg = 0;
+    current = 0;
+    eligibleSeconds = 0;
+    leadingEligibleSeconds = 0;
+    max = 0;
+    measurementCount = 0;
+    measurementSeconds = 0;
+    min = 0;
+    sum = 0;
+    histogram.reset();
+  }
+
+  // Back to a freshly constructed state, keeping the threshold.
+  void reset()
+  {
+    *this = QualityAccumulator(eligibleThreshold);
+  }
+
+  float eligibleThreshold;
+  float avg = 0;
+  float current = 0;
+  float min = 0;
+  float max = 0;
+  float sum = 0;
+  int64_t measurementCount = 0;
+  double measurementSeconds = 0;
+  double eligibleSeconds = 0;
+  // Eligible seconds from the start up to the first ineligible tick
+  double leadingEligibleSeconds = 0;
+  double continuousEligibleSeconds = 0;
+  double maxContinuousEligibleSeconds = 0;
+  UnitHistogram histogram;
+};
+
+} // namespace mp
@@ -22,9 +22,20 @@
 #import "MPQualityRule.h"
 #import "MPQualityStatistics.h"
 
+typedef void (^MPQualityManagerStatisticsBlock)(MPQualityStatistics *_Nonnull statistics, CGRect targetFrame, CGSize viewportSize);
+
+/**
+ Everything but capturing the view geometry (area computation, statistics,
+ rules and their callbacks) runs on a serial processing queue, in the order
+ the calls came in. Call the manager from the main thread.
+ */
 @interface MPQualityManager : NSObject
 
+// Only touch on the processing queue, see -performWithStatistics:
 @property (nonatomic, strong, readonly, nonnull) MPQualityStatistics *statistics;
+// Processing queue only: the time passed with the tick being processed, so
+// rule callbacks see the tick that ended the rule rather than a later one
+@property (nonatomic, assign, readonly) NSTimeInterval tickTime;
 @property (nonatomic, strong, nonnull) UIView *targetView;
 
 + (nullable instancetype)managerWithTargetView:(nonnull UIView *)targetView
@@ -35,8 +46,55 @@
 
 - (void)resetStatistics;
 
+/**
+ Runs the block on the processing queue after everything registered so far,
+ with the statistics and the target frame and window size as of the last
+ call. Called from a rule callback, which is already on that queue, it runs
+ right away.
+ */
+- (void)performWithStatistics:(nonnull MPQualityManagerStatisticsBlock)block;
+
+/**
+ Does all the work on the calling thread instead, as before the processing
+ queue; for comparing -averageMainThreadTickDuration. Call before the first
+ tick.
+ */
+- (void)disableBackgroundProcessing;
+
+// Average time -registerProgress:volume:time: kept the main thread busy per tick.
+@property (nonatomic, assign, readonly) NSTimeInterval averageMainThreadTickDuration;
+
+- (void)registerDuration:(NSTimeInterval)duration;
+
+/**
+ From now on, only measures viewability on every progress tick while the
+ target view, the windows, the app state or the volume are changing, or the
+ ratio is near a rule threshold, and reuses the last ratio otherwise (see
+ MPAdaptiveSampler.hpp). Eligible seconds stay within maxErrorFraction of the
+ seconds played of what measuring every tick would give.
+ */
+- (void)enableAdaptiveSamplingWithMaxErrorFraction:(double)maxErrorFraction;
+
+/**
+ Records everything fed to the manager from now on, plus the actions passed
+ to -recordTraceAction:, as a binary trace (see MPQualityTrace.hpp) for
+ offline replay. Restarting discards the trace in progress.
+ */
+- (void)startTraceRecording;
+
+// The trace so far, or nil when not recording. Recording stops. Waits for
+// the processing queue.
+- (nullable NSData *)stopTraceRecording;
+
+// Notes a video action logged from the current statistics.
+- (void)recordTraceAction:(NSInteger)action;
+
+// See -[MPQualityViewabilityMeasurement viewHierarchySnapshot]
+- (nullable NSData *)viewHierarchySnapshot;
+
 - (void)registerProgress:(NSTimeInterval)progress
-                  volume:(float)volume;
+                  volume:(float)volume
+                    time:(NSTimeInterval)time;
 
 @end
 
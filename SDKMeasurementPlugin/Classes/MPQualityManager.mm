@@ -0,0 +1,356 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPQualityManager.h"
+
+#import <cmath>
+#import <memory>
+#import <mutex>
+#import <string>
+#import <vector>
+
+#import "MPAdaptiveSampler.hpp"
+#import "MPBackgroundStateManaging.h"
+#import "MPMonotonicTime.h"
+#import "MPQualityRuleEngine.hpp"
+#import "MPQualityTest.h"
+#import "MPQualityTrace.hpp"
+#import "MPQualityViewabilityMeasurement.h"
+#import "MPQualityViewabilityMeasurement+Snapshot.h"
+#import "MPViewabilityGeometry.h"
+#import "MPWindowRegistry.h"
+
+static void *const kMPQualityProcessingQueueKey = (void *)&kMPQualityProcessingQueueKey;
+
+@interface MPQualityManager ()
+{
+  // nil once background processing is disabled
+  dispatch_queue_t _processingQueue;
+  
+  // Processing queue only: the trace while recording, and where the target
+  // was and the time passed at the last tick
+  std::unique_ptr<mp::QualityTraceWriter> _traceWriter;
+  CGRect _targetFrame;
+  CGSize _viewportSize;
+  NSTimeInterval _tickTime;
+  
+  // Only with adaptive sampling; asked on the main thread, fed on the
+  // processing queue
+  std::unique_ptr<mp::AdaptiveSampler> _sampler;
+  std::mutex _samplerMutex;
+  
+  // Main thread only
+  BOOL _recording;
+  FBMonotonicTimeNanoseconds _mainThreadTickNanoseconds;
+  NSUInteger _mainThreadTicks;
+
+  // What the last tick saw, for -detectActivityWithVolume:
+  CGRect _lastTargetRect;
+  __weak UIWindow *_lastTargetWindow;
+  BOOL _lastTargetHidden;
+  CGFloat _lastTargetAlpha;
+  UIApplicationState _lastApplicationState;
+  NSUInteger _lastWindowGeneration;
+  float _lastVolume;
+}
+
+@property (nonatomic, copy) NSArray<MPQualityRule *> *rules;
+
+@property (nonatomic, strong) MPQualityTest *test;
+@property (nonatomic, strong) MPQualityViewabilityMeasurement *viewabilityMeasurement;
+
+@end
+
+@implementation MPQualityManager
+
++ (nullable instancetype)managerWithTargetView:(nonnull UIView *)targetView
+                                         rules:(nullable NSArray<MPQualityRule *> *)rules
+{
+  return [[self alloc] initWithTargetView:targetView rules:rules];
+}
+
+- (nullable instancetype)initWithTargetView:(nonnull UIView *)targetView
+                                      rules:(nullable NSArray<MPQualityRule *> *)rules
+{
+  self = [super init];
+  if (self) {
+    _statistics = [MPQualityStatistics new];
+    _targetView = targetView;
+    self.rules = rules ?: @[];
+    self.test = [MPQualityTest testWithRules:self.rules];
+    self.viewabilityMeasurement = [MPQualityViewabilityMeasurement measurementWithTargetView:targetView];
+    _processingQueue = dispatch_queue_create("com.facebook.ads.qualityProcessingQueue", nullptr);
+    dispatch_queue_set_specific(_processingQueue, kMPQualityProcessingQueueKey, (__bridge void *)self, nullptr);
+  }
+  return self;
+}
+
+- (void)setTargetView:(UIView *)targetView
+{
+  _targetView = targetView;
+  self.viewabilityMeasurement.targetView = targetView;
+}
+
+- (nullable instancetype)init
+{
+  return [self initWithTargetView:[UIView new]
+                            rules:nil];
+}
+
+- (BOOL)isOnProcessingQueue
+{
+  return _processingQueue && dispatch_get_specific(kMPQualityProcessingQueueKey) == (__bridge void *)self;
+}
+
+- (void)performOnProcessingQueue:(dispatch_block_t)block
+{
+  if (!_processingQueue || [self isOnProcessingQueue]) {
+    block();
+  } else {
+    dispatch_async(_processingQueue, block);
+  }
+}
+
+- (void)performOnProcessingQueueAndWait:(dispatch_block_t)block
+{
+  if (!_processingQueue || [self isOnProcessingQueue]) {
+    block();
+  } else {
+    dispatch_sync(_processingQueue, block);
+  }
+}
+
+- (void)disableBackgroundProcessing
+{
+  _processingQueue = nil;
+}
+
+- (NSTimeInterval)averageMainThreadTickDuration
+{
+  if (_mainThreadTicks == 0) {
+    return 0.0;
+  }
+  return (NSTimeInterval)_mainThreadTickNanoseconds / NSEC_PER_SEC / _mainThreadTicks;
+}
+
+- (void)performWithStatistics:(MPQualityManagerStatisticsBlock)block
+{
+  if ([self isOnProcessingQueue]) {
+    block(self.statistics, _targetFrame, _viewportSize);
+    return;
+  }
+  // Called on the main thread, where the target can be looked at directly
+  UIView *targetView = self.targetView;
+  const CGRect targetFrame = targetView.frame;
+  const CGSize viewportSize = targetView.window.frame.size;
+  [self performOnProcessingQueue:^{
+    block(self.statistics, targetFrame, viewportSize);
+  }];
+}
+
+- (void)resetStatistics
+{
+  [self performOnProcessingQueue:^{
+    if (self->_traceWriter) {
+      self->_traceWriter->reset();
+    }
+    [self.statistics reset];
+  }];
+}
+
+- (void)registerDuration:(NSTimeInterval)duration
+{
+  [self performOnProcessingQueue:^{
+    if (self->_traceWriter) {
+      self->_traceWriter->duration(duration);
+    }
+    [self.test registerDuration:duration];
+  }];
+}
+
+- (void)enableAdaptiveSamplingWithMaxErrorFraction:(double)maxErrorFraction
+{
+  std::vector<float> thresholds = {self.statistics.viewabilityStatistics.eligibleThreshold};
+  for (MPQualityRule *rule in self.rules) {
+    thresholds.push_back(rule.viewableRatio);
+  }
+  mp::AdaptiveSamplerConfig config;
+  config.maxErrorFraction = maxErrorFraction;
+  std::lock_guard<std::mutex> lock(_samplerMutex);
+  _sampler.reset(new mp::AdaptiveSampler(config, thresholds));
+}
+
+- (void)startTraceRecording
+{
+  std::string ruleSpecs;
+  NSUInteger index = 0;
+  for (MPQualityRule *rule in self.rules) {
+    mp::QualityRuleSpec spec;
+    spec.viewableRatio = rule.viewableRatio;
+    spec.viewableSeconds = rule.viewableSeconds;
+    spec.durationFraction = rule.viewableDurationFraction;
+    spec.continuous = rule.isContinuous;
+    spec.audibleVolume = rule.audibleVolume;
+    NSString *name = rule.name ?: [NSString stringWithFormat:@"rule%lu", (unsigned long)index];
+    if (index++) {
+      ruleSpecs += ';';
+    }
+    ruleSpecs += mp::formatQualityRuleSpec(name.UTF8String ?: "", spec);
+  }
+  _recording = YES;
+  [self performOnProcessingQueue:^{
+    self->_traceWriter.reset(new mp::QualityTraceWriter(ruleSpecs));
+  }];
+}
+
+- (nullable NSData *)stopTraceRecording
+{
+  if (!_recording) {
+    return nil;
+  }
+  _recording = NO;
+  __block NSData *trace = nil;
+  [self performOnProcessingQueueAndWait:^{
+    if (!self->_traceWriter) {
+      return;
+    }
+    mp::ByteBuffer &buffer = self->_traceWriter->buffer();
+    const NSUInteger length = buffer.size();
+    trace = [[NSData alloc] initWithBytesNoCopy:buffer.release() length:length freeWhenDone:YES];
+    self->_traceWriter.reset();
+  }];
+  return trace;
+}
+
+- (void)recordTraceAction:(NSInteger)action
+{
+  [self performOnProcessingQueue:^{
+    if (self->_traceWriter) {
+      self->_traceWriter->action((int32_t)action);
+    }
+  }];
+}
+
+- (nullable NSData *)viewHierarchySnapshot
+{
+  return [self.viewabilityMeasurement viewHierarchySnapshot];
+}
+
+- (NSTimeInterval)tickTime
+{
+  return _tickTime;
+}
+
+- (void)registerProgress:(NSTimeInterval)progress
+                  volume:(float)volume
+                    time:(NSTimeInterval)time
+{
+  const FBMonotonicTimeNanoseconds start = FBMonotonicTimeGetCurrentNanoseconds();
+  
+  UIView *targetView = self.targetView;
+  const CGRect targetFrame = targetView.frame;
+  const CGSize viewportSize = targetView.window.frame.size;
+  const BOOL active = (_sampler || _recording) && [self detectActivityWithVolume:volume];
+  BOOL measure = YES;
+  if (_sampler) {
+    std::lock_guard<std::mutex> lock(_samplerMutex);
+    measure = _sampler->shouldMeasure(progress, active);
+  }
+  // The only part that has to look at views; nil to reuse the last ratio
+  MPViewabilityGeometry *geometry = measure ? [self.viewabilityMeasurement captureGeometry] : nil;
+  
+  [self performOnProcessingQueue:^{
+    self->_targetFrame = targetFrame;
+    self->_viewportSize = viewportSize;
+    self->_tickTime = time;
+    [self processProgress:progress volume:volume geometry:geometry active:active];
+  }];
+  
+  _mainThreadTickNanoseconds += FBMonotonicTimeGetCurrentNanoseconds() - start;
+  _mainThreadTicks++;
+}
+
+- (void)processProgress:(NSTimeInterval)progress
+                 volume:(float)volume
+               geometry:(nullable MPViewabilityGeometry *)geometry
+                 active:(BOOL)active
+{
+  if (volume >= 0.0) {
+    [self.statistics registerAudibilityProgress:progress volume:volume];
+  }
+  
+  float viewableRatio;
+  if (geometry) {
+    viewableRatio = [geometry viewableRatio];
+    if (_sampler) {
+      std::lock_guard<std::mutex> lock(_samplerMutex);
+      _sampler->measured(viewableRatio);
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(_samplerMutex);
+    viewableRatio = _sampler->heldRatio();
+  }
+  
+  // Before the rules run, so actions their callbacks log come after the tick
+  if (_traceWriter) {
+    if (active) {
+      _traceWriter->activity();
+    }
+    _traceWriter->tick(progress, viewableRatio, volume);
+  }
+  
+  // register statistics
+  [self.statistics registerViewabilityProgress:progress viewableRatio:viewableRatio];
+  
+  // register tests
+  [self.test registerProgress:progress viewableRatio:viewableRatio volume:volume];
+}
+
+/**
+ Cheap stand-ins for what -viewableRatio depends on: where the target is in
+ its window, its own visibility and animations, the window list, the app
+ state, and the volume. Any change since the last tick is activity.
+ */
+- (BOOL)detectActivityWithVolume:(float)volume
+{
+  UIView *targetView = self.targetView;
+  UIWindow *window = targetView.window;
+  CGRect targetRect = window ? [targetView convertRect:targetView.bounds toView:nil] : CGRectNull;
+  UIApplicationState applicationState = [[MPBackgroundStateManagerFactory backgroundStateManager] applicationState];
+  NSUInteger windowGeneration = [MPWindowRegistry sharedRegistry].generation;
+  
+  BOOL active = !CGRectEqualToRect(targetRect, _lastTargetRect) ||
+    window != _lastTargetWindow ||
+    targetView.hidden != _lastTargetHidden ||
+    targetView.alpha != _lastTargetAlpha ||
+    targetView.layer.animationKeys.count > 0 ||
+    applicationState != _lastApplicationState ||
+    windowGeneration != _lastWindowGeneration ||
+    std::fabs(volume - _lastVolume) > 0.01f;
+  
+  _lastTargetRect = targetRect;
+  _lastTargetWindow = window;
+  _lastTargetHidden = targetView.hidden;
+  _lastTargetAlpha = targetView.alpha;
+  _lastApplicationState = applicationState;
+  _lastWindowGeneration = windowGeneration;
+  _lastVolume = volume;
+  return active;
+}
+
+@end
@@ -30,6 +30,9 @@
 @property (nonatomic, assign, readonly) NSInteger measurementCount;
 @property (nonatomic, assign, readonly) NSTimeInterval measurementSeconds;
 @property (nonatomic, assign, readonly) float min;
+// Time-weighted percentiles of the registered values
+@property (nonatomic, assign, readonly) float p50;
+@property (nonatomic, assign, readonly) float p90;
 
 + (nullable instancetype)metricWithEligibleThreshold:(float)eligibleThreshold;
 
@@ -38,6 +41,20 @@
 - (void)registerProgress:(NSTimeInterval)progress
                    value:(float)value;
 
+/**
+ Folds in a metric covering the window that follows the receiver's. Totals,
+ extremes, percentiles and the histogram come out as if both windows had been
+ registered on the receiver, and a continuous eligible run carries across the
+ boundary.
+ */
+- (void)mergeMetric:(nonnull MPQualityMetric *)metric;
+
+/**
+ The distribution as comma-separated milliseconds per histogram bucket, from
+ exactly 0 through exactly 1, with trailing empty buckets dropped.
+ */
+- (nonnull NSString *)histogramString;
+
 - (void)reset;
 
 @end
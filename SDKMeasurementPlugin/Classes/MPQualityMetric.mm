@@ -16,11 +16,12 @@
 // IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
-#import "MPQualityMetric.h"
+#import "MPQualityMetric+Internal.h"
 
 @interface MPQualityMetric ()
-
-@property (nonatomic, assign) float sum;
+{
+  mp::QualityAccumulator _state;
+}
 
 @end
 
@@ -35,8 +36,7 @@
 {
   self = [super init];
   if (self) {
-    _eligibleThreshold = eligibleThreshold;
-    [self reset];
+    _state = mp::QualityAccumulator(eligibleThreshold);
   }
   return self;
 }
@@ -46,44 +46,99 @@
   return [self initWithEligibleThreshold:0.0];
 }
 
+- (float)avg
+{
+  return _state.avg;
+}
+
+- (NSTimeInterval)continuousEligibleSeconds
+{
+  return _state.continuousEligibleSeconds;
+}
+
+- (float)current
+{
+  return _state.current;
+}
+
+- (NSTimeInterval)eligibleSeconds
+{
+  return _state.eligibleSeconds;
+}
+
+- (float)eligibleThreshold
+{
+  return _state.eligibleThreshold;
+}
+
+- (float)max
+{
+  return _state.max;
+}
+
+- (NSTimeInterval)maxContinuousEligibleSeconds
+{
+  return _state.maxContinuousEligibleSeconds;
+}
+
+- (NSInteger)measurementCount
+{
+  return (NSInteger)_state.measurementCount;
+}
+
+- (NSTimeInterval)measurementSeconds
+{
+  return _state.measurementSeconds;
+}
+
+- (float)min
+{
+  return _state.min;
+}
+
 - (void)registerProgress:(NSTimeInterval)progress
                    value:(float)value
 {
-  if (_measurementCount == 0) {
-    _min = value;
-    _max = value;
-  } else {
-    _min = fminf(_min, value);
-    _max = fmaxf(_max, value);
+  _state.registerProgress(progress, value);
+}
+
+- (float)p50
+{
+  return _state.percentile(0.5f);
+}
+
+- (float)p90
+{
+  return _state.percentile(0.9f);
+}
+
+- (void)mergeMetric:(MPQualityMetric *)metric
+{
+  _state.merge(metric->_state);
+}
+
+- (NSString *)histogramString
+{
+  const mp::UnitHistogram &histogram = _state.histogram;
+  std::size_t count = mp::UnitHistogram::kBucketCount;
+  while (count > 0 && (unsigned long)(histogram.weight(count - 1) * 1000) == 0) {
+    count--;
   }
-  
-  _measurementCount++;
-  _measurementSeconds += progress;
-  
-  _current = value;
-  _sum += value * progress;
-  _avg = (float)(_sum / _measurementSeconds);
-  
-  if (value >= _eligibleThreshold) {
-    _eligibleSeconds += progress;
-    _continuousEligibleSeconds += progress;
-    _maxContinuousEligibleSeconds = fmax(_maxContinuousEligibleSeconds, _continuousEligibleSeconds);
-  } else {
-    _continuousEligibleSeconds = 0.0;
+  NSMutableString *string = [NSMutableString stringWithCapacity:count * 4];
+  for (std::size_t i = 0; i < count; i++) {
+    [string appendFormat:i ? @",%lu" : @"%lu", (unsigned long)(histogram.weight(i) * 1000)];
   }
+  return string;
 }
 
 - (void)reset
 {
-  _avg = 0.0;
-  _current = 0.0;
-  _eligibleSeconds = 0.0;
-  _max = 0.0;
-  _measurementCount = 0;
-  _measurementSeconds = 0.0;
-  _min = 0.0;
-  _sum = 0.0;
+  _state.resetTotals();
 }
 
-@end
+- (void)setState:(const mp::QualityAccumulator &)state
+{
+  _state = state;
+}
 
+@end
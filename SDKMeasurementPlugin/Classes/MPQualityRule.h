@@ -23,11 +23,15 @@
 NS_ASSUME_NONNULL_BEGIN
 
 typedef void (^MPQualityRuleEndCallback)(BOOL completed, BOOL passed, MPQualityStatistics *statistics);
+typedef void (^MPQualityNamedRuleEndCallback)(NSString *name, BOOL completed, BOOL passed, MPQualityStatistics *statistics);
 
 @interface MPQualityRule : NSObject
 
+@property (nonatomic, assign, readonly) float audibleVolume; // 0 when the rule ignores volume
 @property (nonatomic, assign, readonly, getter=isContinuous) BOOL continuous;
 @property (nonatomic, copy, readonly, nullable) MPQualityRuleEndCallback endCallback;
+@property (nonatomic, copy, readonly, nullable) NSString *name;
+@property (nonatomic, assign, readonly) float viewableDurationFraction; // 0 when the rule ignores duration
 @property (nonatomic, assign, readonly) float viewableRatio;
 @property (nonatomic, assign, readonly) NSTimeInterval viewableSeconds;
 
@@ -40,10 +44,25 @@ typedef void (^MPQualityRuleEndCallback)(BOOL completed, BOOL passed, MPQualityS
                                     continuous:(BOOL)continuous
                                    endCallback:(nullable MPQualityRuleEndCallback)endCallback;
 
+/**
+ Rules from a specification string such as "mrc:0.5:2:c;groupm:1:50%:ca0.05"
+ (see mp::parseQualityRuleSpecs). Returns nil if the string is malformed.
+ */
++ (nullable NSArray<MPQualityRule *> *)rulesWithSpecification:(NSString *)specification
+                                                  endCallback:(nullable MPQualityNamedRuleEndCallback)endCallback;
+
 - (nullable instancetype)initWithViewableRatio:(float)viewableRatio
                                viewableSeconds:(NSTimeInterval)viewableSeconds
                                     continuous:(BOOL)continuous
-                                   endCallback:(nullable MPQualityRuleEndCallback)endCallback NS_DESIGNATED_INITIALIZER;
+                                   endCallback:(nullable MPQualityRuleEndCallback)endCallback;
+
+- (nullable instancetype)initWithName:(nullable NSString *)name
+                        viewableRatio:(float)viewableRatio
+                      viewableSeconds:(NSTimeInterval)viewableSeconds
+             viewableDurationFraction:(float)viewableDurationFraction
+                           continuous:(BOOL)continuous
+                        audibleVolume:(float)audibleVolume
+                          endCallback:(nullable MPQualityRuleEndCallback)endCallback NS_DESIGNATED_INITIALIZER;
 
 @end
 
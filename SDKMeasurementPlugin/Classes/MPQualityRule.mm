@@ -18,6 +18,13 @@
 
 #import "MPQualityRule.h"
 
+#import <string>
+#import <utility>
+#import <vector>
+
+#import "MPDefines+Internal.h"
+#import "MPQualityRuleEngine.hpp"
+
 NS_ASSUME_NONNULL_BEGIN
 
 @implementation MPQualityRule
@@ -49,15 +56,61 @@ NS_ASSUME_NONNULL_BEGIN
                                  endCallback:endCallback];
 }
 
++ (nullable NSArray<MPQualityRule *> *)rulesWithSpecification:(NSString *)specification
+                                                  endCallback:(nullable MPQualityNamedRuleEndCallback)endCallback
+{
+  std::vector<std::pair<std::string, mp::QualityRuleSpec>> specs;
+  if (!mp::parseQualityRuleSpecs(specification.UTF8String ?: "", specs)) {
+    return nil;
+  }
+  NSMutableArray<MPQualityRule *> *rules = [NSMutableArray arrayWithCapacity:specs.size()];
+  for (const auto &spec : specs) {
+    NSString *name = @(spec.first.c_str());
+    MPQualityRule *rule = [[self alloc] initWithName:name
+                                       viewableRatio:spec.second.viewableRatio
+                                     viewableSeconds:spec.second.viewableSeconds
+                            viewableDurationFraction:(float)spec.second.durationFraction
+                                          continuous:spec.second.continuous
+                                       audibleVolume:spec.second.audibleVolume
+                                         endCallback:^(BOOL completed, BOOL passed, MPQualityStatistics *statistics) {
+                                           FB_BLOCK_CALL_SAFE(endCallback, name, completed, passed, statistics);
+                                         }];
+    if (rule) {
+      [rules addObject:rule];
+    }
+  }
+  return rules;
+}
+
 - (nullable instancetype)initWithViewableRatio:(float)viewableRatio
                                viewableSeconds:(NSTimeInterval)viewableSeconds
                                     continuous:(BOOL)continuous
                                    endCallback:(nullable MPQualityRuleEndCallback)endCallback
+{
+  return [self initWithName:nil
+              viewableRatio:viewableRatio
+            viewableSeconds:viewableSeconds
+   viewableDurationFraction:0.0f
+                 continuous:continuous
+              audibleVolume:0.0f
+                endCallback:endCallback];
+}
+
+- (nullable instancetype)initWithName:(nullable NSString *)name
+                        viewableRatio:(float)viewableRatio
+                      viewableSeconds:(NSTimeInterval)viewableSeconds
+             viewableDurationFraction:(float)viewableDurationFraction
+                           continuous:(BOOL)continuous
+                        audibleVolume:(float)audibleVolume
+                          endCallback:(nullable MPQualityRuleEndCallback)endCallback
 {
   self = [super init];
   if (self) {
+    _audibleVolume = audibleVolume;
     _continuous = continuous;
     _endCallback = endCallback;
+    _name = [name copy];
+    _viewableDurationFraction = viewableDurationFraction;
     _viewableRatio = viewableRatio;
     _viewableSeconds = viewableSeconds;
   }
@@ -0,0 +1,269 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MPQualityAccumulator.hpp"
+
+namespace mp {
+
+/**
+ * One viewability standard: the view must be at least `viewableRatio` visible
+ * (and, when audibleVolume > 0, at least that loud) for `viewableSeconds`, or
+ * for `durationFraction` of the media duration if that is longer.
+ */
+struct QualityRuleSpec {
+  float viewableRatio = 0;
+  double viewableSeconds = 0;
+  double durationFraction = 0;
+  bool continuous = false;
+  float audibleVolume = 0;
+};
+
+/**
+ * Parses a rule list such as "mrc:0.5:2:c;groupm:1:50%:ca0.05": rules are
+ * separated by ';' and each is name:ratio:duration[:flags]. A duration ending
+ * in '%' is a fraction of the media duration. Flags: 'c' continuous, 'a' plus
+ * a number for the minimum volume. Returns false, leaving `rules` untouched,
+ * if any rule is malformed.
+ */
+inline bool parseQualityRuleSpecs(const char *text, std::vector<std::pair<std::string, QualityRuleSpec>> &rules)
+{
+  std::vector<std::pair<std::string, QualityRuleSpec>> parsed;
+  const char *cursor = text;
+  while (*cursor) {
+    const char *end = cursor;
+    while (*end && *end != ';') {
+      end++;
+    }
+    const std::string rule(cursor, end);
+    cursor = *end ? end + 1 : end;
+    if (rule.empty()) {
+      continue;
+    }
+
+    const std::size_t nameEnd = rule.find(':');
+    if (nameEnd == 0 || nameEnd == std::string::npos) {
+      return false;
+    }
+    QualityRuleSpec spec;
+    const char *field = rule.c_str() + nameEnd + 1;
+    char *fieldEnd = nullptr;
+    spec.viewableRatio = std::strtof(field, &fieldEnd);
+    if (fieldEnd == field || *fieldEnd != ':' || !(spec.viewableRatio >= 0 && spec.viewableRatio <= 1)) {
+      return false;
+    }
+    field = fieldEnd + 1;
+    const double duration = std::strtod(field, &fieldEnd);
+    if (fieldEnd == field || !(duration >= 0 && std::isfinite(duration))) {
+      return false;
+    }
+    if (*fieldEnd == '%') {
+      spec.durationFraction = duration / 100.0;
+      fieldEnd++;
+    } else {
+      spec.viewableSeconds = duration;
+    }
+    if (*fieldEnd == ':') {
+      for (field = fieldEnd + 1; *field;) {
+        if (*field == 'c') {
+          spec.continuous = true;
+          field++;
+        } else if (*field == 'a') {
+          spec.audibleVolume = std::strtof(field + 1, &fieldEnd);
+          if (fieldEnd == field + 1 || !(spec.audibleVolume > 0 && spec.audibleVolume <= 1)) {
+            return false;
+          }
+          field = fieldEnd;
+        } else {
+          return false;
+        }
+      }
+    } else if (*fieldEnd) {
+      return false;
+    }
+    parsed.emplace_back(rule.substr(0, nameEnd), spec);
+  }
+  rules = std::move(parsed);
+  return true;
+}
+
+// The inverse of parseQualityRuleSpecs for one rule. A rule with both
+// seconds and a duration fraction keeps only the fraction.
+inline std::string formatQualityRuleSpec(const std::string &name, const QualityRuleSpec &spec)
+{
+  char fields[96];
+  if (spec.durationFraction > 0) {
+    std::snprintf(fields, sizeof(fields), ":%.9g:%.9g%%", spec.viewableRatio, spec.durationFraction * 100.0);
+  } else {
+    std::snprintf(fields, sizeof(fields), ":%.9g:%.17g", spec.viewableRatio, spec.viewableSeconds);
+  }
+  std::string rule = name + fields;
+  if (spec.continuous || spec.audibleVolume > 0) {
+    rule += ':';
+    if (spec.continuous) {
+      rule += 'c';
+    }
+    if (spec.audibleVolume > 0) {
+      std::snprintf(fields, sizeof(fields), "a%.9g", spec.audibleVolume);
+      rule += fields;
+    }
+  }
+  return rule;
+}
+
+/**
+ * Evaluates many rule specs against one tick stream. Rules are compiled into
+ * a packed array of plain structs, every tick is a single pass over it, and
+ * continuity breaks reset state in place, so ticks never allocate.
+ */
+class QualityRuleEngine {
+ public:
+  // `audibleThreshold` is the audibility metric's, as in MPQualityStatistics.
+  explicit QualityRuleEngine(const std::vector<QualityRuleSpec> &specs, float audibleThreshold = 0.05f)
+  {
+    _rules.reserve(specs.size());
+    for (const QualityRuleSpec &spec : specs) {
+      _rules.emplace_back(spec, audibleThreshold);
+    }
+    _activeCount = _rules.size();
+    setDuration(0);
+  }
+
+  std::size_t size() const
+  {
+    return _rules.size();
+  }
+
+  // Media duration in seconds; 0 while unknown, which holds back rules that
+  // depend on it.
+  void setDuration(double duration)
+  {
+    for (Rule &rule : _rules) {
+      double required = rule.viewableSeconds;
+      if (rule.durationFraction > 0) {
+        required = duration > 0 ? std::fmax(required, rule.durationFraction * duration) : std::numeric_limits<double>::infinity();
+      }
+      rule.requiredSeconds = required;
+    }
+  }
+
+  /**
+   * `volume` < 0 means unknown, which fails audible rules and is left out of
+   * the audibility statistics. onEnd is called as (index, complete, passed,
+   * viewability, audibility) for each rule this tick finishes.
+   */
+  template <typename OnEnd>
+  void registerProgress(double progress, float viewableRatio, float volume, OnEnd &&onEnd)
+  {
+    for (std::size_t i = 0; i < _rules.size() && _activeCount > 0; i++) {
+      Rule &rule = _rules[i];
+      if (rule.ended) {
+        continue;
+      }
+
+      const bool eligible = viewableRatio >= rule.viewableRatio && (rule.audibleVolume <= 0 || volume >= rule.audibleVolume);
+      rule.test.registerProgress(progress, viewableRatio, volume, eligible);
+      rule.passing.registerProgress(progress, viewableRatio, volume, eligible);
+
+      const double viewableSeconds = rule.passing.viewability.eligibleSeconds;
+
+      // validate continuity
+      if (rule.continuous && !eligible) {
+        rule.passing.reset();
+      }
+
+      // validate duration
+      if (viewableSeconds >= rule.requiredSeconds) {
+        rule.passed = true;
+        end(i, true, onEnd);
+      }
+    }
+  }
+
+  // Ends every rule still running, as incomplete.
+  template <typename OnEnd>
+  void registerEnd(OnEnd &&onEnd)
+  {
+    for (std::size_t i = 0; i < _rules.size() && _activeCount > 0; i++) {
+      if (!_rules[i].ended) {
+        end(i, false, onEnd);
+      }
+    }
+  }
+
+ private:
+  // Viewability and audibility over the same ticks.
+  struct Window {
+    Window(float viewableThreshold, float audibleThreshold) : viewability(viewableThreshold), audibility(audibleThreshold) {}
+
+    void registerProgress(double progress, float viewableRatio, float volume, bool eligible)
+    {
+      viewability.registerProgress(progress, viewableRatio, eligible);
+      if (volume >= 0) {
+        audibility.registerProgress(progress, volume);
+      }
+    }
+
+    void reset()
+    {
+      viewability.reset();
+      audibility.reset();
+    }
+
+    QualityAccumulator viewability;
+    QualityAccumulator audibility;
+  };
+
+  struct Rule : QualityRuleSpec {
+    Rule(const QualityRuleSpec &spec, float audibleThreshold)
+    : QualityRuleSpec(spec), test(spec.viewableRatio, audibleThreshold), passing(spec.viewableRatio, audibleThreshold) {}
+
+    double requiredSeconds = 0;
+    bool ended = false;
+    bool passed = false;
+    Window test;
+    Window passing;
+  };
+
+  template <typename OnEnd>
+  void end(std::size_t index, bool complete, OnEnd &onEnd)
+  {
+    Rule &rule = _rules[index];
+    rule.ended = true;
+    _activeCount--;
+    // if the rule passed, results cover the viewable duration, otherwise
+    // the entire test duration
+    const Window &window = rule.passed ? rule.passing : rule.test;
+    onEnd(index, complete, rule.passed, window.viewability, window.audibility);
+  }
+
+  std::vector<Rule> _rules;
+  std::size_t _activeCount = 0;
+};
+
+} // namespace mp
@@ -0,0 +1,259 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "MPByteBuffer.hpp"
+
+namespace mp {
+
+/**
+ * Compact binary trace of everything the quality pipeline is fed: ticks into
+ * -[MPQualityManager registerProgress:volume:time:], statistics resets, media
+ * duration, the video actions logged from the running statistics, and when
+ * the view or audio changed (what AdaptiveSampler is told as activity).
+ * Replaying a trace through QualityAccumulator / QualityRuleEngine reproduces
+ * a session without a device or a player.
+ *
+ * Layout, little-endian: "MPQT", u8 version, u32 length + bytes of the rule
+ * specification (parseQualityRuleSpecs format), then records of a u8 kind
+ * followed by its payload.
+ */
+enum class QualityTraceKind : uint8_t {
+  Tick = 1, // f64 progress, f32 viewable ratio, f32 volume
+  Reset = 2, // no payload
+  Duration = 3, // f64 seconds
+  Action = 4, // i32 MPVideoAction
+  Activity = 5, // no payload; geometry, windows or volume changed before the next tick (version 2)
+};
+
+struct QualityTraceRecord {
+  QualityTraceKind kind = QualityTraceKind::Reset;
+  double seconds = 0; // progress for ticks, duration for Duration
+  float viewableRatio = 0;
+  float volume = 0;
+  int32_t action = 0;
+};
+
+constexpr uint8_t kQualityTraceVersion = 2;
+
+class QualityTraceWriter {
+ public:
+  explicit QualityTraceWriter(const std::string &ruleSpecs)
+  {
+    _buffer.append("MPQT", 4);
+    _buffer.push(kQualityTraceVersion);
+    putU32((uint32_t)ruleSpecs.size());
+    _buffer.append(ruleSpecs.data(), ruleSpecs.size());
+  }
+
+  void tick(double progress, float viewableRatio, float volume)
+  {
+    _buffer.push((uint8_t)QualityTraceKind::Tick);
+    putF64(progress);
+    putF32(viewableRatio);
+    putF32(volume);
+  }
+
+  void reset()
+  {
+    _buffer.push((uint8_t)QualityTraceKind::Reset);
+  }
+
+  void duration(double seconds)
+  {
+    _buffer.push((uint8_t)QualityTraceKind::Duration);
+    putF64(seconds);
+  }
+
+  void activity()
+  {
+    _buffer.push((uint8_t)QualityTraceKind::Activity);
+  }
+
+  void action(int32_t action)
+  {
+    _buffer.push((uint8_t)QualityTraceKind::Action);
+    putU32((uint32_t)action);
+  }
+
+  ByteBuffer &buffer()
+  {
+    return _buffer;
+  }
+
+ private:
+  void putU32(uint32_t value)
+  {
+    uint8_t *out = _buffer.prepare(4);
+    for (int i = 0; i < 4; i++) {
+      out[i] = (uint8_t)(value >> (8 * i));
+    }
+    _buffer.commit(4);
+  }
+
+  void putU64(uint64_t value)
+  {
+    uint8_t *out = _buffer.prepare(8);
+    for (int i = 0; i < 8; i++) {
+      out[i] = (uint8_t)(value >> (8 * i));
+    }
+    _buffer.commit(8);
+  }
+
+  void putF32(float value)
+  {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU32(bits);
+  }
+
+  void putF64(double value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(bits);
+  }
+
+  ByteBuffer _buffer;
+};
+
+/**
+ * Reads a trace in place. next() returns false at the end; failed() tells a
+ * truncated or unknown record from a clean end.
+ */
+class QualityTraceReader {
+ public:
+  QualityTraceReader(const uint8_t *bytes, std::size_t length) : _cursor(bytes), _end(bytes + length)
+  {
+    uint32_t specLength = 0;
+    if (length < 9 || std::memcmp(bytes, "MPQT", 4) != 0 || bytes[4] == 0 || bytes[4] > kQualityTraceVersion) {
+      _failed = true;
+      return;
+    }
+    _cursor += 5;
+    getU32(specLength);
+    if ((std::size_t)(_end - _cursor) < specLength) {
+      _failed = true;
+      return;
+    }
+    _ruleSpecs.assign((const char *)_cursor, specLength);
+    _cursor += specLength;
+  }
+
+  const std::string &ruleSpecs() const
+  {
+    return _ruleSpecs;
+  }
+
+  bool failed() const
+  {
+    return _failed;
+  }
+
+  bool next(QualityTraceRecord &record)
+  {
+    if (_failed || _cursor == _end) {
+      return false;
+    }
+    record = QualityTraceRecord();
+    record.kind = (QualityTraceKind)*_cursor++;
+    uint32_t action = 0;
+    bool ok;
+    switch (record.kind) {
+      case QualityTraceKind::Tick:
+        ok = getF64(record.seconds) && getF32(record.viewableRatio) && getF32(record.volume);
+        break;
+      case QualityTraceKind::Reset:
+      case QualityTraceKind::Activity:
+        ok = true;
+        break;
+      case QualityTraceKind::Duration:
+        ok = getF64(record.seconds);
+        break;
+      case QualityTraceKind::Action:
+        ok = getU32(action);
+        record.action = (int32_t)action;
+        break;
+      default:
+        ok = false;
+        break;
+    }
+    _failed = !ok;
+    return ok;
+  }
+
+ private:
+  bool getU32(uint32_t &value)
+  {
+    if (_end - _cursor < 4) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+      value |= (uint32_t)_cursor[i] << (8 * i);
+    }
+    _cursor += 4;
+    return true;
+  }
+
+  bool getU64(uint64_t &value)
+  {
+    if (_end - _cursor < 8) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; i++) {
+      value |= (uint64_t)_cursor[i] << (8 * i);
+    }
+    _cursor += 8;
+    return true;
+  }
+
+  bool getF32(float &value)
+  {
+    uint32_t bits;
+    if (!getU32(bits)) {
+      return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+  }
+
+  bool getF64(double &value)
+  {
+    uint64_t bits;
+    if (!getU64(bits)) {
+      return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+  }
+
+  const uint8_t *_cursor;
+  const uint8_t *_end;
+  std::string _ruleSpecs;
+  bool _failed = false;
+};
+
+} // namespace mp
@@ -0,0 +1,37 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#import <Foundation/Foundation.h>
+
+#import "MPQualityViewabilityMeasurement.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MPQualityViewabilityMeasurement (Snapshot)
+
+/**
+ Captures every view -viewableRatio looks at: the windows on the target view's
+ screen in z-order and their subviews, with screen rects, alpha, hidden,
+ clipsToBounds and background alpha, in the format of MPViewSnapshot.hpp.
+ Main thread only.
+ - Returns: The snapshot, or nil if the target view is not in a window.
+ */
+- (nullable NSData *)viewHierarchySnapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
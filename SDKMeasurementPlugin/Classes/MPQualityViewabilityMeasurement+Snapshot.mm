@@ -0,0 +1,80 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#import "MPQualityViewabilityMeasurement+Snapshot.h"
+
+#import "MPViewSnapshot+CoreGraphics.hpp"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static void MPAppendViewToSnapshot(UIView *view, UIView *targetView, mp::ViewSnapshotBuilder &builder, mp::ViewSnapshot &snapshot)
+{
+  uint8_t flags = 0;
+  if (view.hidden) {
+    flags |= mp::ViewSnapshotFlagHidden;
+  }
+  if (view.clipsToBounds) {
+    flags |= mp::ViewSnapshotFlagClipsToBounds;
+  }
+  if (view.isWindow) {
+    flags |= mp::ViewSnapshotFlagWindow;
+  }
+  if (CGRectIsEmpty(view.frame)) {
+    flags |= mp::ViewSnapshotFlagEmptyFrame;
+  }
+  UIColor *backgroundColor = view.backgroundColor;
+  const uint32_t index = builder.beginView(MPViewRectFromCGRect(view.screenRect),
+                                           (float)view.alpha,
+                                           backgroundColor ? (float)backgroundColor.alpha : 0.0f,
+                                           flags);
+  if (view == targetView) {
+    snapshot.target = index;
+  }
+  for (UIView *subview in view.subviews) {
+    MPAppendViewToSnapshot(subview, targetView, builder, snapshot);
+  }
+  builder.endView();
+}
+
+@implementation MPQualityViewabilityMeasurement (Snapshot)
+
+- (nullable NSData *)viewHierarchySnapshot
+{
+  UIView *targetView = self.targetView;
+  UIWindow *window = targetView.isWindow ? (UIWindow *)targetView : targetView.window;
+  if (!window) {
+    return nil;
+  }
+
+  mp::ViewSnapshot snapshot;
+  snapshot.screenBounds = MPViewRectFromCGRect(window.screen.bounds);
+  snapshot.targetFrameWidth = targetView.frame.size.width;
+  snapshot.targetFrameHeight = targetView.frame.size.height;
+  mp::ViewSnapshotBuilder builder(snapshot);
+  for (UIWindow *siblingWindow in window.siblingWindows) {
+    MPAppendViewToSnapshot(siblingWindow, targetView, builder, snapshot);
+  }
+
+  mp::ByteBuffer buffer;
+  mp::writeViewSnapshot(snapshot, buffer);
+  const NSUInteger length = buffer.size();
+  return [[NSData alloc] initWithBytesNoCopy:buffer.release() length:length freeWhenDone:YES];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
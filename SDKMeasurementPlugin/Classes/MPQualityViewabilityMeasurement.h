@@ -19,6 +19,8 @@
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
 
+@class MPViewabilityGeometry;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface MPQualityViewabilityMeasurement : NSObject
@@ -36,6 +38,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (float)viewableRatio;
 
+/**
+ * The part of -viewableRatio that has to run on the main thread: walks the
+ * view hierarchy and keeps only the rects the ratio is computed from, so the
+ * union area can be left to another thread.
+ */
+- (MPViewabilityGeometry *)captureGeometry;
+
 @end
 
 @interface UIColor (MPQualityViewabilityMeasurement)
@@ -67,22 +76,6 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (CGRect)screenRect;
 
-/**
- Returns the view's bounds rect relative to the UIScreen on which it resides, with all clipping applied.
- 
- Useful in finding the potentially visible portion of a view.
- - Returns: The UIView's clipped bounds rect relative to its UIScreen, as a CGRect.
- */
-- (CGRect)clippedScreenRect;
-
-/**
- Returns the combined alpha value after applying all superview alpha settings.
- 
- Used to determine the alpha of the view when rendered to the screen.
- - Returns: The displayed alpha as a CGFloat value.
- */
-- (CGFloat)displayedAlpha;
-
 /**
  Check if the view is the UIWindow instance attached to the shared UIApplication delegate.
  
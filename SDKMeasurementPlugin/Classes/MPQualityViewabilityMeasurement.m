@@ -18,10 +18,74 @@
 
 #import "MPQualityViewabilityMeasurement.h"
 
+#import <QuartzCore/QuartzCore.h>
+
 #import "MPBackgroundStateManaging.h"
+#import "MPViewabilityGeometry.h"
+#import "MPWindowRegistry.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ What a view passes down to its subviews: the transform from its bounds to
+ the screen, the screen bounds intersected with every clipping view so far,
+ and whether the view or an ancestor is hidden or transparent.
+ */
+typedef struct {
+  CGAffineTransform toScreen;
+  CGRect clip;
+  BOOL concealed;
+} MPViewabilityContext;
+
+static CGAffineTransform MPTransformToCoordinateSpace(UIView *view, id<UICoordinateSpace> coordinateSpace)
+{
+  CGPoint origin = [view convertPoint:CGPointZero toCoordinateSpace:coordinateSpace];
+  CGPoint unitX = [view convertPoint:CGPointMake(1.0, 0.0) toCoordinateSpace:coordinateSpace];
+  CGPoint unitY = [view convertPoint:CGPointMake(0.0, 1.0) toCoordinateSpace:coordinateSpace];
+  return CGAffineTransformMake(unitX.x - origin.x, unitX.y - origin.y,
+                               unitY.x - origin.x, unitY.y - origin.y,
+                               origin.x, origin.y);
+}
+
+/**
+ * Derives the context a view passes to its subviews from the one it got from
+ * its superview, composing the layer geometry onto the superview's transform
+ * instead of converting through every ancestor.
+ * <p/>
+ * @param clippedRect Set to the view's screen rect with every ancestor's
+ * clipping applied; CGRectZero when an ancestor hides it.
+ */
+static MPViewabilityContext MPSubviewContext(UIView *view,
+                                             MPViewabilityContext context,
+                                             id<UICoordinateSpace> screenSpace,
+                                             CGRect *clippedRect)
+{
+  MPViewabilityContext subviewContext = context;
+  CALayer *layer = view.layer;
+  if (view.isWindow || !CATransform3DIsAffine(layer.transform)) {
+    subviewContext.toScreen = MPTransformToCoordinateSpace(view, screenSpace);
+  } else {
+    CGRect bounds = layer.bounds;
+    CGPoint anchorPoint = layer.anchorPoint;
+    CGPoint position = layer.position;
+    CGAffineTransform toSuperview = CGAffineTransformMakeTranslation(-(bounds.origin.x + anchorPoint.x * bounds.size.width),
+                                                                     -(bounds.origin.y + anchorPoint.y * bounds.size.height));
+    toSuperview = CGAffineTransformConcat(toSuperview, CATransform3DGetAffineTransform(layer.transform));
+    toSuperview = CGAffineTransformConcat(toSuperview, CGAffineTransformMakeTranslation(position.x, position.y));
+    subviewContext.toScreen = CGAffineTransformConcat(toSuperview, context.toScreen);
+  }
+
+  CGRect screenRect = CGRectApplyAffineTransform(view.bounds, subviewContext.toScreen);
+  *clippedRect = context.concealed ? CGRectZero : CGRectIntersection(screenRect, context.clip);
+  if (view.hidden || view.alpha == 0.0) {
+    subviewContext.concealed = YES;
+  }
+  if (view.clipsToBounds) {
+    subviewContext.clip = CGRectIntersection(context.clip, screenRect);
+  }
+  return subviewContext;
+}
+
 @implementation MPQualityViewabilityMeasurement
 
 + (nullable instancetype)measurementWithTargetView:(UIView *)targetView
@@ -44,221 +108,120 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (float)viewableRatio
+{
+  return [[self captureGeometry] viewableRatio];
+}
+
+- (MPViewabilityGeometry *)captureGeometry
 {
   // viewableRatio is 0.0 if the app is backgrounded
   UIApplicationState state = [[MPBackgroundStateManagerFactory backgroundStateManager] applicationState];
   if (state == UIApplicationStateBackground || state == UIApplicationStateInactive)
   {
-    return 0.0f;
+    return [MPViewabilityGeometry notViewableGeometry];
   }
   
-  if (!self.targetView.visible || 0.9 - self.targetView.displayedAlpha > 0.0001) {
-    return 0.0f;
+  UIView *targetView = self.targetView;
+  if (!targetView.visible) {
+    return [MPViewabilityGeometry notViewableGeometry];
   }
   
-  CGRect targetRect = [self.targetView clippedScreenRect];
-  
-  // Recursively get all the descendant rectangles of current target, the target parent
-  // to the top most container.
-  NSMutableArray<NSValue *> *relatedRects = [self overlappingRectsInView:self.targetView
-                                                              targetRect:targetRect];
-  // calculate the size without the target view.
-  CGFloat areaSize = [self unionAreaOfRects:relatedRects];
-  
-  // add the target rectangle
-  [relatedRects addObject:[NSValue valueWithCGRect:targetRect]];
-  
-  // calculate area difference
-  CGFloat newAreaSize = [self unionAreaOfRects:relatedRects];
-  CGFloat targetViewableArea = newAreaSize - areaSize;
+  // The target and its ancestors, window first.
+  NSMutableArray<UIView *> *chain = [NSMutableArray new];
+  for (UIView *view = targetView; view; view = view.superview) {
+    [chain insertObject:view atIndex:0];
+  }
+  UIWindow *window = (UIWindow *)chain.firstObject;
+  if (!window.isWindow) {
+    return [MPViewabilityGeometry notViewableGeometry];
+  }
+  const NSUInteger depth = chain.count;
   
-  // return viewable area
-  CGFloat targetArea = self.targetView.frame.size.width * self.targetView.frame.size.height;
-  return (float)(targetViewableArea / targetArea);
-}
-
-/**
- * Recursively find the CGRect values from views owned by the given UIView,
- * which overlap the target CGRect.
- * <p/>
- * @param view The target UIView.
- * @param targetRect The target CGRect value.
- * @return The set of overlapping CGRect values as NSValue objects.
- */
-
-- (NSMutableArray<NSValue *> *)overlappingRectsInView:(UIView *)view
-                                           targetRect:(CGRect)targetRect
-{
-  NSMutableArray<NSValue *> *relatedRects = [NSMutableArray new];
+  // One pass down to the target; contexts[i] is what chain[i] passes to its subviews.
+  id<UICoordinateSpace> screenSpace = window.screen.coordinateSpace;
+  MPViewabilityContext screenContext = {CGAffineTransformIdentity, window.screen.bounds, NO};
+  MPViewabilityContext contexts[depth];
+  CGRect targetRect = CGRectNull;
+  CGFloat displayedAlpha = 1.0;
+  for (NSUInteger i = 0; i < depth; i++) {
+    contexts[i] = MPSubviewContext(chain[i], i ? contexts[i - 1] : screenContext, screenSpace, &targetRect);
+    displayedAlpha *= chain[i].alpha;
+  }
+  if (0.9 - displayedAlpha > 0.0001 || CGRectIsEmpty(targetRect)) {
+    return [MPViewabilityGeometry notViewableGeometry];
+  }
   
-  UIView *superview = view.superview;
-  if (superview || view.isWindow) {
-    
-    // get array of sibling views, including the view being considered
-    NSArray<UIView *> *siblings;
-    NSUInteger viewIndex;
-    if (view.isWindow) {
-      UIWindow *window = (UIWindow *)view;
-      siblings = window.siblingWindows;
-      viewIndex = [siblings indexOfObject:window];
-    } else {
-      siblings = superview.subviews;
-      viewIndex = [siblings indexOfObject:view];
-    }
-    
-    // include rects of intersecting sibling views, which are at a
-    // higher index in the sibling array than the view being considered
-    for (NSUInteger i = viewIndex + 1; i < siblings.count; i++) {
-      [relatedRects addObjectsFromArray:[self intersectingRectsInView:[siblings objectAtIndex:i]
-                                                           targetRect:targetRect]];
-    }
-    
-    // recursively consider superviews
-    if (superview) {
-      [relatedRects addObjectsFromArray:[self overlappingRectsInView:superview
-                                                          targetRect:targetRect]];
+  // Collect the rects drawn above the target: on the way up, every sibling
+  // at a higher index than the view being considered, and every later window
+  // on the same screen.
+  NSMutableData *relatedRects = [NSMutableData new];
+  for (NSUInteger i = depth - 1; i > 0; i--) {
+    NSArray<UIView *> *siblings = chain[i - 1].subviews;
+    NSUInteger viewIndex = [siblings indexOfObjectIdenticalTo:chain[i]];
+    for (NSUInteger j = viewIndex + 1; j < siblings.count; j++) {
+      [self collectRectsInView:siblings[j]
+                       context:contexts[i - 1]
+                   screenSpace:screenSpace
+                    targetRect:targetRect
+                         rects:relatedRects];
     }
   }
-  return relatedRects;
+  [[MPWindowRegistry sharedRegistry] enumerateWindowsAboveWindow:window usingBlock:^(UIWindow *aboveWindow) {
+    [self collectRectsInView:aboveWindow
+                     context:screenContext
+                 screenSpace:screenSpace
+                  targetRect:targetRect
+                       rects:relatedRects];
+  }];
+  
+  CGSize targetSize = targetView.frame.size;
+  return [[MPViewabilityGeometry alloc] initWithTargetRect:targetRect
+                                                targetArea:targetSize.width * targetSize.height
+                                            occludingRects:(const CGRect *)relatedRects.bytes
+                                                     count:relatedRects.length / sizeof(CGRect)];
 }
 
 /**
- * Recursively find the CGRect values from views owned by the given UIView,
- * which intersect the target CGRect.
+ * Recursively collect the clipped screen rects of blocking views in the given
+ * UIView's subtree which intersect the target CGRect. Each view is visited
+ * once, and a subtree whose clip misses the target is not entered.
  * <p/>
- * @param view The target UIViews
+ * @param view The UIView to start from.
+ * @param context What the view's superview passes down.
+ * @param screenSpace The coordinate space of the screen.
  * @param targetRect The target CGRect value.
- * @return The set of intersecting CGRect values as NSValue objects.
+ * @param rects Receives the intersecting CGRect values, packed.
  */
-
-- (NSArray<NSValue *> *)intersectingRectsInView:(UIView *)view
-                                     targetRect:(CGRect)targetRect
+- (void)collectRectsInView:(UIView *)view
+                   context:(MPViewabilityContext)context
+               screenSpace:(id<UICoordinateSpace>)screenSpace
+                targetRect:(CGRect)targetRect
+                     rects:(NSMutableData *)rects
 {
-  __block NSMutableArray *visibleRects = [NSMutableArray new];
-  
-  // Only consider visible views
-  if (!view.visible) {
-    return visibleRects;
+  // Only consider visible views which can still reach the target
+  if (!view.visible || context.concealed || !CGRectIntersectsRect(context.clip, targetRect)) {
+    return;
   }
   
   // If the view is blocking and intersects the target CGRect, add its CGRect
-  CGRect clippedWindowFrame = [view clippedScreenRect];
-  if (view.blocking && CGRectIntersectsRect(clippedWindowFrame, targetRect)) {
-    [visibleRects addObject:[NSValue valueWithCGRect:clippedWindowFrame]];
+  CGRect clippedRect;
+  MPViewabilityContext subviewContext = MPSubviewContext(view, context, screenSpace, &clippedRect);
+  BOOL blocking = view.blocking;
+  if (blocking && CGRectIntersectsRect(clippedRect, targetRect)) {
+    [rects appendBytes:&clippedRect length:sizeof(clippedRect)];
   }
   
   // If the view isn't blocking or doesn't clip its bounds,
   // recursively consider its subviews
-  if (!view.clipsToBounds || !view.blocking) {
-    [view.subviews enumerateObjectsUsingBlock:^(__kindof UIView *subview, NSUInteger idx, BOOL *stop) {
-      [visibleRects addObjectsFromArray:[self intersectingRectsInView:subview targetRect:targetRect]];
-    }];
-  }
-  
-  return visibleRects;
-}
-
-/**
- * Discretization algorithm used to calculate the total size of rectangles, the overlapped
- * one will only be calculated once.
- * <p/>
- * The main idea is:
- * 1. discretizing all the rectangles by x and y axis
- * 2. mark the areas the rectangle covers
- * 3. calculate all the areas which are marked as covered
- * <p/>
- * This is the easiest algorithm I implemented from scratch, the only concern is the time
- * complexity which is a bit high: O(n^3), need to do performance test.
- *
- * @param rects The set of CGRect values as NSValue objects, from which to derive a union area.
- * @return The union area as a CGFloat value.
- */
-- (CGFloat)unionAreaOfRects:(NSArray<NSValue *> *)rects
-{
-  const NSUInteger size = rects.count;
-  const NSUInteger dim = size * 2;
-  
-  CGFloat x[dim];
-  CGFloat y[dim];
-  bool isCovered[dim][dim];
-  memset(isCovered, 0, sizeof(bool) * dim * dim);
-  
-  NSUInteger xPos = 0;
-  NSUInteger yPos = 0;
-  for (NSUInteger i = 0; i < size; i++) {
-    CGRect r = [rects[i] CGRectValue];
-    // store left and bottom points
-    x[xPos++] = r.origin.x;
-    y[yPos++] = r.origin.y + r.size.height;
-    
-    // store right and top points
-    x[xPos++] = r.origin.x + r.size.width;
-    y[yPos++] = r.origin.y;
-  }
-  
-  // sort on x and y axis
-  qsort(x, dim, sizeof(CGFloat), compCGFloat);
-  qsort(y, dim, sizeof(CGFloat), compCGFloat);
-  
-  for (NSUInteger i = 0; i < size; i++) {
-    CGRect r = [rects[i] CGRectValue];
-    NSInteger leftEdgeIndex = binarySearch(x, dim, r.origin.x);
-    NSInteger rightEdgeIndex = binarySearch(x, dim, r.origin.x + r.size.width);
-    NSInteger topEdgeIndex = binarySearch(y, dim, r.origin.y);
-    NSInteger bottomEdgeIndex = binarySearch(y, dim, r.origin.y + r.size.height);
-    
-    for (NSInteger m = leftEdgeIndex + 1; m <= rightEdgeIndex; m++) {
-      for (NSInteger n = topEdgeIndex + 1; n <= bottomEdgeIndex; n++) {
-        isCovered[m][n] = true;
-      }
+  if (!view.clipsToBounds || !blocking) {
+    for (UIView *subview in view.subviews) {
+      [self collectRectsInView:subview
+                       context:subviewContext
+                   screenSpace:screenSpace
+                    targetRect:targetRect
+                         rects:rects];
     }
   }
-  
-  CGFloat area = 0.0;
-  for (NSUInteger i = 0; i < dim; i++) {
-    for (NSUInteger j = 0; j < dim; j++) {
-      if (isCovered[i][j]) {
-        CGFloat x0 = x[i - 1];
-        CGFloat x1 = x[i];
-        CGFloat y0 = y[j - 1];
-        CGFloat y1 = y[j];
-        CGFloat newArea = (x1 - x0) * (y1 - y0);
-        area += newArea;
-      }
-    }
-  }
-  return area;
-}
-
-static int compCGFloat(const void *a, const void *b)
-{
-  if(*(CGFloat*)a < *(CGFloat*)b) return -1;
-  return *(CGFloat*)a > *(CGFloat*)b;
-}
-
-/**
- * Binary search the index of the value in array.
- *
- * @param values Array of CGFloat values to search.
- * @param size Size of the array passed to the values argument.
- * @param target CGFloat value to search for.
- * @return index if found, -1 if not.
- */
-static NSInteger binarySearch(const CGFloat * values, size_t size, const CGFloat target)
-{
-  NSInteger low = 0;
-  NSInteger high = (NSInteger)size;
-  while (low < high) {
-    NSInteger mid = low + (high - low) / 2;
-    if (values[mid] == target) {
-      return mid;
-    } else if (values[mid] > target) {
-      high = mid;
-    } else {
-      low = mid + 1;
-    }
-  }
-  return -1;
 }
 
 @end
@@ -277,16 +240,7 @@ static NSInteger binarySearch(const CGFloat * values, size_t size, const CGFloat
 
 - (NSArray<UIWindow *> *)siblingWindows
 {
-  NSMutableArray<UIWindow *> *siblingWindows = [NSMutableArray new];
-  NSArray<UIWindow *> *windows = [UIApplication sharedApplication].windows;
-  for (NSUInteger i = 0; i < windows.count; i++) {
-    UIWindow *window = [windows objectAtIndex:i];
-    if (window.screen == self.screen) {
-      [siblingWindows addObject:window];
-    }
-  }
-  
-  return [NSArray arrayWithArray:siblingWindows];
+  return [[MPWindowRegistry sharedRegistry] windowsForScreen:self.screen];
 }
 
 @end
@@ -305,37 +259,6 @@ static NSInteger binarySearch(const CGFloat * values, size_t size, const CGFloat
   return [self convertRect:self.bounds toCoordinateSpace:(id <UICoordinateSpace>)self.window.screen.coordinateSpace];
 }
 
-- (CGRect)clippedScreenRect
-{
-  CGRect windowFrame = [self screenRect];
-  UIView *view = self;
-  while (view.superview) {
-    if (view.superview.hidden || view.superview.alpha == 0.0) {
-      return CGRectZero;
-    }
-    if (view.superview.clipsToBounds) {
-      windowFrame = CGRectIntersection(windowFrame, [view.superview screenRect]);
-    }
-    view = view.superview;
-  }
-  if (view.isWindow) {
-    UIWindow *window = (UIWindow *)view;
-    return CGRectIntersection(windowFrame, window.screen.bounds);
-  }
-  return CGRectZero;
-}
-
-- (CGFloat)displayedAlpha
-{
-  CGFloat alpha = self.alpha;
-  UIView *view = self;
-  while (view.superview) {
-    alpha = alpha * view.superview.alpha;
-    view = view.superview;
-  }
-  return alpha;
-}
-
 - (BOOL)isWindow
 {
   return [self isKindOfClass:[UIWindow class]];
@@ -24,6 +24,7 @@ NS_ASSUME_NONNULL_BEGIN
 static NSString * const FB_AN_LOG_LEVEL = @"fb_an_log_lv";
 static NSString * const FB_AN_URL_PREFIX = @"fb_an_url_prefix";
 static NSString * const FB_AN_TEST_DEVICES = @"fb_an_test_devices";
+static NSString * const FB_AN_SYSTEM_USER_AGENT = @"fb_an_system_user_agent";
 
 @interface MPSettings (Internal)
 
@@ -0,0 +1,137 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace mp {
+
+/**
+ * Hash set split into independently locked shards so that concurrent
+ * membership tests and updates on different keys rarely contend.
+ * ShardCount must be a power of two.
+ */
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>, std::size_t ShardCount = 16>
+class ShardedSet {
+  static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+ public:
+  ShardedSet() = default;
+  ShardedSet(const ShardedSet &) = delete;
+  ShardedSet &operator=(const ShardedSet &) = delete;
+
+  // Returns true if the value was not already present.
+  bool insert(const T &value)
+  {
+    Shard &shard = shardFor(value);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    return shard.set.insert(value).second;
+  }
+
+  // Returns true if the value was present.
+  bool erase(const T &value)
+  {
+    Shard &shard = shardFor(value);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    return shard.set.erase(value) > 0;
+  }
+
+  bool contains(const T &value) const
+  {
+    const Shard &shard = shardFor(value);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    return shard.set.find(value) != shard.set.end();
+  }
+
+  // Not a linearizable snapshot: shards are visited one at a time.
+  std::size_t size() const
+  {
+    std::size_t count = 0;
+    for (const Shard &shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard.lock);
+      count += shard.set.size();
+    }
+    return count;
+  }
+
+  bool empty() const
+  {
+    for (const Shard &shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard.lock);
+      if (!shard.set.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void clear()
+  {
+    for (Shard &shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard.lock);
+      shard.set.clear();
+    }
+  }
+
+  std::vector<T> values() const
+  {
+    std::vector<T> result;
+    for (const Shard &shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard.lock);
+      result.insert(result.end(), shard.set.begin(), shard.set.end());
+    }
+    return result;
+  }
+
+ private:
+  // Padded so neighbouring shard locks do not share a cache line.
+  struct Shard {
+    mutable std::mutex lock;
+    std::unordered_set<T, Hash, KeyEqual> set;
+    char padding[64];
+  };
+
+  Shard &shardFor(const T &value)
+  {
+    return _shards[mix(Hash()(value)) & (ShardCount - 1)];
+  }
+
+  const Shard &shardFor(const T &value) const
+  {
+    return _shards[mix(Hash()(value)) & (ShardCount - 1)];
+  }
+
+  // std::hash is the identity for integers on libc++, so spread the low bits.
+  static std::size_t mix(std::size_t hash)
+  {
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3b;
+    hash ^= hash >> 16;
+    return hash;
+  }
+
+  std::array<Shard, ShardCount> _shards;
+};
+
+} // namespace mp
@@ -0,0 +1,148 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mp {
+
+/**
+ * Copy-on-write vector for read-mostly data.
+ *
+ * Readers take an immutable snapshot without touching the write lock; writers
+ * serialize on a mutex, copy the current version, mutate the copy and publish
+ * it atomically. Old versions are reclaimed RCU-style: a version is destroyed
+ * once the last reader holding a snapshot of it lets go.
+ *
+ * Appends do not copy. Versions share a buffer with spare capacity and each
+ * one only exposes the prefix that existed when it was published, so
+ * push_back constructs the new element past every reader's end and publishes
+ * a longer view of the same buffer. The buffer doubles when it fills up,
+ * which keeps appends amortized O(1).
+ */
+template <typename T>
+class SnapshotVector {
+ public:
+  using Storage = std::vector<T>;
+
+  // Immutable view of one published version.
+  class Version {
+   public:
+    Version(std::shared_ptr<Storage> storage, std::size_t count)
+      : _storage(std::move(storage)), _items(_storage->data()), _count(count) {}
+
+    const T *data() const { return _items; }
+    std::size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    const T &operator[](std::size_t index) const { return _items[index]; }
+    const T *begin() const { return _items; }
+    const T *end() const { return _items + _count; }
+
+   private:
+    friend class SnapshotVector;
+
+    // Only the writer touches the buffer itself, and only past _count.
+    std::shared_ptr<Storage> _storage;
+    const T *_items;
+    std::size_t _count;
+  };
+
+  using Snapshot = std::shared_ptr<const Version>;
+
+  SnapshotVector() : _current(makeVersion(Storage())) {}
+
+  explicit SnapshotVector(Storage storage) : _current(makeVersion(std::move(storage))) {}
+
+  SnapshotVector(const SnapshotVector &) = delete;
+  SnapshotVector &operator=(const SnapshotVector &) = delete;
+
+  // Never waits for a writer's copy or mutation. The load goes through the
+  // shared_ptr atomic access functions, which libc++ implements with a small
+  // spin lock pool, so it is short but not lock-free.
+  Snapshot snapshot() const
+  {
+    return std::atomic_load_explicit(&_current, std::memory_order_acquire);
+  }
+
+  std::size_t size() const
+  {
+    return snapshot()->size();
+  }
+
+  bool empty() const
+  {
+    return snapshot()->empty();
+  }
+
+  // Applies `mutator` to a private copy of the current version and publishes
+  // the copy once the mutator returns. Nothing is published if it throws.
+  template <typename Mutator>
+  void update(Mutator &&mutator)
+  {
+    std::lock_guard<std::mutex> lock(_writeLock);
+    Snapshot current = std::atomic_load_explicit(&_current, std::memory_order_relaxed);
+    Storage next(current->begin(), current->end());
+    mutator(next);
+    publish(makeVersion(std::move(next)));
+  }
+
+  void push_back(T value)
+  {
+    std::lock_guard<std::mutex> lock(_writeLock);
+    Snapshot current = std::atomic_load_explicit(&_current, std::memory_order_relaxed);
+    const std::size_t count = current->size();
+    std::shared_ptr<Storage> storage = current->_storage;
+    // The published version always covers the whole buffer, so there is
+    // nothing past `count` yet and in-place growth is invisible to readers.
+    if (storage->size() != count || count == storage->capacity()) {
+      auto grown = std::make_shared<Storage>();
+      grown->reserve(count < 4 ? 8 : count * 2);
+      grown->insert(grown->end(), current->begin(), current->end());
+      storage = std::move(grown);
+    }
+    storage->push_back(std::move(value));
+    publish(std::make_shared<const Version>(std::move(storage), count + 1));
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_writeLock);
+    publish(makeVersion(Storage()));
+  }
+
+ private:
+  static Snapshot makeVersion(Storage storage)
+  {
+    const std::size_t count = storage.size();
+    return std::make_shared<const Version>(std::make_shared<Storage>(std::move(storage)), count);
+  }
+
+  void publish(Snapshot next)
+  {
+    std::atomic_store_explicit(&_current, std::move(next), std::memory_order_release);
+  }
+
+  Snapshot _current;
+  std::mutex _writeLock;
+};
+
+} // namespace mp
@@ -0,0 +1,195 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mp {
+
+/**
+ * Small integer codes for the strings every event repeats: event types and
+ * video logging parameter keys.
+ *
+ * Codes are persisted in the events table and may be sent on the wire, so the
+ * list is append-only. Bump kSymbolTableVersion whenever it grows.
+ */
+enum class Symbol : uint8_t {
+  None = 0,
+  // Event types (MPEventType)
+  Impression,
+  ImpressionMiss,
+  StoreClick,
+  LinkClick,
+  ViewReport,
+  Video,
+  Close,
+  BrowserSession,
+  AdComplete,
+  Debug,
+  // Video logging parameters (MPVideoLoggingParameter)
+  Action,
+  AudibleTimeMs,
+  Autoplay,
+  MaxContinuousAudibleTimeMs,
+  MaxContinuousViewableTimeMs,
+  PlayerHeight,
+  PlayerOffsetLeft,
+  PlayerOffsetTop,
+  PlayerWidth,
+  PreviousTime,
+  Time,
+  ViewabilityAvg,
+  ViewabilityMax,
+  ViewabilityMin,
+  ViewableTimeMs,
+  ViewportHeight,
+  ViewportWidth,
+  VolumeAvg,
+  VolumeMax,
+  VolumeMin,
+  ViewableDetection,
+  // Added in version 2
+  ViewabilityP50,
+  ViewabilityP90,
+  ViewabilityHistogram,
+  VolumeP50,
+  VolumeP90,
+  VolumeHistogram,
+  Count,
+};
+
+constexpr int kSymbolTableVersion = 2;
+
+constexpr const char *kSymbolNames[] = {
+  "",
+  "impression",
+  "impression_miss",
+  "store",
+  "open_link",
+  "native_view",
+  "video",
+  "close",
+  "browser_session",
+  "ad_complete",
+  "debug",
+  "action",
+  "atime_ms",
+  "autoplay",
+  "mcat_ms",
+  "mcvt_ms",
+  "ph",
+  "pl",
+  "pt",
+  "pw",
+  "ptime",
+  "time",
+  "vwa",
+  "vwmax",
+  "vwm",
+  "vtime_ms",
+  "vph",
+  "vpw",
+  "vla",
+  "vlmax",
+  "vlm",
+  "vw_d",
+  "vwp50",
+  "vwp90",
+  "vwh",
+  "vlp50",
+  "vlp90",
+  "vlh",
+};
+
+static_assert(sizeof(kSymbolNames) / sizeof(kSymbolNames[0]) == (std::size_t)Symbol::Count,
+              "Every symbol needs a name");
+
+constexpr std::size_t symbolNameLength(const char *name)
+{
+  std::size_t length = 0;
+  while (name[length] != '\0') {
+    length++;
+  }
+  return length;
+}
+
+constexpr bool symbolNameEquals(const char *name, const char *bytes, std::size_t length)
+{
+  for (std::size_t i = 0; i < length; i++) {
+    if (name[i] == '\0' || name[i] != bytes[i]) {
+      return false;
+    }
+  }
+  return name[length] == '\0';
+}
+
+constexpr const char *symbolName(Symbol symbol)
+{
+  return (std::size_t)symbol < (std::size_t)Symbol::Count ? kSymbolNames[(std::size_t)symbol] : nullptr;
+}
+
+// Symbol::None for strings outside the table.
+constexpr Symbol symbolForName(const char *bytes, std::size_t length)
+{
+  for (std::size_t i = 1; i < (std::size_t)Symbol::Count; i++) {
+    if (symbolNameEquals(kSymbolNames[i], bytes, length)) {
+      return (Symbol)i;
+    }
+  }
+  return Symbol::None;
+}
+
+/**
+ * The events table's type column has TEXT affinity, so a code bound as an
+ * integer is stored, and read back, as its decimal text. Symbol::None unless
+ * the text is exactly a known code.
+ */
+constexpr Symbol symbolForStoredCode(const char *text)
+{
+  if (!text || text[0] < '1' || text[0] > '9') {
+    return Symbol::None;
+  }
+  std::size_t code = 0;
+  for (std::size_t i = 0; text[i] != '\0'; i++) {
+    if (text[i] < '0' || text[i] > '9' || i >= 3) {
+      return Symbol::None;
+    }
+    code = code * 10 + (std::size_t)(text[i] - '0');
+  }
+  return code < (std::size_t)Symbol::Count ? (Symbol)code : Symbol::None;
+}
+
+constexpr bool symbolNamesAreUnique()
+{
+  for (std::size_t i = 1; i < (std::size_t)Symbol::Count; i++) {
+    if (symbolForName(kSymbolNames[i], symbolNameLength(kSymbolNames[i])) != (Symbol)i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(symbolNamesAreUnique(), "Symbol names must be unique and non-empty");
+static_assert(symbolForName("vtime_ms", 8) == Symbol::ViewableTimeMs, "Symbol lookup is broken");
+static_assert(symbolForStoredCode("6") == Symbol::Video && symbolForStoredCode("06") == Symbol::None &&
+              symbolForStoredCode("video") == Symbol::None && symbolForStoredCode("255") == Symbol::None,
+              "Stored code lookup is broken");
+
+} // namespace mp
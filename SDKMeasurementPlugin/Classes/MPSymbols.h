@@ -0,0 +1,50 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+#import "MPDefines+Internal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+FB_EXTERN_C_BEGIN
+
+/**
+ Interned codes for event types and video logging parameter keys (see
+ MPSymbolTable.hpp). 0 means the string is not in the table.
+ */
+typedef NSInteger MPSymbolCode;
+
+extern const NSInteger MPSymbolTableVersion;
+
+MPSymbolCode MPSymbolCodeForString(NSString * __nullable string);
+
+/**
+ Returns the shared string for a code, or nil if the code is unknown.
+ */
+NSString * __nullable MPSymbolStringForCode(MPSymbolCode code);
+
+/**
+ Returns the shared string for a code as read back from a TEXT column, or nil
+ if the text is not a known code.
+ */
+NSString * __nullable MPSymbolStringForStoredText(const char * __nullable text);
+
+FB_EXTERN_C_END
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,67 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPSymbols.h"
+
+#import "MPSymbolTable.hpp"
+
+NS_ASSUME_NONNULL_BEGIN
+
+const NSInteger MPSymbolTableVersion = mp::kSymbolTableVersion;
+
+MPSymbolCode MPSymbolCodeForString(NSString * __nullable string)
+{
+  if (string.length == 0) {
+    return 0;
+  }
+  CFStringRef cfString = (__bridge CFStringRef)string;
+  const char *bytes = CFStringGetCStringPtr(cfString, kCFStringEncodingASCII);
+  if (bytes) {
+    return (MPSymbolCode)mp::symbolForName(bytes, (size_t)CFStringGetLength(cfString));
+  }
+  // Every symbol is short ASCII; anything that does not fit cannot match.
+  char buffer[32];
+  if (!CFStringGetCString(cfString, buffer, sizeof(buffer), kCFStringEncodingASCII)) {
+    return 0;
+  }
+  return (MPSymbolCode)mp::symbolForName(buffer, strlen(buffer));
+}
+
+NSString * __nullable MPSymbolStringForCode(MPSymbolCode code)
+{
+  static NSArray<NSString *> *strings;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSMutableArray<NSString *> *table = [NSMutableArray arrayWithCapacity:(NSUInteger)mp::Symbol::Count];
+    for (size_t i = 0; i < (size_t)mp::Symbol::Count; i++) {
+      [table addObject:@(mp::kSymbolNames[i])];
+    }
+    strings = [table copy];
+  });
+  if (code <= 0 || code >= (MPSymbolCode)mp::Symbol::Count) {
+    return nil;
+  }
+  return strings[(NSUInteger)code];
+}
+
+NSString * __nullable MPSymbolStringForStoredText(const char * __nullable text)
+{
+  return MPSymbolStringForCode((MPSymbolCode)mp::symbolForStoredCode(text));
+}
+
+NS_ASSUME_NONNULL_END
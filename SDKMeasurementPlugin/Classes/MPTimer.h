@@ -39,6 +39,10 @@ typedef BOOL (^fb_timer_condition_block)(MPTimer *timer);
 - (void)invalidate;
 - (void)fire;
 
+// Moves the next firing to `ti` seconds from now without recreating the timer.
+// Returns NO if the timer has already been invalidated.
+- (BOOL)rescheduleWithTimeInterval:(NSTimeInterval)ti;
+
 @end
 
 NS_ASSUME_NONNULL_END
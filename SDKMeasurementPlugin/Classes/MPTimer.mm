@@ -18,34 +18,32 @@
 
 #import "MPTimer.h"
 
+#import <atomic>
+
+#import "MPTimerWheel.hpp"
+
 NS_ASSUME_NONNULL_BEGIN
 
+// Matches the leeway the per-timer dispatch sources used to be created with.
+static const NSTimeInterval kMPTimerLeeway = 0.1;
+
+static mp::TimerScheduler::Duration MPTimerDurationFromTimeInterval(NSTimeInterval interval)
+{
+  return std::chrono::duration_cast<mp::TimerScheduler::Duration>(std::chrono::duration<double>(MAX(interval, 0.0)));
+}
+
 @interface MPTimer ()
+{
+  std::atomic<mp::TimerScheduler::TimerId> _timerId;
+}
 
-@property (atomic, strong, readwrite, nullable) dispatch_source_t timer;
-@property (nonatomic, copy, readwrite) dispatch_block_t block;
-@property (nonatomic, copy, readwrite) fb_timer_block innerBlock;
-@property (nonatomic, copy, readwrite) BOOL (^condition)(void);
+@property (nonatomic, copy, readwrite, nullable) dispatch_block_t block;
+@property (nonatomic, copy, readwrite, nullable) fb_timer_block innerBlock;
 @property (nonatomic, strong, readwrite, nullable) dispatch_queue_t queue;
 @property (nonatomic, assign, readwrite) NSTimeInterval timeInterval;
-@property (nonatomic, assign, readwrite) BOOL repeats;
 
 @end
 
-dispatch_source_t FBDispatchTimerMake(NSTimeInterval interval, dispatch_queue_t queue, dispatch_block_t block);
-
-dispatch_source_t FBDispatchTimerMake(NSTimeInterval interval, dispatch_queue_t queue, dispatch_block_t block)
-{
-  dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
-  if (timer)
-  {
-    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), (uint64_t)(interval * NSEC_PER_SEC), (1ull * NSEC_PER_SEC) / 10);
-    dispatch_source_set_event_handler(timer, block);
-    dispatch_resume(timer);
-  }
-  return timer;
-}
-
 @implementation MPTimer
 
 FB_FINAL_CLASS(objc_getClass("MPTimer"));
@@ -88,31 +86,45 @@ FB_FINAL_CLASS(objc_getClass("MPTimer"));
     queue = dispatch_get_main_queue();
   }
   _queue = queue;
-  
-  self.timer = FBDispatchTimerMake(ti, queue, wrapperBlock);
   _block = wrapperBlock;
   _timeInterval = ti;
   
+  // The shared wheel's driver thread only hops onto the target queue; the
+  // timer itself is a wheel entry rather than a dispatch source.
+  mp::TimerScheduler::Duration interval = MPTimerDurationFromTimeInterval(ti);
+  _timerId = mp::TimerScheduler::shared().schedule(interval,
+                                                   MPTimerDurationFromTimeInterval(kMPTimerLeeway),
+                                                   interval,
+                                                   [queue, wrapperBlock] {
+                                                     dispatch_async(queue, wrapperBlock);
+                                                   });
+  
   return self;
 }
 
 - (void)invalidate
 {
-  dispatch_source_t timer = self.timer;
-  if (timer) {
-    dispatch_source_cancel(MPUnwrap(timer));
-    self.timer = nil;
+  mp::TimerScheduler::TimerId timerId = _timerId.exchange(0);
+  if (timerId) {
+    mp::TimerScheduler::shared().cancel(timerId);
   }
   _userInfo = nil;
   _innerBlock = nil;
   _block = nil;
-  _condition = nil;
   _queue = nil;
 }
 
+- (BOOL)rescheduleWithTimeInterval:(NSTimeInterval)ti
+{
+  mp::TimerScheduler::TimerId timerId = _timerId.load();
+  return timerId != 0 && mp::TimerScheduler::shared().reschedule(timerId,
+                                                                 MPTimerDurationFromTimeInterval(ti),
+                                                                 MPTimerDurationFromTimeInterval(kMPTimerLeeway));
+}
+
 - (BOOL)isValid
 {
-  return (self.timer != nil);
+  return _timerId.load() != 0;
 }
 
 - (void)dealloc
@@ -122,9 +134,10 @@ FB_FINAL_CLASS(objc_getClass("MPTimer"));
 
 - (void)fire
 {
-  if (self.valid && self.block) {
+  dispatch_block_t block = self.block;
+  if (self.valid && block) {
     dispatch_async(_queue ? MPUnwrap(_queue) : dispatch_get_main_queue(), ^{
-      FB_BLOCK_CALL_SAFE(self.block);
+      FB_BLOCK_CALL_SAFE(block);
     });
   }
 }
@@ -133,4 +146,3 @@ FB_FINAL_CLASS(objc_getClass("MPTimer"));
 @end
 
 NS_ASSUME_NONNULL_END
-
@@ -0,0 +1,356 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "MPTimerWheel.hpp"
+
+#include <algorithm>
+
+namespace mp {
+
+namespace {
+
+inline int lowestSetBit(uint64_t bits)
+{
+  return __builtin_ctzll(bits);
+}
+
+inline uint64_t bitsAbove(int index)
+{
+  return index >= 63 ? 0 : (~uint64_t(0) << (index + 1));
+}
+
+} // namespace
+
+constexpr int TimerWheel::kLevelBits;
+constexpr int TimerWheel::kLevelCount;
+constexpr TimerWheel::Tick TimerWheel::kSlotCount;
+constexpr TimerWheel::Tick TimerWheel::kMaxSpan;
+constexpr TimerWheel::Tick TimerWheel::kNever;
+
+TimerWheel::TimerWheel(Tick now) : _now(now) {}
+
+TimerWheel::~TimerWheel()
+{
+  for (auto &timer : _timers) {
+    delete timer.second;
+  }
+}
+
+TimerWheel::Tick TimerWheel::coalescedExpiry(Tick deadline, Tick leeway)
+{
+  if (leeway < 2) {
+    return deadline;
+  }
+  // Round up to the largest power of two that fits in the leeway, so timers
+  // with similar deadlines share a boundary (and a wakeup).
+  Tick granularity = Tick(1) << (63 - __builtin_clzll(leeway));
+  return ((deadline + granularity - 1) / granularity) * granularity;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Tick deadline, Tick leeway, Tick interval, Callback callback)
+{
+  Entry *entry = new Entry();
+  entry->timerId = _nextTimerId++;
+  entry->deadline = deadline;
+  entry->expiry = std::max(coalescedExpiry(deadline, leeway), _now + 1);
+  entry->leeway = leeway;
+  entry->interval = interval;
+  entry->callback = std::move(callback);
+  _timers.emplace(entry->timerId, entry);
+  link(entry);
+  return entry->timerId;
+}
+
+bool TimerWheel::reschedule(TimerId timerId, Tick deadline, Tick leeway)
+{
+  auto it = _timers.find(timerId);
+  if (it == _timers.end()) {
+    return false;
+  }
+  Entry *entry = it->second;
+  Tick expiry = std::max(coalescedExpiry(deadline, leeway), _now + 1);
+  entry->deadline = deadline;
+  entry->leeway = leeway;
+  if (expiry != entry->expiry) {
+    unlink(entry);
+    entry->expiry = expiry;
+    link(entry);
+  }
+  return true;
+}
+
+bool TimerWheel::cancel(TimerId timerId)
+{
+  auto it = _timers.find(timerId);
+  if (it == _timers.end()) {
+    return false;
+  }
+  Entry *entry = it->second;
+  _timers.erase(it);
+  unlink(entry);
+  delete entry;
+  return true;
+}
+
+bool TimerWheel::contains(TimerId timerId) const
+{
+  return _timers.find(timerId) != _timers.end();
+}
+
+void TimerWheel::link(Entry *entry)
+{
+  Tick delta = entry->expiry > _now ? entry->expiry - _now : 0;
+  Tick placed = delta < kMaxSpan ? entry->expiry : _now + kMaxSpan - 1;
+  if (delta >= kMaxSpan) {
+    delta = kMaxSpan - 1;
+  }
+  int level = 0;
+  while (level + 1 < kLevelCount && delta >= (Tick(1) << (kLevelBits * (level + 1)))) {
+    level++;
+  }
+  int slot = (int)((placed >> (kLevelBits * level)) & (kSlotCount - 1));
+  entry->level = level;
+  entry->slot = slot;
+  entry->prev = nullptr;
+  entry->next = _slots[level][slot];
+  if (entry->next) {
+    entry->next->prev = entry;
+  }
+  _slots[level][slot] = entry;
+  _occupied[level] |= (uint64_t(1) << slot);
+}
+
+void TimerWheel::unlink(Entry *entry)
+{
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    _slots[entry->level][entry->slot] = entry->next;
+  }
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  }
+  if (!_slots[entry->level][entry->slot]) {
+    _occupied[entry->level] &= ~(uint64_t(1) << entry->slot);
+  }
+  entry->prev = nullptr;
+  entry->next = nullptr;
+}
+
+void TimerWheel::cascade(int level)
+{
+  int slot = (int)((_now >> (kLevelBits * level)) & (kSlotCount - 1));
+  Entry *entry = _slots[level][slot];
+  _slots[level][slot] = nullptr;
+  _occupied[level] &= ~(uint64_t(1) << slot);
+  while (entry) {
+    Entry *next = entry->next;
+    link(entry);
+    entry = next;
+  }
+}
+
+TimerWheel::Tick TimerWheel::nextEventTick() const
+{
+  Tick next = kNever;
+  int index = (int)(_now & (kSlotCount - 1));
+  uint64_t occupied = _occupied[0];
+  if (occupied) {
+    Tick base = _now - (Tick)index;
+    uint64_t ahead = occupied & bitsAbove(index);
+    next = ahead ? base + (Tick)lowestSetBit(ahead) : base + kSlotCount + (Tick)lowestSetBit(occupied);
+  }
+  for (int level = 1; level < kLevelCount; level++) {
+    occupied = _occupied[level];
+    if (!occupied) {
+      continue;
+    }
+    int shift = kLevelBits * level;
+    index = (int)((_now >> shift) & (kSlotCount - 1));
+    Tick rotation = Tick(1) << (shift + kLevelBits);
+    Tick base = (_now / rotation) * rotation;
+    uint64_t ahead = occupied & bitsAbove(index);
+    Tick cascadeTick = ahead
+      ? base + ((Tick)lowestSetBit(ahead) << shift)
+      : base + rotation + ((Tick)lowestSetBit(occupied) << shift);
+    next = std::min(next, cascadeTick);
+  }
+  return next;
+}
+
+void TimerWheel::advance(Tick now, std::vector<Callback> &fired)
+{
+  while (true) {
+    Tick next = nextEventTick();
+    if (next == kNever || next > now) {
+      break;
+    }
+    _now = next;
+    for (int level = kLevelCount - 1; level > 0; level--) {
+      if ((_now & ((Tick(1) << (kLevelBits * level)) - 1)) == 0) {
+        cascade(level);
+      }
+    }
+    int slot = (int)(_now & (kSlotCount - 1));
+    Entry *entry = _slots[0][slot];
+    _slots[0][slot] = nullptr;
+    _occupied[0] &= ~(uint64_t(1) << slot);
+    while (entry) {
+      Entry *nextEntry = entry->next;
+      if (entry->interval) {
+        fired.push_back(entry->callback);
+        // Re-arm from the nominal deadline so repeating timers don't drift,
+        // skipping periods that were missed entirely.
+        entry->deadline += entry->interval;
+        if (entry->deadline <= _now) {
+          entry->deadline = _now + entry->interval;
+        }
+        entry->expiry = std::max(coalescedExpiry(entry->deadline, entry->leeway), _now + 1);
+        link(entry);
+      } else {
+        fired.push_back(std::move(entry->callback));
+        _timers.erase(entry->timerId);
+        delete entry;
+      }
+      entry = nextEntry;
+    }
+  }
+  _now = std::max(_now, now);
+}
+
+TimerScheduler::TimerScheduler(Duration resolution)
+  : _resolution(std::max(resolution, Duration(1))), _epoch(Clock::now()) {}
+
+TimerScheduler::~TimerScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stopping = true;
+  }
+  _wakeup.notify_all();
+  if (_driver.joinable()) {
+    _driver.join();
+  }
+}
+
+TimerScheduler &TimerScheduler::shared()
+{
+  // Intentionally leaked so the driver outlives static destructors.
+  static TimerScheduler *scheduler = new TimerScheduler();
+  return *scheduler;
+}
+
+TimerWheel::Tick TimerScheduler::currentTick() const
+{
+  return (TimerWheel::Tick)((Clock::now() - _epoch) / _resolution);
+}
+
+TimerWheel::Tick TimerScheduler::ticksFor(Duration duration, bool roundUp) const
+{
+  if (duration <= Duration::zero()) {
+    return 0;
+  }
+  auto ticks = duration / _resolution;
+  if (roundUp && duration % _resolution != Duration::zero()) {
+    ticks++;
+  }
+  return (TimerWheel::Tick)ticks;
+}
+
+TimerScheduler::TimerId TimerScheduler::schedule(Duration delay, Duration leeway, Duration interval, Callback callback)
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  ensureDriverLocked();
+  TimerWheel::Tick previous = _wheel.nextEventTick();
+  TimerId timerId = _wheel.schedule(currentTick() + ticksFor(delay, true),
+                                    ticksFor(leeway, false),
+                                    ticksFor(interval, true),
+                                    std::move(callback));
+  if (_wheel.nextEventTick() < previous) {
+    _wakeup.notify_one();
+  }
+  return timerId;
+}
+
+bool TimerScheduler::reschedule(TimerId timerId, Duration delay, Duration leeway)
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  TimerWheel::Tick previous = _wheel.nextEventTick();
+  bool found = _wheel.reschedule(timerId, currentTick() + ticksFor(delay, true), ticksFor(leeway, false));
+  if (found && _wheel.nextEventTick() < previous) {
+    _wakeup.notify_one();
+  }
+  return found;
+}
+
+bool TimerScheduler::cancel(TimerId timerId)
+{
+  // A cancelled timer that was the next to fire costs one spurious wakeup at
+  // most; the driver recomputes its deadline every time it wakes.
+  std::lock_guard<std::mutex> lock(_lock);
+  return _wheel.cancel(timerId);
+}
+
+bool TimerScheduler::contains(TimerId timerId) const
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  return _wheel.contains(timerId);
+}
+
+std::size_t TimerScheduler::size() const
+{
+  std::lock_guard<std::mutex> lock(_lock);
+  return _wheel.size();
+}
+
+void TimerScheduler::ensureDriverLocked()
+{
+  if (!_driver.joinable()) {
+    _driver = std::thread([this] { run(); });
+  }
+}
+
+void TimerScheduler::run()
+{
+  std::unique_lock<std::mutex> lock(_lock);
+  std::vector<Callback> fired;
+  while (!_stopping) {
+    _wheel.advance(currentTick(), fired);
+    if (!fired.empty()) {
+      std::vector<Callback> callbacks;
+      callbacks.swap(fired);
+      lock.unlock();
+      for (auto &callback : callbacks) {
+        if (callback) {
+          callback();
+        }
+      }
+      callbacks.clear();
+      lock.lock();
+      continue;
+    }
+    TimerWheel::Tick next = _wheel.nextEventTick();
+    if (next == TimerWheel::kNever) {
+      _wakeup.wait(lock);
+    } else {
+      _wakeup.wait_until(lock, _epoch + _resolution * (int64_t)next);
+    }
+  }
+}
+
+} // namespace mp
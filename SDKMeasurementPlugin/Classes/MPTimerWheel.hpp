@@ -0,0 +1,147 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mp {
+
+/**
+ * Hierarchical timing wheel: 4 levels of 64 slots each, measured in ticks.
+ * Insert and cancel are O(1); advancing skips empty slots using per-level
+ * occupancy bitmaps. Not thread-safe, see TimerScheduler for the threaded
+ * front end.
+ */
+class TimerWheel {
+ public:
+  using TimerId = uint64_t;
+  using Tick = uint64_t;
+  using Callback = std::function<void()>;
+
+  static constexpr int kLevelBits = 6;
+  static constexpr int kLevelCount = 4;
+  static constexpr Tick kSlotCount = Tick(1) << kLevelBits;
+  static constexpr Tick kMaxSpan = Tick(1) << (kLevelBits * kLevelCount);
+  static constexpr Tick kNever = UINT64_MAX;
+
+  explicit TimerWheel(Tick now = 0);
+  ~TimerWheel();
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  // Fires no earlier than `deadline` and no later than `deadline + leeway`.
+  // Timers whose windows overlap on a coarse boundary are coalesced into the
+  // same slot. A non-zero `interval` re-arms the timer after each firing.
+  TimerId schedule(Tick deadline, Tick leeway, Tick interval, Callback callback);
+  // Moves a pending timer to a new deadline, keeping its callback.
+  bool reschedule(TimerId timerId, Tick deadline, Tick leeway);
+  bool cancel(TimerId timerId);
+  bool contains(TimerId timerId) const;
+
+  // Advances to `now` and appends the callbacks of every expired timer to
+  // `fired`, in expiry order.
+  void advance(Tick now, std::vector<Callback> &fired);
+
+  // The next tick at which advance() has work to do, or kNever.
+  Tick nextEventTick() const;
+
+  Tick now() const
+  {
+    return _now;
+  }
+
+  std::size_t size() const
+  {
+    return _timers.size();
+  }
+
+ private:
+  struct Entry {
+    TimerId timerId;
+    Tick deadline;
+    Tick expiry;
+    Tick leeway;
+    Tick interval;
+    Callback callback;
+    Entry *prev;
+    Entry *next;
+    int level;
+    int slot;
+  };
+
+  static Tick coalescedExpiry(Tick deadline, Tick leeway);
+  void link(Entry *entry);
+  void unlink(Entry *entry);
+  void cascade(int level);
+
+  Tick _now;
+  TimerId _nextTimerId = 1;
+  Entry *_slots[kLevelCount][kSlotCount] = {};
+  uint64_t _occupied[kLevelCount] = {};
+  std::unordered_map<TimerId, Entry *> _timers;
+};
+
+/**
+ * Runs a TimerWheel on a single driver thread against the steady clock.
+ * Callbacks run on the driver thread with no lock held and must be short;
+ * MPTimer uses them only to hop onto its dispatch queue.
+ */
+class TimerScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Duration = std::chrono::nanoseconds;
+  using TimerId = TimerWheel::TimerId;
+  using Callback = TimerWheel::Callback;
+
+  explicit TimerScheduler(Duration resolution = std::chrono::milliseconds(1));
+  ~TimerScheduler();
+  TimerScheduler(const TimerScheduler &) = delete;
+  TimerScheduler &operator=(const TimerScheduler &) = delete;
+
+  static TimerScheduler &shared();
+
+  TimerId schedule(Duration delay, Duration leeway, Duration interval, Callback callback);
+  bool reschedule(TimerId timerId, Duration delay, Duration leeway);
+  bool cancel(TimerId timerId);
+  bool contains(TimerId timerId) const;
+  std::size_t size() const;
+
+ private:
+  TimerWheel::Tick currentTick() const;
+  TimerWheel::Tick ticksFor(Duration duration, bool roundUp) const;
+  void ensureDriverLocked();
+  void run();
+
+  const Duration _resolution;
+  const Clock::time_point _epoch;
+  mutable std::mutex _lock;
+  std::condition_variable _wakeup;
+  TimerWheel _wheel;
+  std::thread _driver;
+  bool _stopping = false;
+};
+
+} // namespace mp
@@ -0,0 +1,187 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "MPURLEncoding.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MP_URL_ENCODING_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MP_URL_ENCODING_NEON 1
+#endif
+
+namespace {
+
+constexpr std::size_t kBlockSize = 16;
+
+const char kHexDigits[] = "0123456789ABCDEF";
+
+// Maps each byte to its single-byte encoding, or 0 when it must be escaped.
+struct URLEncodingTable {
+  uint8_t passthrough[256];
+
+  constexpr URLEncodingTable() : passthrough()
+  {
+    for (int c = 0; c < 256; c++) {
+      if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+          c == '.' || c == '-' || c == '_' || c == '~') {
+        passthrough[c] = (uint8_t)c;
+      } else if (c == ' ') {
+        passthrough[c] = '+';
+      }
+    }
+  }
+};
+
+constexpr URLEncodingTable kTable;
+
+inline std::size_t encodedLengthScalar(const uint8_t *bytes, std::size_t length)
+{
+  std::size_t result = 0;
+  for (std::size_t i = 0; i < length; i++) {
+    result += kTable.passthrough[bytes[i]] ? 1 : 3;
+  }
+  return result;
+}
+
+inline char *encodeScalar(const uint8_t *bytes, std::size_t length, char *out)
+{
+  for (std::size_t i = 0; i < length; i++) {
+    const uint8_t c = bytes[i];
+    const uint8_t single = kTable.passthrough[c];
+    if (single) {
+      *out++ = (char)single;
+    } else {
+      out[0] = '%';
+      out[1] = kHexDigits[c >> 4];
+      out[2] = kHexDigits[c & 0xF];
+      out += 3;
+    }
+  }
+  return out;
+}
+
+#if MP_URL_ENCODING_SSE2
+
+// Unsigned lo <= x <= hi, per byte.
+inline __m128i inRange(__m128i x, uint8_t lo, uint8_t hi)
+{
+  const __m128i offset = _mm_sub_epi8(x, _mm_set1_epi8((char)lo));
+  return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8((char)(hi - lo))), offset);
+}
+
+inline __m128i unreservedMask(__m128i x)
+{
+  const __m128i letters = inRange(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z');
+  const __m128i digits = inRange(x, '0', '9');
+  const __m128i marks = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('.')),
+                                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('-'))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('_')),
+                                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('~'))));
+  return _mm_or_si128(_mm_or_si128(letters, digits), marks);
+}
+
+#elif MP_URL_ENCODING_NEON
+
+inline uint8x16_t inRange(uint8x16_t x, uint8_t lo, uint8_t hi)
+{
+  return vcleq_u8(vsubq_u8(x, vdupq_n_u8(lo)), vdupq_n_u8((uint8_t)(hi - lo)));
+}
+
+inline uint8x16_t unreservedMask(uint8x16_t x)
+{
+  const uint8x16_t letters = inRange(vorrq_u8(x, vdupq_n_u8(0x20)), 'a', 'z');
+  const uint8x16_t digits = inRange(x, '0', '9');
+  const uint8x16_t marks = vorrq_u8(vorrq_u8(vceqq_u8(x, vdupq_n_u8('.')), vceqq_u8(x, vdupq_n_u8('-'))),
+                                    vorrq_u8(vceqq_u8(x, vdupq_n_u8('_')), vceqq_u8(x, vdupq_n_u8('~'))));
+  return vorrq_u8(vorrq_u8(letters, digits), marks);
+}
+
+#endif
+
+} // namespace
+
+size_t FBURLEncodedLength(const char *bytes, size_t length)
+{
+  const uint8_t *input = (const uint8_t *)bytes;
+  std::size_t result = 0;
+  std::size_t i = 0;
+#if MP_URL_ENCODING_SSE2
+  const __m128i space = _mm_set1_epi8(' ');
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const __m128i x = _mm_loadu_si128((const __m128i *)(input + i));
+    const __m128i single = _mm_or_si128(unreservedMask(x), _mm_cmpeq_epi8(x, space));
+    const int escaped = (int)kBlockSize - __builtin_popcount((unsigned)_mm_movemask_epi8(single));
+    result += kBlockSize + 2 * (std::size_t)escaped;
+  }
+#elif MP_URL_ENCODING_NEON
+  const uint8x16_t space = vdupq_n_u8(' ');
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const uint8x16_t x = vld1q_u8(input + i);
+    const uint8x16_t single = vorrq_u8(unreservedMask(x), vceqq_u8(x, space));
+    const unsigned escaped = kBlockSize - vaddvq_u8(vandq_u8(single, vdupq_n_u8(1)));
+    result += kBlockSize + 2 * (std::size_t)escaped;
+  }
+#endif
+  return result + encodedLengthScalar(input + i, length - i);
+}
+
+size_t FBURLEncode(const char *bytes, size_t length, char *output)
+{
+  const uint8_t *input = (const uint8_t *)bytes;
+  char *out = output;
+  std::size_t i = 0;
+  // Blocks made only of single-byte characters are copied 16 at a time with
+  // ' ' swapped for '+'; any block with an escape goes through the table.
+#if MP_URL_ENCODING_SSE2
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i plus = _mm_set1_epi8('+');
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const __m128i x = _mm_loadu_si128((const __m128i *)(input + i));
+    const __m128i spaces = _mm_cmpeq_epi8(x, space);
+    const __m128i single = _mm_or_si128(unreservedMask(x), spaces);
+    if (_mm_movemask_epi8(single) == 0xFFFF) {
+      const __m128i encoded = _mm_or_si128(_mm_andnot_si128(spaces, x), _mm_and_si128(spaces, plus));
+      _mm_storeu_si128((__m128i *)out, encoded);
+      out += kBlockSize;
+    } else {
+      out = encodeScalar(input + i, kBlockSize, out);
+    }
+  }
+#elif MP_URL_ENCODING_NEON
+  const uint8x16_t space = vdupq_n_u8(' ');
+  const uint8x16_t plus = vdupq_n_u8('+');
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const uint8x16_t x = vld1q_u8(input + i);
+    const uint8x16_t spaces = vceqq_u8(x, space);
+    const uint8x16_t single = vorrq_u8(unreservedMask(x), spaces);
+    if (vminvq_u8(single) == 0xFF) {
+      vst1q_u8((uint8_t *)out, vbslq_u8(spaces, plus, x));
+      out += kBlockSize;
+    } else {
+      out = encodeScalar(input + i, kBlockSize, out);
+    }
+  }
+#endif
+  out = encodeScalar(input + i, length - i, out);
+  return (size_t)(out - output);
+}
@@ -0,0 +1,49 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>
+
+// Plain C and standard headers only, so the encoder builds outside the pod
+// with any compiler.
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * application/x-www-form-urlencoded percent-encoding.
+ * Unreserved characters (ALPHA / DIGIT / "-" / "." / "_" / "~") pass through,
+ * ' ' becomes '+', every other byte becomes %XX with uppercase hex digits.
+ */
+
+/**
+ * return the exact number of bytes FBURLEncode will write for `length` input bytes.
+ */
+size_t FBURLEncodedLength(const char *bytes, size_t length);
+
+/**
+ * percent-encode `length` bytes into `output`, which must have room for
+ * FBURLEncodedLength(bytes, length) bytes (3 * length always suffices).
+ * The output is not NUL-terminated. Returns the number of bytes written.
+ */
+size_t FBURLEncode(const char *bytes, size_t length, char *output);
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,19 +20,20 @@
 
 #import "MPConcurrentQueue.h"
 #import "MPConfigManager.h"
-#import "MPTimer.h"
+#import "MPPayloadEncoder.h"
 #import "MPUtility.h"
 #import "MPUtilityFunctions.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 static NSTimeInterval kMPURLSessionTimeoutDelivery = 10.0;
+static NSTimeInterval kMPURLSessionUserAgentRetryDelay = 1.0;
 
 @interface MPURLSession () <NSURLSessionDelegate, NSURLSessionDataDelegate>
 
-@property (nonatomic, strong) NSURLSession *session;
+@property (atomic, strong, nullable) NSURLSession *session;
 @property (nonatomic, strong) MPConcurrentQueue<dispatch_block_t> *queue;
-@property (nonatomic, strong, nullable) MPTimer *userAgentTimer;
+@property (atomic, assign) BOOL userAgentRequested;
 
 @end
 
@@ -71,31 +72,31 @@ static NSTimeInterval kMPURLSessionTimeoutDelivery = 10.0;
 
 + (void)updateSession:(MPURLSession *)adSession
 {
-  // Keep querying for the user agent, it might not be available when we want it
-  // Until we get the user agent, queue up network requests
-  NSURLSessionConfiguration *configuration = [self defaultConfiguration];
+  // Until we get the user agent, queue up network requests. The user agent
+  // resolves once and releases everything queued at the same time.
+  @synchronized(adSession) {
+    if (adSession.valid || adSession.userAgentRequested) {
+      return;
+    }
+    adSession.userAgentRequested = YES;
+  }
   
-  adSession.userAgentTimer = [MPTimer scheduledTimerWithTimeInterval:(NSTimeInterval)0.1
-                                                               repeats:YES
-                                                                 queue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0)
-                                                                 block:^(MPTimer *timer) {
-                                                                   [MPUtility currentUserAgentWithBlock:^(NSString * __nullable userAgent) {
-                                                                     NSMutableDictionary<NSString *, NSString *> *extraHeaders = configuration.HTTPAdditionalHeaders ? [[NSMutableDictionary alloc] initWithDictionary:MPUnwrap(configuration.HTTPAdditionalHeaders)] : [[NSMutableDictionary alloc] init];
-                                                                     if ([MPConfigManager sharedManager].isDeviceIDBasedRoutingEnabled) {
-                                                                       extraHeaders[@"X-FB-Pool-Routing-Token"] = [MPUtility getAdvertisingIdentifier];
-                                                                     }
-                                                                     if (userAgent && userAgent.length > 0) {
-                                                                       extraHeaders[@"User-Agent"] = MPUnwrap(userAgent);
-                                                                       configuration.HTTPAdditionalHeaders = extraHeaders;
-                                                                       adSession.session = [NSURLSession sessionWithConfiguration:configuration delegate:adSession delegateQueue:nil];
-                                                                       [adSession emptyQueue];
-                                                                       [timer invalidate];
-                                                                       adSession.userAgentTimer = nil;
-                                                                     } else {
-                                                                       configuration.HTTPAdditionalHeaders = extraHeaders;
-                                                                     }
-                                                                   }];
-                                                                 }];
+  [MPUtility currentUserAgentWithBlock:^(NSString * __nullable userAgent) {
+    if (userAgent.length == 0) {
+      adSession.userAgentRequested = NO;
+      dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kMPURLSessionUserAgentRetryDelay * NSEC_PER_SEC)),
+                     dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+                       [self updateSession:adSession];
+                     });
+      return;
+    }
+    NSURLSessionConfiguration *configuration = [self defaultConfiguration];
+    NSMutableDictionary<NSString *, NSString *> *extraHeaders = configuration.HTTPAdditionalHeaders ? [[NSMutableDictionary alloc] initWithDictionary:MPUnwrap(configuration.HTTPAdditionalHeaders)] : [[NSMutableDictionary alloc] init];
+    extraHeaders[@"User-Agent"] = MPUnwrap(userAgent);
+    configuration.HTTPAdditionalHeaders = extraHeaders;
+    adSession.session = [NSURLSession sessionWithConfiguration:configuration delegate:adSession delegateQueue:nil];
+    [adSession emptyQueue];
+  }];
 }
 
 - (BOOL)valid
@@ -112,20 +113,21 @@ static NSTimeInterval kMPURLSessionTimeoutDelivery = 10.0;
     [self emptyQueue];
     block();
   } else {
-    [self.class updateSession:self];
     [self.queue pushObject:block];
+    // The session may have become valid after the check above; drain so the
+    // block is not stranded.
+    [self emptyQueue];
   }
 }
 
 - (void)emptyQueue
 {
   if (self.valid) {
-    MPConcurrentQueue *queue = self.queue;
-    [queue popAll:^(NSEnumerator *enumerator) {
-      for (dispatch_block_t block in enumerator) {
-        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), block);
-      }
-    }];
+    // The drain is synchronous, so requests queued before this call are
+    // dispatched ahead of whatever the caller runs next.
+    for (dispatch_block_t block in [self.queue popAllObjects]) {
+      dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), block);
+    }
   } else {
     [self.class updateSession:self];
   }
@@ -199,7 +201,7 @@ static NSTimeInterval kMPURLSessionTimeoutDelivery = 10.0;
 {
   NSMutableURLRequest *urlRequest = [NSMutableURLRequest new];
   
-  NSString *queryString = [MPUtility createQueryStringFromParameters:[queryParameters copy]];
+  NSData *queryData = [MPPayloadEncoder formEncodedDataFromParameters:[queryParameters copy]];
   
   // Default HTTPMethod method
   if (HTTPMethod == nil) {
@@ -213,14 +215,15 @@ static NSTimeInterval kMPURLSessionTimeoutDelivery = 10.0;
     urlRequest.URL = url;
     
     [urlRequest setValue:@"application/x-www-form-urlencoded" forHTTPHeaderField:@"Content-Type"];
-    urlRequest.HTTPBody = [queryString dataUsingEncoding:NSUTF8StringEncoding];
+    urlRequest.HTTPBody = queryData;
     
     // GET implementation
   } else if ([HTTPMethod isEqualToString:@"GET"]) {
     
     NSURL *getUrl = url;
     
-    if (queryString.length > 0) {
+    if (queryData.length > 0) {
+      NSString *queryString = [[NSString alloc] initWithData:queryData encoding:NSASCIIStringEncoding] ?: @"";
       
       NSMutableString *urlString = [[NSMutableString alloc] initWithString:@""];
       
@@ -0,0 +1,200 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "MPUUID.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MP_UUID_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define MP_UUID_SSSE3 1
+#endif
+
+namespace {
+
+constexpr uint64_t kGoldenGamma = 0x9E3779B97F4A7C15ull;
+
+uint64_t mix64(uint64_t z)
+{
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+uint64_t initialSeed()
+{
+  std::random_device device;
+  uint64_t seed = ((uint64_t)device() << 32) ^ (uint64_t)device();
+  return seed ^ mix64((uint64_t)std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+// SplitMix64: each fetch_add claims a distinct point of the sequence, so
+// concurrent callers never see the same value and never block each other.
+std::atomic<uint64_t> gRandomState(initialSeed());
+
+uint64_t nextRandom()
+{
+  return mix64(gRandomState.fetch_add(kGoldenGamma, std::memory_order_relaxed) + kGoldenGamma);
+}
+
+// Last issued v7 (milliseconds << 12 | sequence).
+std::atomic<uint64_t> gTimeOrderedState(0);
+
+const char kHexDigits[] = "0123456789ABCDEF";
+
+struct HexNibbleTable {
+  uint8_t values[256];
+
+  constexpr HexNibbleTable() : values()
+  {
+    for (int c = 0; c < 256; c++) {
+      values[c] = 0xFF;
+    }
+    for (int c = '0'; c <= '9'; c++) {
+      values[c] = (uint8_t)(c - '0');
+    }
+    for (int c = 'A'; c <= 'F'; c++) {
+      values[c] = (uint8_t)(c - 'A' + 10);
+      values[c + ('a' - 'A')] = (uint8_t)(c - 'A' + 10);
+    }
+  }
+};
+
+constexpr HexNibbleTable kHexNibbles;
+
+// Bytes -> 32 hex digits.
+void hexEncode(const uint8_t bytes[16], char hex[32])
+{
+#if MP_UUID_NEON
+  const uint8x16_t input = vld1q_u8(bytes);
+  const uint8x16_t table = vld1q_u8((const uint8_t *)kHexDigits);
+  const uint8x16_t high = vqtbl1q_u8(table, vshrq_n_u8(input, 4));
+  const uint8x16_t low = vqtbl1q_u8(table, vandq_u8(input, vdupq_n_u8(0x0F)));
+  vst1q_u8((uint8_t *)hex, vzip1q_u8(high, low));
+  vst1q_u8((uint8_t *)hex + 16, vzip2q_u8(high, low));
+#elif MP_UUID_SSSE3
+  const __m128i input = _mm_loadu_si128((const __m128i *)bytes);
+  const __m128i table = _mm_loadu_si128((const __m128i *)kHexDigits);
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  const __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(input, 4), mask));
+  const __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(input, mask));
+  _mm_storeu_si128((__m128i *)hex, _mm_unpacklo_epi8(high, low));
+  _mm_storeu_si128((__m128i *)(hex + 16), _mm_unpackhi_epi8(high, low));
+#else
+  for (int i = 0; i < 16; i++) {
+    hex[2 * i] = kHexDigits[bytes[i] >> 4];
+    hex[2 * i + 1] = kHexDigits[bytes[i] & 0x0F];
+  }
+#endif
+}
+
+} // namespace
+
+MPUUID MPUUIDFromBytes(const uint8_t bytes[16])
+{
+  MPUUID uuid = {0, 0};
+  for (int i = 0; i < 8; i++) {
+    uuid.high = (uuid.high << 8) | bytes[i];
+    uuid.low = (uuid.low << 8) | bytes[i + 8];
+  }
+  return uuid;
+}
+
+void MPUUIDGetBytes(MPUUID uuid, uint8_t bytes[16])
+{
+  for (int i = 7; i >= 0; i--) {
+    bytes[i] = (uint8_t)uuid.high;
+    bytes[i + 8] = (uint8_t)uuid.low;
+    uuid.high >>= 8;
+    uuid.low >>= 8;
+  }
+}
+
+MPUUID MPUUIDGenerateV4(void)
+{
+  MPUUID uuid;
+  uuid.high = (nextRandom() & ~0xF000ull) | 0x4000ull;
+  uuid.low = (nextRandom() & ~(0xC0ull << 56)) | (0x80ull << 56);
+  return uuid;
+}
+
+MPUUID MPUUIDGenerateV7(uint64_t unixMilliseconds)
+{
+  const uint64_t floor = (unixMilliseconds & 0xFFFFFFFFFFFFull) << 12;
+  uint64_t previous = gTimeOrderedState.load(std::memory_order_relaxed);
+  uint64_t next;
+  do {
+    next = floor > previous ? floor : previous + 1;
+  } while (!gTimeOrderedState.compare_exchange_weak(previous, next, std::memory_order_relaxed));
+  MPUUID uuid;
+  uuid.high = ((next >> 12) << 16) | 0x7000ull | (next & 0xFFFull);
+  uuid.low = (nextRandom() & ~(0xC0ull << 56)) | (0x80ull << 56);
+  return uuid;
+}
+
+void MPUUIDFormat(MPUUID uuid, char output[MPUUIDStringLength + 1])
+{
+  uint8_t bytes[16];
+  char hex[32];
+  MPUUIDGetBytes(uuid, bytes);
+  hexEncode(bytes, hex);
+  std::memcpy(output, hex, 8);
+  output[8] = '-';
+  std::memcpy(output + 9, hex + 8, 4);
+  output[13] = '-';
+  std::memcpy(output + 14, hex + 12, 4);
+  output[18] = '-';
+  std::memcpy(output + 19, hex + 16, 4);
+  output[23] = '-';
+  std::memcpy(output + 24, hex + 20, 12);
+  output[MPUUIDStringLength] = '\0';
+}
+
+bool MPUUIDParse(const char *text, size_t length, MPUUID *output)
+{
+  if (!text || length != MPUUIDStringLength || text[8] != '-' || text[13] != '-' || text[18] != '-' ||
+      text[23] != '-') {
+    return false;
+  }
+  uint64_t halves[2] = {0, 0};
+  int digits = 0;
+  uint8_t invalid = 0;
+  for (size_t i = 0; i < MPUUIDStringLength; i++) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      continue;
+    }
+    const uint8_t nibble = kHexNibbles.values[(uint8_t)text[i]];
+    // Accumulate the error instead of branching on every digit.
+    invalid |= nibble;
+    uint64_t &half = halves[digits >> 4];
+    half = (half << 4) | (nibble & 0x0F);
+    digits++;
+  }
+  if (invalid & 0xF0) {
+    return false;
+  }
+  output->high = halves[0];
+  output->low = halves[1];
+  return true;
+}
@@ -0,0 +1,117 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __OBJC__
+#import <Foundation/Foundation.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 128-bit UUID as a plain value. `high` holds bytes 0-7 and `low` bytes 8-15,
+ * both most significant byte first, so (high, low) order matches the order of
+ * the formatted strings.
+ */
+typedef struct MPUUID {
+  uint64_t high;
+  uint64_t low;
+} MPUUID;
+
+#define MPUUIDStringLength 36
+
+/**
+ * return a random (version 4) UUID.
+ * Lock-free and allocation-free. The bits come from a seeded SplitMix64
+ * sequence, not a CSPRNG: fine for identifiers, not for secrets.
+ */
+MPUUID MPUUIDGenerateV4(void);
+
+/**
+ * return a time-ordered (version 7) UUID for the given Unix time.
+ * Layout: 48-bit milliseconds, version, 12-bit sequence, variant, 62 random
+ * bits. The sequence restarts each millisecond and carries into the
+ * timestamp when it overflows or the clock steps back, so ids from one
+ * process are strictly increasing in both byte and string order.
+ */
+MPUUID MPUUIDGenerateV7(uint64_t unixMilliseconds);
+
+MPUUID MPUUIDFromBytes(const uint8_t bytes[16]);
+void MPUUIDGetBytes(MPUUID uuid, uint8_t bytes[16]);
+
+/**
+ * write the canonical uppercase form, as -[NSUUID UUIDString] does, followed
+ * by a NUL terminator.
+ */
+void MPUUIDFormat(MPUUID uuid, char output[MPUUIDStringLength + 1]);
+
+/**
+ * parse the canonical 8-4-4-4-12 form, in either case.
+ * Returns false and leaves `output` untouched on malformed input.
+ */
+bool MPUUIDParse(const char *text, size_t length, MPUUID *output);
+
+static inline bool MPUUIDIsNil(MPUUID uuid)
+{
+  return uuid.high == 0 && uuid.low == 0;
+}
+
+static inline bool MPUUIDEqualToUUID(MPUUID a, MPUUID b)
+{
+  return a.high == b.high && a.low == b.low;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __OBJC__
+
+NS_ASSUME_NONNULL_BEGIN
+
+NS_INLINE MPUUID MPUUIDFromNSUUID(NSUUID *uuid)
+{
+  uuid_t bytes;
+  [uuid getUUIDBytes:bytes];
+  return MPUUIDFromBytes(bytes);
+}
+
+NS_INLINE NSUUID *MPUUIDToNSUUID(MPUUID uuid)
+{
+  uuid_t bytes;
+  MPUUIDGetBytes(uuid, bytes);
+  return [[NSUUID alloc] initWithUUIDBytes:bytes];
+}
+
+NS_INLINE NSString *MPUUIDToString(MPUUID uuid)
+{
+  char text[MPUUIDStringLength + 1];
+  MPUUIDFormat(uuid, text);
+  return (NSString *)[[NSString alloc] initWithBytes:text length:MPUUIDStringLength encoding:NSASCIIStringEncoding];
+}
+
+NS_ASSUME_NONNULL_END
+
+#endif
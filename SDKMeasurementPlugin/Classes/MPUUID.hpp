@@ -0,0 +1,56 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+#include "MPUUID.h"
+
+inline bool operator==(const MPUUID &a, const MPUUID &b)
+{
+  return MPUUIDEqualToUUID(a, b);
+}
+
+inline bool operator!=(const MPUUID &a, const MPUUID &b)
+{
+  return !MPUUIDEqualToUUID(a, b);
+}
+
+inline bool operator<(const MPUUID &a, const MPUUID &b)
+{
+  return a.high < b.high || (a.high == b.high && a.low < b.low);
+}
+
+namespace mp {
+
+/**
+ * Hash for MPUUID keys. Both halves are mixed: time-ordered UUIDs share most
+ * of their high bits, so neither half alone is a good hash.
+ */
+struct UUIDHash {
+  std::size_t operator()(const MPUUID &uuid) const
+  {
+    uint64_t z = uuid.high ^ (uuid.low * 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (std::size_t)(z ^ (z >> 31));
+  }
+};
+
+} // namespace mp
@@ -0,0 +1,114 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace mp {
+
+/**
+ * Weighted histogram of values in [0, 1]: constant memory, O(1) add, and an
+ * exact merge(), so per-window histograms can be combined later.
+ *
+ * 0 and 1 get buckets of their own since fully hidden / fully visible (and
+ * muted / full volume) dominate real data; (0, 1) is split into kRangeBuckets
+ * equal ranges, and quantiles interpolate linearly inside a range.
+ */
+class UnitHistogram {
+ public:
+  static constexpr std::size_t kRangeBuckets = 20;
+  static constexpr std::size_t kBucketCount = kRangeBuckets + 2;
+
+  void add(double value, double weight)
+  {
+    if (weight > 0) {
+      _weights[bucketForValue(value)] += weight;
+      _total += weight;
+    }
+  }
+
+  void merge(const UnitHistogram &other)
+  {
+    for (std::size_t i = 0; i < kBucketCount; i++) {
+      _weights[i] += other._weights[i];
+    }
+    _total += other._total;
+  }
+
+  void reset()
+  {
+    _weights.fill(0);
+    _total = 0;
+  }
+
+  double total() const
+  {
+    return _total;
+  }
+
+  double weight(std::size_t bucket) const
+  {
+    return _weights[bucket];
+  }
+
+  // q in [0, 1]; 0 when empty.
+  double quantile(double q) const
+  {
+    if (_total <= 0) {
+      return 0;
+    }
+    const double target = (q <= 0 ? 0 : q >= 1 ? 1 : q) * _total;
+    double cumulative = 0;
+    for (std::size_t i = 0; i < kBucketCount; i++) {
+      const double weight = _weights[i];
+      if (weight <= 0 || cumulative + weight < target) {
+        cumulative += weight;
+        continue;
+      }
+      if (i == 0) {
+        return 0;
+      }
+      if (i == kBucketCount - 1) {
+        return 1;
+      }
+      const double width = 1.0 / kRangeBuckets;
+      return (i - 1) * width + (target - cumulative) / weight * width;
+    }
+    return 1;
+  }
+
+ private:
+  static std::size_t bucketForValue(double value)
+  {
+    if (!(value > 0)) {
+      return 0;
+    }
+    if (value >= 1) {
+      return kBucketCount - 1;
+    }
+    const std::size_t range = (std::size_t)(value * kRangeBuckets);
+    return 1 + (range < kRangeBuckets ? range : kRangeBuckets - 1);
+  }
+
+  std::array<double, kBucketCount> _weights{};
+  double _total = 0;
+};
+
+} // namespace mp
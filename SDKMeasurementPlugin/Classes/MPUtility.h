@@ -85,7 +85,6 @@ FB_SUBCLASSING_RESTRICTED
 + (NSDictionary<NSString *, NSString *> *)parseQueryString:(NSURL *)url;
 + (NSDictionary<NSString *, NSString *> *)parseQuery:(NSString *)query;
 
-+ (NSString *)createQueryParameterFromKey:(id)key object:(id)obj;
 + (NSString *)createQueryStringFromParameters:(NSDictionary *)parameters;
 
 + (NSString *)currentLocale;
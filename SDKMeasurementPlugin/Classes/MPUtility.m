@@ -32,8 +32,10 @@
 #import "MPEventManager.h"
 #import "MPLogger.h"
 #import "MPNotificationCenter.h"
+#import "MPPayloadEncoder.h"
 #import "MPScreen.h"
 #import "MPSettings+Internal.h"
+#import "MPURLEncoding.h"
 #import "MPURLSession.h"
 #import "MPUtilityFunctions.h"
 #import "MPVideoURLWrapper.h"
@@ -146,44 +148,14 @@ FB_FINAL_CLASS(objc_getClass("MPUtility"));
                                      forKeys:keys];
 }
 
-+ (NSString *)createQueryParameterFromKey:(id)key object:(id)obj
-{
-  return [NSString stringWithFormat:@"%@=%@",
-          [key fb_URLEncodedString],
-          [[MPUtility attemptRecoveryOfObject:obj ofClass:[NSString class]] fb_URLEncodedString]];
-}
-
 + (NSString *)createQueryStringFromParameters:(NSDictionary *)parameters
 {
-  __block NSMutableString *paramsString = [NSMutableString stringWithString:@""];
-  
-  if (parameters != nil) {
-    [parameters enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *parametersStop) {
-      
-      if ([obj isKindOfClass:[NSArray class]] || [obj isKindOfClass:[NSMutableArray class]]) {
-        
-        [(NSArray *)obj enumerateObjectsUsingBlock:^(id arrayObj, NSUInteger idx, BOOL *objStop) {
-          
-          if (paramsString.length > 0) {
-            [paramsString appendString:@"&"];
-          }
-          
-          [paramsString appendString:[self createQueryParameterFromKey:[NSString stringWithFormat:@"%@[]", key] object:arrayObj]];
-        }];
-        
-      } else {
-        
-        if (paramsString.length > 0) {
-          [paramsString appendString:@"&"];
-        }
-        
-        [paramsString appendString:[self createQueryParameterFromKey:key object:obj]];
-      }
-    }];
+  if (parameters == nil) {
+    return @"";
   }
-  
-  // Create and return the final query string composed from the parameters string
-  return [NSString stringWithString:paramsString];
+  // Form-encoded output is pure ASCII
+  NSData *data = [MPPayloadEncoder formEncodedDataFromParameters:parameters];
+  return [[NSString alloc] initWithData:data encoding:NSASCIIStringEncoding] ?: @"";
 }
 
 + (NSString *)currentLocale
@@ -192,16 +164,45 @@ FB_FINAL_CLASS(objc_getClass("MPUtility"));
   return  locale ?: @"en_US";
 }
 
+// The user agent is a promise: it resolves once, and every caller that asked
+// before then is queued and released together.
+static NSString *MPResolvedUserAgent = nil;
+static NSMutableArray<void (^)(NSString * __nullable)> *MPPendingUserAgentBlocks = nil;
+static BOOL MPUserAgentResolving = NO;
+
 + (void)currentUserAgentWithBlock:(void (^)(NSString * __nullable userAgent))userAgentBlock {
-  static NSString *userAgent = nil;
-  if (userAgent) {
-    if (userAgentBlock) {
-      userAgentBlock(userAgent);
+  NSString *userAgent = nil;
+  BOOL shouldResolve = NO;
+  @synchronized(self) {
+    userAgent = MPResolvedUserAgent;
+    if (!userAgent) {
+      if (userAgentBlock) {
+        if (!MPPendingUserAgentBlocks) {
+          MPPendingUserAgentBlocks = [NSMutableArray array];
+        }
+        [MPPendingUserAgentBlocks addObject:[userAgentBlock copy]];
+      }
+      shouldResolve = !MPUserAgentResolving;
+      MPUserAgentResolving = YES;
     }
+  }
+  if (userAgent) {
+    FB_BLOCK_CALL_SAFE(userAgentBlock, userAgent);
     return;
   }
-  static dispatch_once_t onceToken = 0;
-  fb_dispatch_once_on_main_thread(&onceToken, ^{
+  if (!shouldResolve) {
+    return;
+  }
+  
+  // The WebKit user agent only changes with the OS, so cold starts can skip
+  // the web view round-trip entirely.
+  NSString *cachedSystemUserAgent = [self cachedSystemUserAgent];
+  if (cachedSystemUserAgent) {
+    [self resolveUserAgentWithSystemUserAgent:cachedSystemUserAgent];
+    return;
+  }
+  
+  dispatch_async(dispatch_get_main_queue(), ^{
     static id webView = nil;
     NSString *userAgentJavascript = fb_javascript_safe_create(@"return navigator.userAgent");
     // Sarunas
@@ -210,31 +211,65 @@ FB_FINAL_CLASS(objc_getClass("MPUtility"));
       webView = [wkWebViewClass new];
       [webView setHidden:YES];
       [webView evaluateJavaScript:userAgentJavascript completionHandler:^(id __nullable obj, NSError * __nullable error) {
-        NSString *systemUserAgent = obj;
-        if (![systemUserAgent isKindOfClass:[NSString class]]) {
-          if (userAgentBlock) {
-            userAgentBlock(nil);
-          }
-          return;
-        }
-        userAgent = [self generateUserAgentStringFromRawString:systemUserAgent];
-        if (userAgentBlock) {
-          userAgentBlock(userAgent);
-        }
+        NSString *systemUserAgent = [obj isKindOfClass:[NSString class]] ? obj : nil;
+        [self resolveUserAgentWithSystemUserAgent:systemUserAgent];
         webView = nil;
       }];
     } else {
       webView = [NSClassFromString(@"UIWebView") new];
       [webView setHidden:YES];
       NSString *systemUserAgent = [webView stringByEvaluatingJavaScriptFromString:userAgentJavascript];
-      userAgent = [self generateUserAgentStringFromRawString:systemUserAgent];
-      if (userAgentBlock) {
-        userAgentBlock(userAgent);
-      }
+      [self resolveUserAgentWithSystemUserAgent:systemUserAgent];
+      webView = nil;
     }
   });
 }
 
+// A nil system user agent fails everyone currently waiting; the next request retries.
++ (void)resolveUserAgentWithSystemUserAgent:(nullable NSString *)systemUserAgent
+{
+  NSString *userAgent = systemUserAgent.length > 0 ? [self generateUserAgentStringFromRawString:MPUnwrap(systemUserAgent)] : nil;
+  if (userAgent) {
+    [self cacheSystemUserAgent:MPUnwrap(systemUserAgent)];
+  }
+  NSArray<void (^)(NSString * __nullable)> *pendingBlocks = nil;
+  @synchronized(self) {
+    MPResolvedUserAgent = userAgent;
+    MPUserAgentResolving = NO;
+    pendingBlocks = [MPPendingUserAgentBlocks copy];
+    [MPPendingUserAgentBlocks removeAllObjects];
+  }
+  for (void (^block)(NSString * __nullable) in pendingBlocks) {
+    block(userAgent);
+  }
+}
+
++ (nullable NSString *)cachedSystemUserAgent
+{
+  NSDictionary *cache = [[NSUserDefaults standardUserDefaults] dictionaryForKey:FB_AN_SYSTEM_USER_AGENT];
+  NSString *systemVersion = [cache stringForKeyOrNil:@"system_version"];
+  NSString *machine = [cache stringForKeyOrNil:@"machine"];
+  if (![systemVersion isEqualToString:[MPDevice systemVersion]] || ![machine isEqualToString:[MPDevice machine]]) {
+    return nil;
+  }
+  NSString *userAgent = [cache stringForKeyOrNil:@"user_agent"];
+  return userAgent.length > 0 ? userAgent : nil;
+}
+
+// Only writes when something changed, so resolving on every launch does not
+// rewrite the defaults plist.
++ (void)cacheSystemUserAgent:(NSString *)systemUserAgent
+{
+  NSDictionary *cache = @{@"system_version": [MPDevice systemVersion],
+                          @"machine": [MPDevice machine],
+                          @"user_agent": systemUserAgent};
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  if ([[defaults dictionaryForKey:FB_AN_SYSTEM_USER_AGENT] isEqualToDictionary:cache]) {
+    return;
+  }
+  [defaults setObject:cache forKey:FB_AN_SYSTEM_USER_AGENT];
+}
+
 + (nullable NSString *)generateUserAgentStringFromRawString:(NSString *)systemUserAgent
 {
   if (!systemUserAgent) {
@@ -877,23 +912,21 @@ static UIViewController * __nullable topViewControllerOverride;
 
 - (NSString *)fb_URLEncodedString
 {
-  NSMutableString *outputString = [NSMutableString string];
-  const unsigned char *sourceString = (const unsigned char *)self.UTF8String;
-  NSUInteger length = (NSUInteger)strlen((const char *)sourceString);
-  for (NSUInteger i = 0; i < length; ++i) {
-    const unsigned char currentChar = sourceString[i];
-    if (currentChar == ' '){
-      [outputString appendString:@"+"];
-    } else if (currentChar == '.' || currentChar == '-' || currentChar == '_' || currentChar == '~' ||
-               (currentChar >= 'a' && currentChar <= 'z') ||
-               (currentChar >= 'A' && currentChar <= 'Z') ||
-               (currentChar >= '0' && currentChar <= '9')) {
-      [outputString appendFormat:@"%c", currentChar];
-    } else {
-      [outputString appendFormat:@"%%%02X", currentChar];
-    }
-  }
-  return outputString;
+  const char *sourceString = self.UTF8String;
+  const size_t length = sourceString ? strlen(sourceString) : 0;
+  const size_t encodedLength = FBURLEncodedLength(sourceString, length);
+  if (encodedLength == 0) {
+    return @"";
+  }
+  char *encoded = (char *)malloc(encodedLength);
+  if (!encoded) {
+    return @"";
+  }
+  FBURLEncode(sourceString, length, encoded);
+  return [[NSString alloc] initWithBytesNoCopy:encoded
+                                        length:encodedLength
+                                      encoding:NSASCIIStringEncoding
+                                  freeWhenDone:YES];
 }
 
 @end
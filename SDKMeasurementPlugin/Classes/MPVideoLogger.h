@@ -21,6 +21,7 @@
 #import <UIKit/UIKit.h>
 #import "FBMPObserver.h"
 
+#import "MPAudioStateProviding.h"
 #import "MPDefines+Internal.h"
 
 NS_ASSUME_NONNULL_BEGIN
@@ -65,6 +66,10 @@ FB_INIT_AND_NEW_UNAVAILABLE_NULLABILITY
 
 - (void)updateTargetVolumeBlock:(MPVideoLoggerTargetVolumeBlock)block;
 
+// When set, progress ticks take the volume from the provider instead of
+// querying AVAudioSession and calling the target volume block.
+- (void)updateAudioStateProvider:(nullable id<MPAudioStateProviding>)provider;
+
 - (void)registerComplete:(CMTime)currentTime;
 
 - (void)registerPause:(CMTime)currentTime;
@@ -85,6 +90,17 @@ FB_INIT_AND_NEW_UNAVAILABLE_NULLABILITY
                 forceLog:(BOOL)forceLog
                   paused:(BOOL)paused;
 
+// See -[MPQualityManager startTraceRecording]
+- (void)startQualityTraceRecording;
+
+- (nullable NSData *)stopQualityTraceRecording;
+
+// See -[MPQualityViewabilityMeasurement viewHierarchySnapshot]
+- (nullable NSData *)qualityViewHierarchySnapshot;
+
+// See -[MPQualityManager averageMainThreadTickDuration]
+- (NSTimeInterval)qualityAverageMainThreadTickDuration;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -18,6 +18,7 @@
 
 #import "MPVideoLogger.h"
 
+#import "MPConfigManager.h"
 #import "MPDynamicFrameworkLoader.h"
 #import "MPEventManager.h"
 #import "MPQualityManager.h"
@@ -32,12 +33,16 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, strong, readonly) MPQualityManager *adQualityManager;
 @property (nonatomic, assign) BOOL autoplay;
 @property (nonatomic, assign) BOOL hasLoggedIABImpression;
-@property (nonatomic, copy) NSString *inlineClientToken;
+// Also read by rule callbacks, on the quality processing queue
+@property (atomic, copy) NSString *inlineClientToken;
 @property (nonatomic, assign) NSTimeInterval lastProgressBoundaryTime;
-@property (nonatomic, assign) NSTimeInterval lastProgressCurrentTime;
+@property (atomic, assign) NSTimeInterval lastProgressCurrentTime;
 @property (nonatomic, strong) MPVideoLoggerTargetVolumeBlock targetVolumeBlock;
+@property (nonatomic, strong, nullable) id<MPAudioStateProviding> audioStateProvider;
 @property (nonatomic, strong, nullable) MPVideoLoggerViewableImpressionBlock viewableImpressionBlock;
 @property (nonatomic, assign) NSTimeInterval currentTimeSeconds;
+// Last duration handed to the quality manager
+@property (nonatomic, assign) NSTimeInterval registeredDuration;
 
 @end
 
@@ -82,11 +87,17 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
   self.targetVolumeBlock = block;
 }
 
+- (void)updateAudioStateProvider:(nullable id<MPAudioStateProviding>)provider
+{
+  self.audioStateProvider = provider;
+}
+
 - (void)initializeWithTargetView:(UIView *)targetView
 {
   _lastProgressBoundaryTime = 0.0;
   _lastProgressCurrentTime = 0.0;
   _currentTimeSeconds = 0.0;
+  _registeredDuration = 0.0;
   weakify(self);
   MPQualityRule *mrcRule = [MPQualityRule mrcRuleWithEndCallback:^(BOOL completed, BOOL passed, MPQualityStatistics *statistics) {
     strongify(self);
@@ -103,11 +114,26 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
   if (viewableImpressionRule) {
     [adQualityRules addObject:viewableImpressionRule];
   }
+  NSString *ruleSpecification = [MPConfigManager sharedManager].videoQualityRuleSpecification;
+  if (ruleSpecification.length) {
+    NSArray<MPQualityRule *> *configuredRules = [MPQualityRule rulesWithSpecification:ruleSpecification endCallback:^(NSString *name, BOOL completed, BOOL passed, MPQualityStatistics *statistics) {
+      strongify(self);
+      [self onQualityRuleCallback:name completed:completed passed:passed statistics:statistics];
+    }];
+    [adQualityRules addObjectsFromArray:configuredRules ?: @[]];
+  }
   MPQualityManager *adQualityManager = [MPQualityManager managerWithTargetView:targetView
                                                                              rules:adQualityRules];
   if (adQualityManager) {
     _adQualityManager = adQualityManager;
   }
+  MPConfigManager *configManager = [MPConfigManager sharedManager];
+  if (configManager.isQualityAdaptiveSamplingEnabled) {
+    [_adQualityManager enableAdaptiveSamplingWithMaxErrorFraction:configManager.qualityAdaptiveSamplingMaxErrorPercentage / 100.0];
+  }
+  if (!configManager.isQualityBackgroundProcessingEnabled) {
+    [_adQualityManager disableBackgroundProcessing];
+  }
 }
 
 - (void)setTargetView:(UIView *)targetView
@@ -130,6 +156,11 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
 }
 
 - (void)registerProgressForPlayerItem:(AVPlayerItem *)playerItem state:(StateType)state {
+  NSTimeInterval duration = mpsdk_dfl_CMTimeGetSeconds(playerItem.duration);
+  if (isfinite(duration) && duration > 0.0 && duration != self.registeredDuration) {
+    self.registeredDuration = duration;
+    [self.adQualityManager registerDuration:duration];
+  }
   if (state != kStateTypeNone && state != kStateTypeSeekStart && state != kStateTypeComplete) {
     [self registerProgress:[playerItem currentTime]];
   }
@@ -177,6 +208,26 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
   [self registerProgress:currentTime forceLog:YES paused:NO];
 }
 
+- (void)startQualityTraceRecording
+{
+  [self.adQualityManager startTraceRecording];
+}
+
+- (nullable NSData *)stopQualityTraceRecording
+{
+  return [self.adQualityManager stopTraceRecording];
+}
+
+- (nullable NSData *)qualityViewHierarchySnapshot
+{
+  return [self.adQualityManager viewHierarchySnapshot];
+}
+
+- (NSTimeInterval)qualityAverageMainThreadTickDuration
+{
+  return self.adQualityManager.averageMainThreadTickDuration;
+}
+
 #pragma mark private methods
 
 - (void)flush:(CMTime)time
@@ -199,29 +250,45 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
 
 - (void)logVideoEventForAction:(MPVideoAction)action
 {
-  MPVideoLoggingEvent *loggingEvent = [MPVideoLoggingEvent loggingEventWithAction:action
-                                                                           targetView:self.targetView
-                                                                             autoplay:self.autoplay
-                                                                          currentTime:self.lastProgressCurrentTime
-                                                                viewabilityStatistics:self.adQualityManager.statistics.viewabilityStatistics
-                                                                 audibilityStatistics:self.adQualityManager.statistics.audibilityStatistics];
-  if (loggingEvent) {
-    [self logVideoEvent:loggingEvent];
-  }
+  [self logVideoEventForAction:action currentTime:self.lastProgressCurrentTime];
+}
+
+- (void)logVideoEventForAction:(MPVideoAction)action
+                   currentTime:(NSTimeInterval)currentTime
+{
+  [self.adQualityManager recordTraceAction:action];
+  [self.adQualityManager performWithStatistics:^(MPQualityStatistics *statistics, CGRect targetFrame, CGSize viewportSize) {
+    MPVideoLoggingEvent *loggingEvent = [MPVideoLoggingEvent loggingEventWithAction:action
+                                                                        targetFrame:targetFrame
+                                                                       viewportSize:viewportSize
+                                                                           autoplay:self.autoplay
+                                                                        currentTime:currentTime
+                                                              viewabilityStatistics:statistics.viewabilityStatistics
+                                                               audibilityStatistics:statistics.audibilityStatistics];
+    if (loggingEvent) {
+      [self logVideoEvent:loggingEvent];
+    }
+  }];
 }
 
 - (void)logVideoTime
 {
-  MPVideoLoggingEvent *loggingEvent = [MPVideoLoggingEvent loggingEventWithAction:MPVideoActionTime
-                                                                           targetView:self.targetView
-                                                                             autoplay:self.autoplay
-                                                                          currentTime:self.lastProgressCurrentTime
-                                                                         previousTime:self.lastProgressBoundaryTime
-                                                                viewabilityStatistics:self.adQualityManager.statistics.viewabilityStatistics
-                                                                 audibilityStatistics:self.adQualityManager.statistics.audibilityStatistics];
-  if (loggingEvent) {
-    [self logVideoEvent:loggingEvent];
-  }
+  [self.adQualityManager recordTraceAction:MPVideoActionTime];
+  NSTimeInterval currentTime = self.lastProgressCurrentTime;
+  NSTimeInterval previousTime = self.lastProgressBoundaryTime;
+  [self.adQualityManager performWithStatistics:^(MPQualityStatistics *statistics, CGRect targetFrame, CGSize viewportSize) {
+    MPVideoLoggingEvent *loggingEvent = [MPVideoLoggingEvent loggingEventWithAction:MPVideoActionTime
+                                                                        targetFrame:targetFrame
+                                                                       viewportSize:viewportSize
+                                                                           autoplay:self.autoplay
+                                                                        currentTime:currentTime
+                                                                       previousTime:previousTime
+                                                              viewabilityStatistics:statistics.viewabilityStatistics
+                                                               audibilityStatistics:statistics.audibilityStatistics];
+    if (loggingEvent) {
+      [self logVideoEvent:loggingEvent];
+    }
+  }];
 }
 
 - (void)onMRCRuleCallback:(BOOL)completed
@@ -229,7 +296,7 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
                statistics:(MPQualityStatistics *)statistics
 {
   if (passed) {
-    [self logVideoEventForAction:MPVideoActionMRC];
+    [self logVideoEventForAction:MPVideoActionMRC currentTime:self.adQualityManager.tickTime];
   }
 }
 
@@ -238,8 +305,37 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
                               statistics:(MPQualityStatistics *)statistics
 {
   if (passed) {
-    FB_BLOCK_CALL_SAFE(self.viewableImpressionBlock);
-    [self logVideoEventForAction:MPVideoActionViewableImpression];
+    // Rules usually run on the quality processing queue; the block is the app's
+    MPVideoLoggerViewableImpressionBlock viewableImpressionBlock = self.viewableImpressionBlock;
+    if ([NSThread isMainThread]) {
+      FB_BLOCK_CALL_SAFE(viewableImpressionBlock);
+    } else if (viewableImpressionBlock) {
+      dispatch_async(dispatch_get_main_queue(), viewableImpressionBlock);
+    }
+    [self logVideoEventForAction:MPVideoActionViewableImpression currentTime:self.adQualityManager.tickTime];
+  }
+}
+
+- (void)onQualityRuleCallback:(NSString *)name
+                    completed:(BOOL)completed
+                       passed:(BOOL)passed
+                   statistics:(MPQualityStatistics *)statistics
+{
+  if (passed) {
+    // Both metrics cover the rule's window; only the geometry is current
+    NSTimeInterval currentTime = self.adQualityManager.tickTime;
+    [self.adQualityManager performWithStatistics:^(MPQualityStatistics *managerStatistics, CGRect targetFrame, CGSize viewportSize) {
+      MPVideoLoggingEvent *loggingEvent = [MPVideoLoggingEvent loggingEventWithQualityRule:name
+                                                                               targetFrame:targetFrame
+                                                                              viewportSize:viewportSize
+                                                                                  autoplay:self.autoplay
+                                                                               currentTime:currentTime
+                                                                     viewabilityStatistics:statistics.viewabilityStatistics
+                                                                      audibilityStatistics:statistics.audibilityStatistics];
+      if (loggingEvent) {
+        [self logVideoEvent:loggingEvent];
+      }
+    }];
   }
 }
 
@@ -265,10 +361,16 @@ const static NSTimeInterval PROGRESS_BOUNDARY = 5.0;
     return;
   }
   
-  float deviceVolume = [[AVAudioSession sharedInstance] outputVolume];
-  float effectiveVolume = deviceVolume * self.targetVolumeBlock();
+  id<MPAudioStateProviding> audioStateProvider = self.audioStateProvider;
+  float effectiveVolume;
+  if (audioStateProvider) {
+    effectiveVolume = [audioStateProvider effectiveVolume];
+  } else {
+    float deviceVolume = [[AVAudioSession sharedInstance] outputVolume];
+    effectiveVolume = deviceVolume * self.targetVolumeBlock();
+  }
   
-  [self.adQualityManager registerProgress:currentProgress volume:effectiveVolume];
+  [self.adQualityManager registerProgress:currentProgress volume:effectiveVolume time:currentTimeSeconds];
   
   if ((forceLog && progressSinceLastBoundary > 0.0) || progressSinceLastBoundary >= PROGRESS_BOUNDARY) {
     [self logProgress];
@@ -34,6 +34,7 @@ typedef NS_ENUM(NSInteger, MPVideoAction) {
   MPVideoActionResume = 5,
   MPVideoActionViewableImpression = 10,
   MPVideoActionIABImpression = 16,
+  MPVideoActionQualityRule = 17,
 };
 
 FB_SUBCLASSING_RESTRICTED
@@ -42,25 +43,37 @@ FB_SUBCLASSING_RESTRICTED
 @property (nonatomic, copy, readonly) NSDictionary *loggingParams;
 
 + (nullable instancetype)loggingEventWithAction:(MPVideoAction)action
-                                     targetView:(UIView *)targetView
+                                    targetFrame:(CGRect)targetFrame
+                                   viewportSize:(CGSize)viewportSize
                                        autoplay:(BOOL)autoplay
                                     currentTime:(NSTimeInterval)currentTime;
 
 + (nullable instancetype)loggingEventWithAction:(MPVideoAction)action
-                                     targetView:(UIView *)targetView
+                                    targetFrame:(CGRect)targetFrame
+                                   viewportSize:(CGSize)viewportSize
                                        autoplay:(BOOL)autoplay
                                     currentTime:(NSTimeInterval)currentTime
                           viewabilityStatistics:(MPQualityMetric *)viewabilityStatistics
                            audibilityStatistics:(MPQualityMetric *)audibilityStatistics;
 
 + (nullable instancetype)loggingEventWithAction:(MPVideoAction)action
-                                     targetView:(UIView *)targetView
+                                    targetFrame:(CGRect)targetFrame
+                                   viewportSize:(CGSize)viewportSize
                                        autoplay:(BOOL)autoplay
                                     currentTime:(NSTimeInterval)currentTime
                                    previousTime:(NSTimeInterval)previousTime
                           viewabilityStatistics:(MPQualityMetric *)viewabilityStatistics
                            audibilityStatistics:(MPQualityMetric *)audibilityStatistics;
 
+// An MPVideoActionQualityRule event for the configured rule `ruleName`
++ (nullable instancetype)loggingEventWithQualityRule:(NSString *)ruleName
+                                         targetFrame:(CGRect)targetFrame
+                                        viewportSize:(CGSize)viewportSize
+                                            autoplay:(BOOL)autoplay
+                                         currentTime:(NSTimeInterval)currentTime
+                               viewabilityStatistics:(MPQualityMetric *)viewabilityStatistics
+                                audibilityStatistics:(MPQualityMetric *)audibilityStatistics;
+
 @end
 
 NS_ASSUME_NONNULL_END
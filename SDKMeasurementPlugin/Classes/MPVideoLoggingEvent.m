@@ -32,16 +32,23 @@ static MPVideoLoggingParameter const PLAYER_OFFSET_LEFT = @"pl";
 static MPVideoLoggingParameter const PLAYER_OFFSET_TOP = @"pt";
 static MPVideoLoggingParameter const PLAYER_WIDTH = @"pw";
 static MPVideoLoggingParameter const PREVIOUS_TIME = @"ptime";
+static MPVideoLoggingParameter const QUALITY_RULE = @"qr";
 static MPVideoLoggingParameter const TIME = @"time";
 static MPVideoLoggingParameter const VIEWABILITY_AVG = @"vwa";
+static MPVideoLoggingParameter const VIEWABILITY_HISTOGRAM = @"vwh";
 static MPVideoLoggingParameter const VIEWABILITY_MAX = @"vwmax";
 static MPVideoLoggingParameter const VIEWABILITY_MIN = @"vwm";
+static MPVideoLoggingParameter const VIEWABILITY_P50 = @"vwp50";
+static MPVideoLoggingParameter const VIEWABILITY_P90 = @"vwp90";
 static MPVideoLoggingParameter const VIEWABLE_TIME_MS = @"vtime_ms";
 static MPVideoLoggingParameter const VIEWPORT_HEIGHT = @"vph";
 static MPVideoLoggingParameter const VIEWPORT_WIDTH = @"vpw";
 static MPVideoLoggingParameter const VOLUME_AVG = @"vla";
+static MPVideoLoggingParameter const VOLUME_HISTOGRAM = @"vlh";
 static MPVideoLoggingParameter const VOLUME_MAX = @"vlmax";
 static MPVideoLoggingParameter const VOLUME_MIN = @"vlm";
+static MPVideoLoggingParameter const VOLUME_P50 = @"vlp50";
+static MPVideoLoggingParameter const VOLUME_P90 = @"vlp90";
 static MPVideoLoggingParameter const VIEWABLE_DETECTION = @"vw_d";
 
 static NSString * const FB_VIEWABLE_DETECTION = @"sdk-mp-ios";
@@ -58,6 +65,9 @@ static void addAudibilityStatistics(NSMutableDictionary *parameters, MPQualityMe
   parameters[VOLUME_AVG] = [NSString stringWithFormat:@"%f", audibilityStatistics.avg];
   parameters[VOLUME_MIN] = [NSString stringWithFormat:@"%f", audibilityStatistics.min];
   parameters[VOLUME_MAX] = [NSString stringWithFormat:@"%f", audibilityStatistics.max];
+  parameters[VOLUME_P50] = [NSString stringWithFormat:@"%f", audibilityStatistics.p50];
+  parameters[VOLUME_P90] = [NSString stringWithFormat:@"%f", audibilityStatistics.p90];
+  parameters[VOLUME_HISTOGRAM] = audibilityStatistics.histogramString;
   parameters[AUDIBLE_TIME_MS] = [NSString stringWithFormat:@"%lu", (unsigned long)(audibilityStatistics.eligibleSeconds * 1000)];
   parameters[MAX_CONTINUOUS_AUDIBLE_TIME_MS] = [NSString stringWithFormat:@"%lu", (unsigned long)(audibilityStatistics.maxContinuousEligibleSeconds * 1000)];
 }
@@ -82,14 +92,19 @@ static void addPreviousTime(NSMutableDictionary *parameters, NSTimeInterval prev
   parameters[PREVIOUS_TIME] = [NSString stringWithFormat:@"%f", previousTime];
 }
 
-static void addTargetView(NSMutableDictionary *parameters, UIView *targetView)
+static void addQualityRule(NSMutableDictionary *parameters, NSString *ruleName)
 {
-  parameters[PLAYER_OFFSET_TOP] = [NSString stringWithFormat:@"%f", targetView.frame.origin.y];
-  parameters[PLAYER_OFFSET_LEFT] = [NSString stringWithFormat:@"%f", targetView.frame.origin.x];
-  parameters[PLAYER_HEIGHT] = [NSString stringWithFormat:@"%f", targetView.frame.size.height];
-  parameters[PLAYER_WIDTH] = [NSString stringWithFormat:@"%f", targetView.frame.size.width];
-  parameters[VIEWPORT_HEIGHT] = [NSString stringWithFormat:@"%f", targetView.window.frame.size.height];
-  parameters[VIEWPORT_WIDTH] = [NSString stringWithFormat:@"%f", targetView.window.frame.size.width];
+  parameters[QUALITY_RULE] = ruleName;
+}
+
+static void addTargetFrame(NSMutableDictionary *parameters, CGRect targetFrame, CGSize viewportSize)
+{
+  parameters[PLAYER_OFFSET_TOP] = [NSString stringWithFormat:@"%f", targetFrame.origin.y];
+  parameters[PLAYER_OFFSET_LEFT] = [NSString stringWithFormat:@"%f", targetFrame.origin.x];
+  parameters[PLAYER_HEIGHT] = [NSString stringWithFormat:@"%f", targetFrame.size.height];
+  parameters[PLAYER_WIDTH] = [NSString stringWithFormat:@"%f", targetFrame.size.width];
+  parameters[VIEWPORT_HEIGHT] = [NSString stringWithFormat:@"%f", viewportSize.height];
+  parameters[VIEWPORT_WIDTH] = [NSString stringWithFormat:@"%f", viewportSize.width];
 }
 
 static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityMetric *viewabilityStatistics)
@@ -97,6 +112,9 @@ static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityM
   parameters[VIEWABILITY_AVG] = [NSString stringWithFormat:@"%f", viewabilityStatistics.avg];
   parameters[VIEWABILITY_MIN] = [NSString stringWithFormat:@"%f", viewabilityStatistics.min];
   parameters[VIEWABILITY_MAX] = [NSString stringWithFormat:@"%f", viewabilityStatistics.max];
+  parameters[VIEWABILITY_P50] = [NSString stringWithFormat:@"%f", viewabilityStatistics.p50];
+  parameters[VIEWABILITY_P90] = [NSString stringWithFormat:@"%f", viewabilityStatistics.p90];
+  parameters[VIEWABILITY_HISTOGRAM] = viewabilityStatistics.histogramString;
   parameters[VIEWABLE_TIME_MS] = [NSString stringWithFormat:@"%lu", (unsigned long)(viewabilityStatistics.eligibleSeconds * 1000)];
   parameters[MAX_CONTINUOUS_VIEWABLE_TIME_MS] = [NSString stringWithFormat:@"%lu", (unsigned long)(viewabilityStatistics.maxContinuousEligibleSeconds * 1000)];
 }
@@ -104,21 +122,23 @@ static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityM
 @implementation MPVideoLoggingEvent
 
 + (nullable instancetype)loggingEventWithAction:(MPVideoAction)action
-                                     targetView:(UIView *)targetView
+                                    targetFrame:(CGRect)targetFrame
+                                   viewportSize:(CGSize)viewportSize
                                        autoplay:(BOOL)autoplay
                                     currentTime:(NSTimeInterval)currentTime
 {
   NSMutableDictionary *loggingParams = [NSMutableDictionary dictionary];
   addViewableDetection(loggingParams);
   addAction(loggingParams, action);
-  addTargetView(loggingParams, targetView);
+  addTargetFrame(loggingParams, targetFrame, viewportSize);
   addAutoplay(loggingParams, autoplay);
   addCurrentTime(loggingParams, currentTime);
   return [[MPVideoLoggingEvent alloc] initWithLoggingParams:loggingParams];
 }
 
 + (nullable instancetype)loggingEventWithAction:(MPVideoAction)action
-                                     targetView:(UIView *)targetView
+                                    targetFrame:(CGRect)targetFrame
+                                   viewportSize:(CGSize)viewportSize
                                        autoplay:(BOOL)autoplay
                                     currentTime:(NSTimeInterval)currentTime
                           viewabilityStatistics:(MPQualityMetric *)viewabilityStatistics
@@ -127,7 +147,7 @@ static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityM
   NSMutableDictionary *loggingParams = [NSMutableDictionary dictionary];
   addViewableDetection(loggingParams);
   addAction(loggingParams, action);
-  addTargetView(loggingParams, targetView);
+  addTargetFrame(loggingParams, targetFrame, viewportSize);
   addAutoplay(loggingParams, autoplay);
   addCurrentTime(loggingParams, currentTime);
   addViewabilityStatistics(loggingParams, viewabilityStatistics);
@@ -136,7 +156,8 @@ static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityM
 }
 
 + (nullable instancetype)loggingEventWithAction:(MPVideoAction)action
-                                     targetView:(UIView *)targetView
+                                    targetFrame:(CGRect)targetFrame
+                                   viewportSize:(CGSize)viewportSize
                                        autoplay:(BOOL)autoplay
                                     currentTime:(NSTimeInterval)currentTime
                                    previousTime:(NSTimeInterval)previousTime
@@ -146,7 +167,7 @@ static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityM
   NSMutableDictionary *loggingParams = [NSMutableDictionary dictionary];
   addViewableDetection(loggingParams);
   addAction(loggingParams, action);
-  addTargetView(loggingParams, targetView);
+  addTargetFrame(loggingParams, targetFrame, viewportSize);
   addAutoplay(loggingParams, autoplay);
   addCurrentTime(loggingParams, currentTime);
   addPreviousTime(loggingParams, previousTime);
@@ -155,6 +176,26 @@ static void addViewabilityStatistics(NSMutableDictionary *parameters, MPQualityM
   return [[MPVideoLoggingEvent alloc] initWithLoggingParams:loggingParams];
 }
 
++ (nullable instancetype)loggingEventWithQualityRule:(NSString *)ruleName
+                                         targetFrame:(CGRect)targetFrame
+                                        viewportSize:(CGSize)viewportSize
+                                            autoplay:(BOOL)autoplay
+                                         currentTime:(NSTimeInterval)currentTime
+                               viewabilityStatistics:(MPQualityMetric *)viewabilityStatistics
+                                audibilityStatistics:(MPQualityMetric *)audibilityStatistics
+{
+  NSMutableDictionary *loggingParams = [NSMutableDictionary dictionary];
+  addViewableDetection(loggingParams);
+  addAction(loggingParams, MPVideoActionQualityRule);
+  addQualityRule(loggingParams, ruleName);
+  addTargetFrame(loggingParams, targetFrame, viewportSize);
+  addAutoplay(loggingParams, autoplay);
+  addCurrentTime(loggingParams, currentTime);
+  addViewabilityStatistics(loggingParams, viewabilityStatistics);
+  addAudibilityStatistics(loggingParams, audibilityStatistics);
+  return [[MPVideoLoggingEvent alloc] initWithLoggingParams:loggingParams];
+}
+
 - (nullable instancetype)init
 {
   return [self initWithLoggingParams:@{}];
@@ -0,0 +1,302 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "MPByteBuffer.hpp"
+
+namespace mp {
+
+// Screen-space rectangle, in points. Empty rects stand in for CGRectNull too.
+struct ViewRect {
+  double x = 0;
+  double y = 0;
+  double width = 0;
+  double height = 0;
+
+  bool isEmpty() const
+  {
+    return !(width > 0) || !(height > 0);
+  }
+
+  bool intersects(const ViewRect &other) const
+  {
+    return !isEmpty() && !other.isEmpty() &&
+      x < other.x + other.width && other.x < x + width &&
+      y < other.y + other.height && other.y < y + height;
+  }
+
+  ViewRect intersection(const ViewRect &other) const
+  {
+    if (!intersects(other)) {
+      return ViewRect();
+    }
+    ViewRect rect;
+    rect.x = x > other.x ? x : other.x;
+    rect.y = y > other.y ? y : other.y;
+    const double right = x + width < other.x + other.width ? x + width : other.x + other.width;
+    const double bottom = y + height < other.y + other.height ? y + height : other.y + other.height;
+    rect.width = right - rect.x;
+    rect.height = bottom - rect.y;
+    return rect;
+  }
+};
+
+enum ViewSnapshotFlag : uint8_t {
+  ViewSnapshotFlagHidden = 1 << 0,
+  ViewSnapshotFlagClipsToBounds = 1 << 1,
+  ViewSnapshotFlagWindow = 1 << 2,
+  ViewSnapshotFlagEmptyFrame = 1 << 3, // CGRectIsEmpty(view.frame)
+};
+
+constexpr uint32_t kNoView = UINT32_MAX;
+
+struct ViewSnapshotNode {
+  ViewRect screenRect; // -[UIView screenRect]
+  float alpha = 1;
+  float backgroundAlpha = 0; // 0 when there is no backgroundColor
+  uint8_t flags = 0;
+  uint32_t parent = kNoView;
+  uint32_t end = 0; // one past the view's last descendant
+
+  bool hasFlag(ViewSnapshotFlag flag) const
+  {
+    return (flags & flag) != 0;
+  }
+};
+
+/**
+ * What MPQualityViewabilityMeasurement looks at, for every view on one
+ * screen: the screen's windows in z-order, each followed by its subviews
+ * depth-first, so a view's descendants are nodes [index + 1, end) and its
+ * later siblings start at `end`.
+ */
+struct ViewSnapshot {
+  ViewRect screenBounds;
+  uint32_t target = kNoView;
+  double targetFrameWidth = 0;
+  double targetFrameHeight = 0;
+  std::vector<ViewSnapshotNode> nodes;
+};
+
+/**
+ * Builds a snapshot in traversal order: beginView() for a window or view,
+ * then its subviews back to front, then endView().
+ */
+class ViewSnapshotBuilder {
+ public:
+  explicit ViewSnapshotBuilder(ViewSnapshot &snapshot) : _snapshot(snapshot) {}
+
+  uint32_t beginView(const ViewRect &screenRect, float alpha, float backgroundAlpha, uint8_t flags)
+  {
+    ViewSnapshotNode node;
+    node.screenRect = screenRect;
+    node.alpha = alpha;
+    node.backgroundAlpha = backgroundAlpha;
+    node.flags = flags;
+    node.parent = _open.empty() ? kNoView : _open.back();
+    const uint32_t index = (uint32_t)_snapshot.nodes.size();
+    _snapshot.nodes.push_back(node);
+    _open.push_back(index);
+    return index;
+  }
+
+  void endView()
+  {
+    _snapshot.nodes[_open.back()].end = (uint32_t)_snapshot.nodes.size();
+    _open.pop_back();
+  }
+
+ private:
+  ViewSnapshot &_snapshot;
+  std::vector<uint32_t> _open;
+};
+
+/**
+ * Layout, little-endian: "MPVS", u8 version, f32 x4 screen bounds, u32 target
+ * index (kNoView for none), f32 x2 target frame size, u32 node count, then
+ * per node in snapshot order f32 x4 screen rect, f32 alpha, f32 background
+ * alpha, u8 flags, u32 descendant count. 29 bytes a view.
+ */
+constexpr uint8_t kViewSnapshotVersion = 1;
+
+namespace detail {
+
+inline void putSnapshotU32(ByteBuffer &buffer, uint32_t value)
+{
+  uint8_t *out = buffer.prepare(4);
+  for (int i = 0; i < 4; i++) {
+    out[i] = (uint8_t)(value >> (8 * i));
+  }
+  buffer.commit(4);
+}
+
+inline void putSnapshotF32(ByteBuffer &buffer, double value)
+{
+  const float single = (float)value;
+  uint32_t bits;
+  std::memcpy(&bits, &single, sizeof(bits));
+  putSnapshotU32(buffer, bits);
+}
+
+inline void putSnapshotRect(ByteBuffer &buffer, const ViewRect &rect)
+{
+  putSnapshotF32(buffer, rect.x);
+  putSnapshotF32(buffer, rect.y);
+  putSnapshotF32(buffer, rect.width);
+  putSnapshotF32(buffer, rect.height);
+}
+
+class SnapshotCursor {
+ public:
+  SnapshotCursor(const uint8_t *bytes, std::size_t length) : _cursor(bytes), _end(bytes + length) {}
+
+  std::size_t remaining() const
+  {
+    return (std::size_t)(_end - _cursor);
+  }
+
+  bool skip(const char *expected, std::size_t count)
+  {
+    if (remaining() < count || std::memcmp(_cursor, expected, count) != 0) {
+      return false;
+    }
+    _cursor += count;
+    return true;
+  }
+
+  bool getU8(uint8_t &value)
+  {
+    if (remaining() < 1) {
+      return false;
+    }
+    value = *_cursor++;
+    return true;
+  }
+
+  bool getU32(uint32_t &value)
+  {
+    if (remaining() < 4) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+      value |= (uint32_t)_cursor[i] << (8 * i);
+    }
+    _cursor += 4;
+    return true;
+  }
+
+  bool getF32(float &value)
+  {
+    uint32_t bits;
+    if (!getU32(bits)) {
+      return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+  }
+
+  bool getF32(double &value)
+  {
+    float single;
+    if (!getF32(single)) {
+      return false;
+    }
+    value = single;
+    return true;
+  }
+
+  bool getRect(ViewRect &rect)
+  {
+    return getF32(rect.x) && getF32(rect.y) && getF32(rect.width) && getF32(rect.height);
+  }
+
+ private:
+  const uint8_t *_cursor;
+  const uint8_t *_end;
+};
+
+} // namespace detail
+
+inline void writeViewSnapshot(const ViewSnapshot &snapshot, ByteBuffer &buffer)
+{
+  buffer.reserve(buffer.size() + 37 + snapshot.nodes.size() * 29);
+  buffer.append("MPVS", 4);
+  buffer.push(kViewSnapshotVersion);
+  detail::putSnapshotRect(buffer, snapshot.screenBounds);
+  detail::putSnapshotU32(buffer, snapshot.target);
+  detail::putSnapshotF32(buffer, snapshot.targetFrameWidth);
+  detail::putSnapshotF32(buffer, snapshot.targetFrameHeight);
+  detail::putSnapshotU32(buffer, (uint32_t)snapshot.nodes.size());
+  for (uint32_t i = 0; i < snapshot.nodes.size(); i++) {
+    const ViewSnapshotNode &node = snapshot.nodes[i];
+    detail::putSnapshotRect(buffer, node.screenRect);
+    detail::putSnapshotF32(buffer, node.alpha);
+    detail::putSnapshotF32(buffer, node.backgroundAlpha);
+    buffer.push(node.flags);
+    detail::putSnapshotU32(buffer, node.end - i - 1);
+  }
+}
+
+// Returns false, leaving `snapshot` unspecified, on a truncated or
+// inconsistent file.
+inline bool readViewSnapshot(const uint8_t *bytes, std::size_t length, ViewSnapshot &snapshot)
+{
+  detail::SnapshotCursor cursor(bytes, length);
+  uint8_t version = 0;
+  uint32_t count = 0;
+  snapshot = ViewSnapshot();
+  if (!cursor.skip("MPVS", 4) || !cursor.getU8(version) || version != kViewSnapshotVersion ||
+      !cursor.getRect(snapshot.screenBounds) || !cursor.getU32(snapshot.target) ||
+      !cursor.getF32(snapshot.targetFrameWidth) || !cursor.getF32(snapshot.targetFrameHeight) ||
+      !cursor.getU32(count) || cursor.remaining() / 29 < count) {
+    return false;
+  }
+  if (snapshot.target != kNoView && snapshot.target >= count) {
+    return false;
+  }
+  snapshot.nodes.resize(count);
+  std::vector<uint32_t> open;
+  for (uint32_t i = 0; i < count; i++) {
+    while (!open.empty() && snapshot.nodes[open.back()].end <= i) {
+      open.pop_back();
+    }
+    ViewSnapshotNode &node = snapshot.nodes[i];
+    uint32_t descendants = 0;
+    if (!cursor.getRect(node.screenRect) || !cursor.getF32(node.alpha) ||
+        !cursor.getF32(node.backgroundAlpha) || !cursor.getU8(node.flags) ||
+        !cursor.getU32(descendants) || descendants >= count - i) {
+      return false;
+    }
+    node.parent = open.empty() ? kNoView : open.back();
+    node.end = i + 1 + descendants;
+    // A subtree must nest inside its parent's.
+    if (!open.empty() && node.end > snapshot.nodes[open.back()].end) {
+      return false;
+    }
+    open.push_back(i);
+  }
+  return cursor.remaining() == 0;
+}
+
+} // namespace mp
@@ -0,0 +1,288 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "MPViewSnapshot.hpp"
+
+namespace mp {
+
+/**
+ * Area covered by a set of rects, overlaps counted once: a sweep over the
+ * distinct x edges, merging the y extents of the rects spanning each slab.
+ * O(n^2 log n) time and O(n) memory, where the grid it replaced took O(n^3)
+ * time and O(n^2) stack. Scratch storage is kept between calls.
+ */
+class RectUnion {
+ public:
+  double area(const std::vector<ViewRect> &rects)
+  {
+    _edges.clear();
+    _byLeft.clear();
+    for (const ViewRect &rect : rects) {
+      if (!rect.isEmpty()) {
+        _edges.push_back(rect.x);
+        _edges.push_back(rect.x + rect.width);
+        _byLeft.push_back(&rect);
+      }
+    }
+    std::sort(_edges.begin(), _edges.end());
+    _edges.erase(std::unique(_edges.begin(), _edges.end()), _edges.end());
+    std::sort(_byLeft.begin(), _byLeft.end(), [](const ViewRect *a, const ViewRect *b) {
+      return a->x < b->x;
+    });
+
+    double area = 0;
+    std::size_t next = 0;
+    _active.clear();
+    for (std::size_t i = 0; i + 1 < _edges.size(); i++) {
+      const double left = _edges[i];
+      const double right = _edges[i + 1];
+      while (next < _byLeft.size() && _byLeft[next]->x <= left) {
+        _active.push_back(_byLeft[next++]);
+      }
+      _active.erase(std::remove_if(_active.begin(), _active.end(), [left](const ViewRect *rect) {
+        return rect->x + rect->width <= left;
+      }), _active.end());
+      if (_active.empty()) {
+        continue;
+      }
+
+      _spans.clear();
+      for (const ViewRect *rect : _active) {
+        _spans.emplace_back(rect->y, rect->y + rect->height);
+      }
+      std::sort(_spans.begin(), _spans.end());
+      double covered = 0;
+      double spanStart = _spans[0].first;
+      double spanEnd = _spans[0].second;
+      for (std::size_t j = 1; j < _spans.size(); j++) {
+        if (_spans[j].first > spanEnd) {
+          covered += spanEnd - spanStart;
+          spanStart = _spans[j].first;
+        }
+        spanEnd = std::max(spanEnd, _spans[j].second);
+      }
+      covered += spanEnd - spanStart;
+      area += covered * (right - left);
+    }
+    return area;
+  }
+
+  // Share of a target of targetArea points left visible by the occluders,
+  // given the target's clipped screen rect. Leaves the target appended to
+  // occluders.
+  float viewableRatio(const ViewRect &targetRect, double targetArea, std::vector<ViewRect> &occluders)
+  {
+    const double occludedArea = area(occluders);
+    occluders.push_back(targetRect);
+    const double targetViewableArea = area(occluders) - occludedArea;
+    return (float)(targetViewableArea / targetArea);
+  }
+
+ private:
+  std::vector<double> _edges;
+  std::vector<const ViewRect *> _byLeft;
+  std::vector<const ViewRect *> _active;
+  std::vector<std::pair<double, double>> _spans;
+};
+
+/**
+ * -[MPQualityViewabilityMeasurement viewableRatio] over a ViewSnapshot, minus
+ * the application state check: same visibility, clipping and blocking rules,
+ * same traversal. Scratch storage is kept between calls, so measuring
+ * repeatedly does not allocate once it has warmed up.
+ *
+ * Clipping and concealment are carried down from the window instead of being
+ * recomputed from every view up, so each view is looked at once, and subtrees
+ * clipped away from the target are not entered at all.
+ */
+class ViewabilityEngine {
+ public:
+  float viewableRatio(const ViewSnapshot &snapshot, uint32_t target)
+  {
+    _visitedViews = 0;
+    _rects.clear();
+    _chain.clear();
+    if (target >= snapshot.nodes.size() || !visible(snapshot, target)) {
+      return 0.0f;
+    }
+
+    // The target and its ancestors, window last.
+    for (uint32_t view = target; view != kNoView; view = snapshot.nodes[view].parent) {
+      _chain.push_back(view);
+    }
+    _visitedViews = _chain.size();
+    const uint32_t root = _chain.back();
+
+    // Contexts down the chain; _chainContexts[i] applies to _chain[i].
+    _chainContexts.resize(_chain.size());
+    ClipContext context = rootContext(snapshot, root);
+    double alpha = 1;
+    for (std::size_t i = _chain.size(); i-- > 0;) {
+      _chainContexts[i] = context;
+      const ViewSnapshotNode &node = snapshot.nodes[_chain[i]];
+      alpha *= node.alpha;
+      context = childContext(context, node);
+    }
+    if (0.9 - alpha > 0.0001) {
+      return 0.0f;
+    }
+    const ViewRect targetRect = clippedRect(_chainContexts[0], snapshot.nodes[target]);
+    if (targetRect.isEmpty()) {
+      return 0.0f;
+    }
+
+    // Everything drawn above each view on the way up: later siblings of the
+    // view, or later windows on the screen.
+    for (std::size_t i = 0; i < _chain.size(); i++) {
+      const ViewSnapshotNode &node = snapshot.nodes[_chain[i]];
+      if (i + 1 < _chain.size()) {
+        const ViewSnapshotNode &parent = snapshot.nodes[_chain[i + 1]];
+        const ClipContext siblingContext = childContext(_chainContexts[i + 1], parent);
+        for (uint32_t sibling = node.end; sibling < parent.end; sibling = snapshot.nodes[sibling].end) {
+          collectIntersectingRects(snapshot, sibling, siblingContext, targetRect);
+        }
+      } else if (node.hasFlag(ViewSnapshotFlagWindow)) {
+        for (uint32_t window = node.end; window < snapshot.nodes.size(); window = snapshot.nodes[window].end) {
+          collectIntersectingRects(snapshot, window, rootContext(snapshot, window), targetRect);
+        }
+      }
+    }
+
+    return _union.viewableRatio(targetRect, snapshot.targetFrameWidth * snapshot.targetFrameHeight, _rects);
+  }
+
+  float viewableRatio(const ViewSnapshot &snapshot)
+  {
+    return viewableRatio(snapshot, snapshot.target);
+  }
+
+  // Views looked at by the last viewableRatio() call; none more than once.
+  std::size_t visitedViews() const
+  {
+    return _visitedViews;
+  }
+
+  // Rects that went into the last union, the target's included.
+  std::size_t unionRectCount() const
+  {
+    return _rects.size();
+  }
+
+  static bool visible(const ViewSnapshot &snapshot, uint32_t index)
+  {
+    const ViewSnapshotNode &node = snapshot.nodes[index];
+    if (node.hasFlag(ViewSnapshotFlagEmptyFrame) || node.hasFlag(ViewSnapshotFlagHidden) || node.alpha == 0.0f) {
+      return false;
+    }
+    return node.hasFlag(ViewSnapshotFlagWindow) || node.parent != kNoView;
+  }
+
+  static bool blocking(const ViewSnapshotNode &node)
+  {
+    return node.alpha != 0.0f && node.backgroundAlpha != 0.0f;
+  }
+
+ private:
+  // What a view's ancestors do to it: the intersection of the screen bounds
+  // with every clipping ancestor, or concealed when an ancestor is hidden or
+  // transparent.
+  struct ClipContext {
+    ViewRect clip;
+    bool concealed = false;
+  };
+
+  static ClipContext rootContext(const ViewSnapshot &snapshot, uint32_t root)
+  {
+    ClipContext context;
+    context.clip = snapshot.screenBounds;
+    context.concealed = !snapshot.nodes[root].hasFlag(ViewSnapshotFlagWindow);
+    return context;
+  }
+
+  static ClipContext childContext(const ClipContext &context, const ViewSnapshotNode &node)
+  {
+    ClipContext child = context;
+    if (node.hasFlag(ViewSnapshotFlagHidden) || node.alpha == 0.0f) {
+      child.concealed = true;
+    }
+    if (node.hasFlag(ViewSnapshotFlagClipsToBounds)) {
+      child.clip = child.clip.intersection(node.screenRect);
+    }
+    return child;
+  }
+
+  static ViewRect clippedRect(const ClipContext &context, const ViewSnapshotNode &node)
+  {
+    return context.concealed ? ViewRect() : node.screenRect.intersection(context.clip);
+  }
+
+  // -collectRectsInView:context:screenSpace:targetRect:rects: over the
+  // subtree at `root`, in snapshot order: descending is moving to the next
+  // node, skipping a subtree is jumping to its end. A view's clipped rect lies
+  // inside its context's clip, so once that misses the target nothing below
+  // can reach it.
+  void collectIntersectingRects(const ViewSnapshot &snapshot, uint32_t root, const ClipContext &rootContext, const ViewRect &targetRect)
+  {
+    _open.clear();
+    const uint32_t end = snapshot.nodes[root].end;
+    uint32_t index = root;
+    while (index < end) {
+      while (!_open.empty() && _open.back().first <= index) {
+        _open.pop_back();
+      }
+      const ClipContext &context = _open.empty() ? rootContext : _open.back().second;
+      const ViewSnapshotNode &node = snapshot.nodes[index];
+      _visitedViews++;
+      if (!visible(snapshot, index) || context.concealed || !context.clip.intersects(targetRect)) {
+        index = node.end;
+        continue;
+      }
+      const bool isBlocking = blocking(node);
+      if (isBlocking) {
+        const ViewRect rect = clippedRect(context, node);
+        if (rect.intersects(targetRect)) {
+          _rects.push_back(rect);
+        }
+      }
+      if (node.hasFlag(ViewSnapshotFlagClipsToBounds) && isBlocking) {
+        index = node.end;
+        continue;
+      }
+      if (index + 1 < node.end) {
+        _open.push_back(std::make_pair(node.end, childContext(context, node)));
+      }
+      index++;
+    }
+  }
+
+  std::size_t _visitedViews = 0;
+  std::vector<uint32_t> _chain;
+  std::vector<ClipContext> _chainContexts;
+  std::vector<std::pair<uint32_t, ClipContext>> _open; // (end, context) of open subtrees
+  std::vector<ViewRect> _rects;
+  RectUnion _union;
+};
+
+} // namespace mp
@@ -0,0 +1,53 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+#import "MPDefines+Internal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ What a viewability measurement needs from the view hierarchy, captured on the
+ main thread by -[MPQualityViewabilityMeasurement captureGeometry]: the
+ target's clipped rect on screen, its frame area, and the clipped rects of the
+ blocking views drawn above it that intersect it. Everything else, the union
+ area included, is left to -viewableRatio, which is safe to call from any
+ thread.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface MPViewabilityGeometry : NSObject
+
+FB_INIT_AND_NEW_UNAVAILABLE_NULLABILITY
+
+- (instancetype)initWithTargetRect:(CGRect)targetRect
+                        targetArea:(CGFloat)targetArea
+                    occludingRects:(const CGRect *_Nullable)occludingRects
+                             count:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+
+// A target that is not viewable at all, e.g. hidden or in the background.
++ (instancetype)notViewableGeometry;
+
+@property (nonatomic, assign, readonly) NSUInteger occludingRectCount;
+
+// See -[MPQualityViewabilityMeasurement viewableRatio]
+- (float)viewableRatio;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,80 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPViewabilityGeometry.h"
+
+#import <vector>
+
+#import "MPViewabilityEngine.hpp"
+#import "MPViewSnapshot+CoreGraphics.hpp"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@implementation MPViewabilityGeometry
+{
+  mp::ViewRect _targetRect;
+  double _targetArea;
+  std::vector<mp::ViewRect> _occludingRects;
+}
+
+- (instancetype)initWithTargetRect:(CGRect)targetRect
+                        targetArea:(CGFloat)targetArea
+                    occludingRects:(const CGRect *_Nullable)occludingRects
+                             count:(NSUInteger)count
+{
+  self = [super init];
+  if (self) {
+    _targetRect = MPViewRectFromCGRect(targetRect);
+    _targetArea = targetArea;
+    _occludingRects.reserve(count);
+    for (NSUInteger i = 0; i < count; i++) {
+      _occludingRects.push_back(MPViewRectFromCGRect(occludingRects[i]));
+    }
+  }
+  return self;
+}
+
++ (instancetype)notViewableGeometry
+{
+  return [[self alloc] initWithTargetRect:CGRectNull
+                               targetArea:0.0
+                           occludingRects:NULL
+                                    count:0];
+}
+
+- (NSUInteger)occludingRectCount
+{
+  return _occludingRects.size();
+}
+
+- (float)viewableRatio
+{
+  if (_targetRect.isEmpty()) {
+    return 0.0f;
+  }
+  // A copy, since the union takes the target in with the occluders
+  std::vector<mp::ViewRect> rects;
+  rects.reserve(_occludingRects.size() + 1);
+  rects.assign(_occludingRects.begin(), _occludingRects.end());
+  mp::RectUnion rectUnion;
+  return rectUnion.viewableRatio(_targetRect, _targetArea, rects);
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
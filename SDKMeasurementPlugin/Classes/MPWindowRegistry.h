@@ -0,0 +1,57 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+#import "MPDefines+Internal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Caches the windows of each screen, back to front as in -[UIApplication windows],
+ so the viewability tick does not rebuild the list on every call. The cache
+ is dropped whenever a window is shown, hidden, or gains or loses key status,
+ and when a screen connects or disconnects. Windows are held weakly.
+
+ Main thread only.
+ */
+FB_SUBCLASSING_RESTRICTED
+@interface MPWindowRegistry : NSObject
+
++ (instancetype)sharedRegistry;
+
+/**
+ Calls the block with every live window on the same screen as the given one
+ that is in front of it, back to front. Does not allocate while the cache is
+ valid.
+ */
+- (void)enumerateWindowsAboveWindow:(UIWindow *)window usingBlock:(void (^)(UIWindow *aboveWindow))block;
+
+/**
+ The live windows on the screen, back to front, as a new array.
+ */
+- (NSArray<UIWindow *> *)windowsForScreen:(UIScreen *)screen;
+
+- (void)invalidate;
+
+// Bumped by every -invalidate, so callers can tell the windows changed.
+@property (nonatomic, assign, readonly) NSUInteger generation;
+
+@end
+
+NS_ASSUME_NONNULL_END
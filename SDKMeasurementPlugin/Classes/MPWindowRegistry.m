@@ -0,0 +1,120 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#import "MPWindowRegistry.h"
+
+#import "MPNotificationCenter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MPWindowRegistry ()
+
+// UIScreen -> NSPointerArray of weak UIWindows, back to front
+@property (nonatomic, strong, readonly) NSMapTable<UIScreen *, NSPointerArray *> *windowsByScreen;
+@property (nonatomic, assign, readwrite) NSUInteger generation;
+
+@end
+
+@implementation MPWindowRegistry
+
++ (instancetype)sharedRegistry
+{
+  static MPWindowRegistry *sharedRegistry = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    sharedRegistry = [self new];
+  });
+  return sharedRegistry;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self) {
+    _windowsByScreen = [NSMapTable weakToStrongObjectsMapTable];
+    MPNotificationCenter *notificationCenter = [MPNotificationCenter notificationCenterForObject:self];
+    weakify(self);
+    void (^invalidateBlock)(NSNotification *) = ^(NSNotification *notification) {
+      strongify(self);
+      [self invalidate];
+    };
+    for (NSString *name in @[UIWindowDidBecomeVisibleNotification,
+                             UIWindowDidBecomeHiddenNotification,
+                             UIWindowDidBecomeKeyNotification,
+                             UIWindowDidResignKeyNotification,
+                             UIScreenDidConnectNotification,
+                             UIScreenDidDisconnectNotification]) {
+      [notificationCenter addNotificationWithName:name block:invalidateBlock];
+    }
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  [MPNotificationCenter removeAllObserversForObject:self];
+}
+
+- (void)invalidate
+{
+  [self.windowsByScreen removeAllObjects];
+  self.generation++;
+}
+
+- (NSPointerArray *)windowListForScreen:(nullable UIScreen *)screen
+{
+  NSPointerArray *windows = screen ? [self.windowsByScreen objectForKey:screen] : nil;
+  if (windows) {
+    return windows;
+  }
+  windows = [NSPointerArray weakObjectsPointerArray];
+  for (UIWindow *window in [UIApplication sharedApplication].windows) {
+    if (window.screen == screen) {
+      [windows addPointer:(__bridge void *)window];
+    }
+  }
+  if (screen) {
+    [self.windowsByScreen setObject:windows forKey:screen];
+  }
+  return windows;
+}
+
+- (void)enumerateWindowsAboveWindow:(UIWindow *)window usingBlock:(void (^)(UIWindow *aboveWindow))block
+{
+  // A list replaced while the block runs stays alive, and unchanged, until we are done with it.
+  NSPointerArray *windows = [self windowListForScreen:window.screen];
+  const NSUInteger count = windows.count;
+  NSUInteger index = 0;
+  while (index < count && [windows pointerAtIndex:index] != (__bridge void *)window) {
+    index++;
+  }
+  for (index++; index < count; index++) {
+    UIWindow *aboveWindow = (__bridge UIWindow *)[windows pointerAtIndex:index];
+    if (aboveWindow) {
+      block(aboveWindow);
+    }
+  }
+}
+
+- (NSArray<UIWindow *> *)windowsForScreen:(UIScreen *)screen
+{
+  return [self windowListForScreen:screen].allObjects;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -20,16 +20,33 @@
 
 #import "MPQualityRule.h"
 
+/**
+ Evaluates a set of rules against the same viewability ticks. Rule state is
+ kept in one packed array of plain structs that reset in place, so a tick is
+ a single pass that allocates nothing; statistics objects are only built for
+ the end callback.
+ */
 @interface MPQualityTest : NSObject
 
 + (nullable instancetype)testWithRule:(nonnull MPQualityRule *)rule;
 
++ (nullable instancetype)testWithRules:(nonnull NSArray<MPQualityRule *> *)rules;
+
 - (nullable instancetype)initWithRule:(nonnull MPQualityRule *)rule;
 
+- (nullable instancetype)initWithRules:(nonnull NSArray<MPQualityRule *> *)rules NS_DESIGNATED_INITIALIZER;
+
+// Media duration, for rules measured as a fraction of it
+- (void)registerDuration:(NSTimeInterval)duration;
+
 - (void)registerEnd;
 
 - (void)registerProgress:(NSTimeInterval)progress
            viewableRatio:(float)viewableRatio;
 
-@end
+// `volume` < 0 when unknown; audible rules then count the tick as ineligible.
+- (void)registerProgress:(NSTimeInterval)progress
+           viewableRatio:(float)viewableRatio
+                  volume:(float)volume;
 
+@end
@@ -0,0 +1,121 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MPQualityTest.h"
+
+#import <memory>
+#import <vector>
+
+#import "MPDefines+Internal.h"
+#import "MPQualityMetric+Internal.h"
+#import "MPQualityRuleEngine.hpp"
+
+@interface MPQualityTest ()
+{
+  // Compiled from rules, in the same order
+  std::unique_ptr<mp::QualityRuleEngine> _engine;
+}
+
+@property (nonatomic, copy, nonnull, readonly) NSArray<MPQualityRule *> *rules;
+
+@end
+
+@implementation MPQualityTest
+
++ (nullable instancetype)testWithRule:(MPQualityRule *)rule
+{
+  return [[self alloc] initWithRule:rule];
+}
+
++ (nullable instancetype)testWithRules:(NSArray<MPQualityRule *> *)rules
+{
+  return [[self alloc] initWithRules:rules];
+}
+
+- (nullable instancetype)initWithRule:(MPQualityRule *)rule
+{
+  return [self initWithRules:@[rule]];
+}
+
+- (nullable instancetype)initWithRules:(NSArray<MPQualityRule *> *)rules
+{
+  self = [super init];
+  if (self) {
+    _rules = [rules copy];
+    std::vector<mp::QualityRuleSpec> specs;
+    specs.reserve(rules.count);
+    for (MPQualityRule *rule in rules) {
+      mp::QualityRuleSpec spec;
+      spec.viewableRatio = rule.viewableRatio;
+      spec.viewableSeconds = rule.viewableSeconds;
+      spec.durationFraction = rule.viewableDurationFraction;
+      spec.continuous = rule.isContinuous;
+      spec.audibleVolume = rule.audibleVolume;
+      specs.push_back(spec);
+    }
+    _engine.reset(new mp::QualityRuleEngine(specs));
+  }
+  return self;
+}
+
+- (nullable instancetype)init
+{
+  return [self initWithRules:@[]];
+}
+
+- (void)registerDuration:(NSTimeInterval)duration
+{
+  _engine->setDuration(duration);
+}
+
+- (void)registerEnd
+{
+  _engine->registerEnd([self](std::size_t index, bool complete, bool passed, const mp::QualityAccumulator &viewability, const mp::QualityAccumulator &audibility) {
+    [self onEndRuleAtIndex:index complete:complete passed:passed viewability:viewability audibility:audibility];
+  });
+}
+
+- (void)registerProgress:(NSTimeInterval)progress
+           viewableRatio:(float)viewableRatio
+{
+  [self registerProgress:progress viewableRatio:viewableRatio volume:-1.0f];
+}
+
+- (void)registerProgress:(NSTimeInterval)progress
+           viewableRatio:(float)viewableRatio
+                  volume:(float)volume
+{
+  _engine->registerProgress(progress, viewableRatio, volume, [self](std::size_t index, bool complete, bool passed, const mp::QualityAccumulator &viewability, const mp::QualityAccumulator &audibility) {
+    [self onEndRuleAtIndex:index complete:complete passed:passed viewability:viewability audibility:audibility];
+  });
+}
+
+- (void)onEndRuleAtIndex:(std::size_t)index
+                complete:(BOOL)complete
+                  passed:(BOOL)passed
+             viewability:(const mp::QualityAccumulator &)viewability
+              audibility:(const mp::QualityAccumulator &)audibility
+{
+  MPQualityRule *rule = self.rules[index];
+  MPQualityStatistics *endStatistics = [[MPQualityStatistics alloc] initWithViewableThreshold:rule.viewableRatio];
+  [endStatistics.viewabilityStatistics setState:viewability];
+  [endStatistics.audibilityStatistics setState:audibility];
+  FB_BLOCK_CALL_SAFE(rule.endCallback, complete, passed, (id)endStatistics);
+}
+
+@end
@@ -0,0 +1,485 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Stress checks and contention benchmarks for the portable concurrent
+// containers behind MPConcurrentArray, MPConcurrentQueue and the event
+// manager's in-transit set.
+//
+//   c++ -std=c++14 -O2 -pthread -I SDKMeasurementPlugin/Classes -o mp_concurrent_bench SDKMeasurementPlugin/Tools/MPConcurrentContainersBench.cpp
+//   ./mp_concurrent_bench [--threads N] [--producers P] [--consumers C] [--seconds S]
+//
+// Build with -fsanitize=thread (and -O1 -g) to run the checks under
+// ThreadSanitizer; the benchmarks still run but their numbers mean nothing
+// there. Checks print FAIL lines and make the exit status non-zero. Each
+// benchmark line compares the container with the mutex-guarded structure it
+// replaced, at 1..N threads; the FIFO line runs P producers against C
+// consumers.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "MPConcurrentFIFO.hpp"
+#include "MPShardedSet.hpp"
+#include "MPSnapshotVector.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+// Runs `body(thread index)` on `threads` threads and waits for all of them.
+void runThreads(int threads, const std::function<void(int)> &body)
+{
+  std::vector<std::thread> pool;
+  for (int i = 0; i < threads; i++) {
+    pool.emplace_back(body, i);
+  }
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+}
+
+void checkSnapshotVectorBasics()
+{
+  mp::SnapshotVector<long> vector;
+  check(vector.empty(), "snapshot vector starts empty");
+  for (long i = 0; i < 100; i++) {
+    vector.push_back(i);
+  }
+  const auto before = vector.snapshot();
+  // Forces several regrowths while `before` pins the old buffers.
+  for (long i = 100; i < 1000; i++) {
+    vector.push_back(i);
+  }
+  check(before->size() == 100, "old snapshot keeps its size across appends");
+  bool prefix = true;
+  for (long i = 0; i < 100; i++) {
+    prefix &= (*before)[i] == i;
+  }
+  check(prefix, "old snapshot keeps its elements across appends");
+  check(vector.size() == 1000, "appends are all published");
+
+  vector.update([](std::vector<long> &items) { items.erase(items.begin()); });
+  const auto erased = vector.snapshot();
+  check(erased->size() == 999 && (*erased)[0] == 1, "update publishes the mutated copy");
+  vector.push_back(1000);
+  check(erased->size() == 999 && vector.snapshot()->size() == 1000, "append after update leaves the older version alone");
+
+  try {
+    vector.update([](std::vector<long> &items) {
+      items.clear();
+      throw 1;
+    });
+  } catch (int) {
+  }
+  check(vector.size() == 1000, "a throwing mutator publishes nothing");
+
+  vector.clear();
+  check(vector.empty() && erased->size() == 999, "clear leaves existing snapshots alone");
+}
+
+// Versions are released once nothing references them, and not before.
+void checkSnapshotVectorReclamation()
+{
+  auto tracked = std::make_shared<long>(7);
+  mp::SnapshotVector<std::shared_ptr<long>> vector;
+  vector.push_back(tracked);
+  auto pinned = vector.snapshot();
+  for (int i = 0; i < 64; i++) {
+    vector.push_back(std::make_shared<long>(i));
+  }
+  vector.clear();
+  check(tracked.use_count() > 1, "pinned version stays alive after clear");
+  check(*(*pinned)[0] == 7, "pinned version is readable after clear");
+  pinned.reset();
+  check(tracked.use_count() == 1, "last snapshot releases the version");
+}
+
+// One writer per thread appends an increasing sequence tagged with its
+// index while readers check that every snapshot holds, per writer, a gapless
+// prefix of that sequence.
+void checkSnapshotVectorConcurrency(int threads)
+{
+  constexpr long kAppends = 20000;
+  mp::SnapshotVector<long> vector;
+  std::atomic<int> writersDone(0);
+  std::atomic<bool> consistent(true);
+  const int writers = std::max(1, threads / 2);
+  const int readers = std::max(1, threads - writers);
+  runThreads(writers + readers, [&](int index) {
+    if (index < writers) {
+      for (long i = 0; i < kAppends; i++) {
+        vector.push_back(i * writers + index);
+      }
+      writersDone++;
+      return;
+    }
+    do {
+      const auto snapshot = vector.snapshot();
+      std::vector<long> next(writers, 0);
+      for (long value : *snapshot) {
+        const int writer = (int)(value % writers);
+        if (value / writers != next[writer]++) {
+          consistent = false;
+        }
+      }
+    } while (writersDone.load() < writers);
+  });
+  check(consistent.load(), "concurrent snapshots are consistent prefixes");
+  check(vector.size() == (std::size_t)(kAppends * writers), "concurrent appends are all published");
+}
+
+void checkShardedSetConcurrency(int threads)
+{
+  constexpr long kKeys = 20000;
+  mp::ShardedSet<long> set;
+  runThreads(threads, [&](int index) {
+    for (long key = index; key < kKeys; key += threads) {
+      set.insert(key);
+    }
+    for (long key = index; key < kKeys; key += threads) {
+      if (key % 2 == 0) {
+        set.erase(key);
+      }
+    }
+  });
+  check(set.size() == (std::size_t)kKeys / 2, "sharded set size after concurrent insert and erase");
+  bool members = true;
+  for (long key = 0; key < kKeys; key++) {
+    members &= set.contains(key) == (key % 2 == 1);
+  }
+  check(members, "sharded set membership after concurrent insert and erase");
+  check(!set.insert(1) && set.insert(0), "sharded set insert reports presence");
+  std::vector<long> values = set.values();
+  check(values.size() == set.size(), "sharded set values match size");
+  set.clear();
+  check(set.empty(), "sharded set clear");
+}
+
+void checkFIFOBasics()
+{
+  mp::ConcurrentFIFO<long> fifo;
+  long value = -1;
+  check(fifo.empty() && !fifo.tryPop(value) && !fifo.tryPeek(value), "fifo starts empty");
+  check(!fifo.popWait(value, std::chrono::milliseconds(1)), "popWait times out on an empty fifo");
+  for (long i = 0; i < 10; i++) {
+    fifo.push(i);
+  }
+  check(fifo.tryPeek(value) && value == 0, "peek sees the oldest element");
+  check(fifo.tryPop(value) && value == 0, "pop takes the oldest element");
+  fifo.push(10);
+  // Equal values are distinct entries, unlike the old removeObject: pop.
+  fifo.push(10);
+  mp::ConcurrentFIFO<long>::Batch batch = fifo.popAll();
+  std::vector<long> drained;
+  batch.forEach([&](long item) { drained.push_back(item); });
+  check(drained == std::vector<long>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10}), "popAll drains in order");
+  check(batch.size() == drained.size() && fifo.empty(), "popAll leaves the fifo empty");
+}
+
+// Producers push increasing sequences tagged with their index. Consumers mix
+// tryPop, popWait and popAll; every element must arrive exactly once and
+// each consumer must see every producer's elements in order.
+void checkFIFOConcurrency(int producers, int consumers)
+{
+  constexpr long kPushes = 20000;
+  mp::ConcurrentFIFO<long> fifo;
+  std::atomic<int> producersDone(0);
+  std::atomic<bool> ordered(true);
+  std::vector<std::vector<long>> received(consumers);
+  runThreads(producers + consumers, [&](int index) {
+    if (index < producers) {
+      for (long i = 0; i < kPushes; i++) {
+        fifo.push(i * producers + index);
+      }
+      producersDone++;
+      return;
+    }
+    const int consumer = index - producers;
+    std::vector<long> &values = received[consumer];
+    std::vector<long> last(producers, -1);
+    auto accept = [&](long value) {
+      const int producer = (int)(value % producers);
+      if (value / producers <= last[producer]) {
+        ordered = false;
+      }
+      last[producer] = value / producers;
+      values.push_back(value);
+    };
+    for (long round = 0;; round++) {
+      long value;
+      if (round % 16 == 0) {
+        fifo.popAll().forEach(accept);
+      } else if (round % 2 == 0 ? fifo.popWait(value, std::chrono::milliseconds(1)) : fifo.tryPop(value)) {
+        accept(value);
+      } else if (producersDone.load() == producers && fifo.empty()) {
+        break;
+      }
+    }
+  });
+  std::vector<long> all;
+  for (const std::vector<long> &values : received) {
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  std::sort(all.begin(), all.end());
+  bool exactlyOnce = all.size() == (std::size_t)(kPushes * producers);
+  for (std::size_t i = 0; exactlyOnce && i < all.size(); i++) {
+    exactlyOnce = all[i] == (long)i;
+  }
+  check(exactlyOnce, "fifo delivers every element exactly once");
+  check(ordered.load(), "fifo keeps each producer's order");
+}
+
+// The storage MPConcurrentArray had before: a vector behind a recursive
+// mutex, read by copying under the lock.
+class LockedVector {
+ public:
+  void push_back(long value)
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    _items.push_back(value);
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    return _items.size();
+  }
+
+  long at(std::size_t index) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    return _items[index];
+  }
+
+ private:
+  mutable std::recursive_mutex _lock;
+  std::vector<long> _items;
+};
+
+class LockedSet {
+ public:
+  bool insert(long value)
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _items.insert(value).second;
+  }
+
+  bool contains(long value) const
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _items.count(value) > 0;
+  }
+
+ private:
+  mutable std::mutex _lock;
+  std::unordered_set<long> _items;
+};
+
+// The shape MPConcurrentQueue had before: a deque behind one lock that
+// producers and consumers share.
+class LockedQueue {
+ public:
+  void push(long value)
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _items.push_back(value);
+  }
+
+  bool tryPop(long &value)
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_items.empty()) {
+      return false;
+    }
+    value = _items.front();
+    _items.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex _lock;
+  std::deque<long> _items;
+};
+
+// Runs `operation(thread, iteration)` on `threads` threads for `seconds` and
+// returns the combined rate in millions of operations per second.
+double throughput(int threads, double seconds, const std::function<void(int, long)> &operation)
+{
+  std::atomic<bool> stop(false);
+  std::atomic<long> total(0);
+  std::vector<std::thread> pool;
+  for (int i = 0; i < threads; i++) {
+    pool.emplace_back([&, i] {
+      long count = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (int batch = 0; batch < 64; batch++) {
+          operation(i, count++);
+        }
+      }
+      total += count;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop = true;
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+  return total.load() / seconds / 1e6;
+}
+
+// Read-mostly array traffic: one append per 64 operations, the rest read a
+// count and an element, as the event manager does with its pending events.
+void benchmarkArray(int threads, double seconds)
+{
+  mp::SnapshotVector<long> snapshotVector;
+  LockedVector lockedVector;
+  for (long i = 0; i < 1024; i++) {
+    snapshotVector.push_back(i);
+    lockedVector.push_back(i);
+  }
+  std::atomic<long> sink(0);
+  const double snapshotRate = throughput(threads, seconds, [&](int, long iteration) {
+    if (iteration % 64 == 0) {
+      snapshotVector.push_back(iteration);
+    } else {
+      const auto snapshot = snapshotVector.snapshot();
+      sink.fetch_add((*snapshot)[iteration % snapshot->size()], std::memory_order_relaxed);
+    }
+  });
+  const double lockedRate = throughput(threads, seconds, [&](int, long iteration) {
+    if (iteration % 64 == 0) {
+      lockedVector.push_back(iteration);
+    } else {
+      sink.fetch_add(lockedVector.at(iteration % lockedVector.size()), std::memory_order_relaxed);
+    }
+  });
+  std::printf("array   threads=%-3d snapshot=%8.2f Mops/s  locked=%8.2f Mops/s\n", threads, snapshotRate, lockedRate);
+}
+
+// Membership tests with one insert in eight, spread over distinct keys.
+void benchmarkSet(int threads, double seconds)
+{
+  mp::ShardedSet<long> shardedSet;
+  LockedSet lockedSet;
+  std::atomic<long> sink(0);
+  const double shardedRate = throughput(threads, seconds, [&](int thread, long iteration) {
+    const long key = (iteration << 6) | thread;
+    if (iteration % 8 == 0) {
+      shardedSet.insert(key);
+    } else if (shardedSet.contains(key)) {
+      sink.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  const double lockedRate = throughput(threads, seconds, [&](int thread, long iteration) {
+    const long key = (iteration << 6) | thread;
+    if (iteration % 8 == 0) {
+      lockedSet.insert(key);
+    } else if (lockedSet.contains(key)) {
+      sink.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  std::printf("set     threads=%-3d sharded=%9.2f Mops/s  locked=%8.2f Mops/s\n", threads, shardedRate, lockedRate);
+}
+
+// Producers push as fast as they can while consumers pop; the rate is the
+// number of elements that made it through.
+template <typename Queue>
+double fifoThroughput(Queue &queue, int producers, int consumers, double seconds)
+{
+  std::atomic<long> popped(0);
+  throughput(producers + consumers, seconds, [&](int thread, long iteration) {
+    long value;
+    if (thread < producers) {
+      queue.push(iteration);
+    } else if (queue.tryPop(value)) {
+      popped.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  return popped.load() / seconds / 1e6;
+}
+
+void benchmarkFIFO(int producers, int consumers, double seconds)
+{
+  mp::ConcurrentFIFO<long> fifo;
+  LockedQueue lockedQueue;
+  const double fifoRate = fifoThroughput(fifo, producers, consumers, seconds);
+  const double lockedRate = fifoThroughput(lockedQueue, producers, consumers, seconds);
+  std::printf("fifo    producers=%-3d consumers=%-3d fifo=%8.2f Mops/s  locked=%8.2f Mops/s\n", producers, consumers, fifoRate, lockedRate);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int threads = (int)std::max(2u, std::thread::hardware_concurrency());
+  int producers = 0;
+  int consumers = 0;
+  double seconds = 0.5;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::max(1, (int)std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--producers") == 0 && i + 1 < argc) {
+      producers = std::max(1, (int)std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--consumers") == 0 && i + 1 < argc) {
+      consumers = std::max(1, (int)std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = std::max(0.01, std::strtod(argv[++i], nullptr));
+    }
+  }
+
+  checkSnapshotVectorBasics();
+  checkSnapshotVectorReclamation();
+  checkSnapshotVectorConcurrency(threads);
+  checkShardedSetConcurrency(threads);
+  if (producers == 0) {
+    producers = std::max(1, threads / 2);
+  }
+  if (consumers == 0) {
+    consumers = std::max(1, threads - producers);
+  }
+  checkFIFOBasics();
+  checkFIFOConcurrency(producers, consumers);
+
+  for (int count = 1; count <= threads; count *= 2) {
+    benchmarkArray(count, seconds);
+  }
+  for (int count = 1; count <= threads; count *= 2) {
+    benchmarkSet(count, seconds);
+  }
+  benchmarkFIFO(producers, consumers, seconds);
+  return failures == 0 ? 0 : 1;
+}
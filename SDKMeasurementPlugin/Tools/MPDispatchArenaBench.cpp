@@ -0,0 +1,363 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Checks for mp::Arena and the dispatch queries built in it, plus an
+// allocation and peak-RSS benchmark of a dispatch batch's native core against
+// the std::vector/std::string version it replaced.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_dispatch_arena_bench SDKMeasurementPlugin/Tools/MPDispatchArenaBench.cpp SDKMeasurementPlugin/Classes/MPUUID.cpp
+//   ./mp_dispatch_arena_bench [--events N] [--batches B] [--seed S]
+//
+// The checks run first; any failure is printed and makes the exit status
+// non-zero. Each benchmark line runs B batches over a backlog of N events in
+// a child process: collect and dedupe the token ids, build the tokens query,
+// then the SELECT and DELETE statements for every event id the server
+// acknowledged. Allocations count operator new plus the arena's own chunk
+// mallocs; peak RSS is the child's.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "MPDispatchQuery.hpp"
+
+namespace {
+
+std::size_t newCount = 0;
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+  newCount++;
+  if (void *pointer = std::malloc(size ? size : 1)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed ? seed : 1) {}
+
+  uint64_t next()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  std::size_t below(std::size_t bound)
+  {
+    return (std::size_t)(next() % bound);
+  }
+
+ private:
+  uint64_t _state;
+};
+
+MPUUID randomUUID(Random &random)
+{
+  const MPUUID uuid = {random.next(), random.next()};
+  return uuid;
+}
+
+// Frozen copy of the heap-based builders the arena replaced; the arena
+// versions must produce exactly the same statements.
+void legacyAppendUUIDString(std::string &string, MPUUID uuid)
+{
+  char text[MPUUIDStringLength + 1];
+  MPUUIDFormat(uuid, text);
+  string.append(text, MPUUIDStringLength);
+}
+
+std::string legacyEventIdQuery(const char *prefix, const std::vector<MPUUID> &eventIds)
+{
+  std::string query(prefix);
+  query.reserve(query.size() + eventIds.size() * 52);
+  bool next = false;
+  for (const MPUUID &eventId : eventIds) {
+    if (next) {
+      query.append(" OR ");
+    }
+    query.append("eventId = \"");
+    legacyAppendUUIDString(query, eventId);
+    query.append("\"");
+    next = true;
+  }
+  return query;
+}
+
+std::string legacyTokenQuery(std::vector<MPUUID> &tokenIds)
+{
+  std::sort(tokenIds.begin(), tokenIds.end());
+  tokenIds.erase(std::unique(tokenIds.begin(), tokenIds.end()), tokenIds.end());
+  std::string query("SELECT * FROM tokens WHERE ");
+  query.reserve(32 + tokenIds.size() * 50);
+  for (const MPUUID &tokenId : tokenIds) {
+    query.append("tokenId = \"");
+    legacyAppendUUIDString(query, tokenId);
+    query.append("\" OR ");
+  }
+  query.append("1");
+  return query;
+}
+
+struct Backlog {
+  std::vector<MPUUID> eventIds;
+  std::vector<MPUUID> tokenIds; // per event, with repeats
+};
+
+Backlog makeBacklog(Random &random, std::size_t events)
+{
+  Backlog backlog;
+  std::vector<MPUUID> tokens;
+  for (std::size_t i = 0; i < events / 10 + 1; i++) {
+    tokens.push_back(randomUUID(random));
+  }
+  for (std::size_t i = 0; i < events; i++) {
+    backlog.eventIds.push_back(randomUUID(random));
+    backlog.tokenIds.push_back(tokens[random.below(tokens.size())]);
+  }
+  return backlog;
+}
+
+void checkArena(Random &random)
+{
+  mp::Arena arena(256);
+  bool aligned = true;
+  for (int i = 0; i < 1000; i++) {
+    const std::size_t alignment = (std::size_t)1 << random.below(5);
+    void *pointer = arena.allocate(1 + random.below(100), alignment);
+    aligned = aligned && ((uintptr_t)pointer % alignment) == 0;
+  }
+  check(aligned, "allocations are aligned");
+  check(arena.stats().allocations == 1000, "allocations are counted");
+
+  mp::ArenaVector<MPUUID> ids(arena, 1);
+  std::vector<MPUUID> expected;
+  for (int i = 0; i < 5000; i++) {
+    const MPUUID uuid = randomUUID(random);
+    ids.push_back(uuid);
+    expected.push_back(uuid);
+    if (i % 7 == 0) {
+      arena.allocate(24); // so the vector cannot always grow in place
+    }
+  }
+  check(ids.size() == expected.size() && std::equal(ids.begin(), ids.end(), expected.begin()),
+        "ArenaVector keeps its values across growth");
+
+  arena.reset();
+  check(arena.stats().allocations == 0 && arena.stats().bytes == 0, "reset clears the batch stats");
+  for (int round = 0; round < 3; round++) {
+    arena.reset();
+    mp::ArenaVector<MPUUID> again(arena, 1);
+    for (int i = 0; i < 5000; i++) {
+      again.push_back(randomUUID(random));
+    }
+  }
+  check(arena.stats().systemAllocations == 0, "a repeated batch reuses the kept chunk");
+}
+
+void checkQueries(Random &random)
+{
+  const Backlog backlog = makeBacklog(random, 300);
+  mp::Arena arena;
+
+  std::vector<MPUUID> legacyTokenIds = backlog.tokenIds;
+  mp::ArenaVector<MPUUID> tokenIds(arena, backlog.tokenIds.size());
+  for (const MPUUID &tokenId : backlog.tokenIds) {
+    tokenIds.push_back(tokenId);
+  }
+  const std::string expectedTokenQuery = legacyTokenQuery(legacyTokenIds);
+  check(expectedTokenQuery == mp::tokenQuery(arena, tokenIds), "token query matches");
+  check(tokenIds.size() == legacyTokenIds.size(), "token ids are deduplicated");
+
+  mp::ArenaVector<MPUUID> eventIds(arena);
+  for (const MPUUID &eventId : backlog.eventIds) {
+    eventIds.push_back(eventId);
+  }
+  check(legacyEventIdQuery("DELETE FROM events WHERE ", backlog.eventIds) ==
+        mp::eventIdQuery(arena, "DELETE FROM events WHERE ", eventIds), "event id query matches");
+  mp::ArenaVector<MPUUID> noIds(arena);
+  check(std::strcmp(mp::eventIdQuery(arena, "SELECT * FROM events WHERE ", noIds), "SELECT * FROM events WHERE ") == 0,
+        "event id query without ids");
+
+  mp::ArenaVector<MPUUID> noTokens(arena);
+  check(std::strcmp(mp::tokenQuery(arena, noTokens), "SELECT * FROM tokens WHERE 1") == 0, "token query without tokens");
+}
+
+std::size_t sink = 0;
+
+std::size_t runLegacyBatch(const Backlog &backlog)
+{
+  std::string eventQuery("SELECT * FROM events");
+  std::vector<MPUUID> tokenIds;
+  tokenIds.reserve(backlog.tokenIds.size());
+  for (const MPUUID &tokenId : backlog.tokenIds) {
+    tokenIds.push_back(tokenId);
+  }
+  const std::string tokenQuery = legacyTokenQuery(tokenIds);
+  std::vector<MPUUID> eventIdsToCleanup;
+  for (const MPUUID &eventId : backlog.eventIds) {
+    eventIdsToCleanup.push_back(eventId);
+  }
+  const std::string selectQuery = legacyEventIdQuery("SELECT * FROM events WHERE ", eventIdsToCleanup);
+  const std::string deleteQuery = legacyEventIdQuery("DELETE FROM events WHERE ", eventIdsToCleanup);
+  return eventQuery.size() + tokenQuery.size() + selectQuery.size() + deleteQuery.size();
+}
+
+// The event manager's two arena blocks: the dispatch and its response.
+std::size_t runArenaBatch(mp::Arena &arena, const Backlog &backlog)
+{
+  arena.reset();
+  mp::ArenaString eventQuery(arena);
+  eventQuery.append("SELECT * FROM events");
+  mp::ArenaVector<MPUUID> tokenIds(arena, backlog.tokenIds.size());
+  for (const MPUUID &tokenId : backlog.tokenIds) {
+    tokenIds.push_back(tokenId);
+  }
+  const std::size_t tokenQuerySize = std::strlen(mp::tokenQuery(arena, tokenIds));
+
+  arena.reset();
+  auto *eventIdsToCleanup = arena.make<mp::ArenaVector<MPUUID>>(arena, 64);
+  for (const MPUUID &eventId : backlog.eventIds) {
+    eventIdsToCleanup->push_back(eventId);
+  }
+  const char *selectQuery = mp::eventIdQuery(arena, "SELECT * FROM events WHERE ", *eventIdsToCleanup);
+  const char *deleteQuery = mp::eventIdQuery(arena, "DELETE FROM events WHERE ", *eventIdsToCleanup);
+  return eventQuery.size() + tokenQuerySize + std::strlen(selectQuery) + std::strlen(deleteQuery);
+}
+
+struct Result {
+  double seconds;
+  std::size_t allocations;
+};
+
+// Runs in a child process so that each variant's peak RSS is its own.
+void benchmark(const char *label, std::size_t events, int batches, uint64_t seed, bool useArena)
+{
+  std::fflush(stdout);
+  int fds[2];
+  if (pipe(fds) != 0) {
+    check(false, "pipe");
+    return;
+  }
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    Random random(seed);
+    const Backlog backlog = makeBacklog(random, events);
+    mp::Arena arena;
+    const std::size_t startCount = newCount;
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t systemAllocations = 0;
+    for (int i = 0; i < batches; i++) {
+      if (useArena) {
+        sink += runArenaBatch(arena, backlog);
+        systemAllocations += arena.stats().systemAllocations;
+      } else {
+        sink += runLegacyBatch(backlog);
+      }
+    }
+    const Result result = {
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+      newCount - startCount + systemAllocations,
+    };
+    const ssize_t written = write(fds[1], &result, sizeof(result));
+    _exit(written == (ssize_t)sizeof(result) && sink > 0 ? 0 : 1);
+  }
+  close(fds[1]);
+  Result result = {0, 0};
+  const ssize_t got = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status = 0;
+  struct rusage usage;
+  std::memset(&usage, 0, sizeof(usage));
+  wait4(pid, &status, 0, &usage);
+  check(got == (ssize_t)sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0, "benchmark child");
+  std::printf("%-6s %7zu events  %9.3f ms/batch  %8.2f allocations/batch  peak RSS %7ld KB\n", label, events,
+              result.seconds * 1000.0 / batches, (double)result.allocations / batches, usage.ru_maxrss);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t events = 0;
+  int batches = 50;
+  uint64_t seed = 0x5EEDull;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--events") == 0) {
+      events = (std::size_t)std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--batches") == 0) {
+      batches = std::atoi(argv[i + 1]);
+    } else if (std::strcmp(argv[i], "--seed") == 0) {
+      seed = std::strtoull(argv[i + 1], nullptr, 0);
+    }
+  }
+  Random random(seed);
+
+  checkArena(random);
+  checkQueries(random);
+
+  const std::size_t defaultSizes[] = {1000, 10000, 100000};
+  for (std::size_t size : defaultSizes) {
+    if (events != 0 && size != defaultSizes[0]) {
+      break;
+    }
+    const std::size_t backlog = events != 0 ? events : size;
+    benchmark("heap", backlog, batches < 1 ? 1 : batches, seed, false);
+    benchmark("arena", backlog, batches < 1 ? 1 : batches, seed, true);
+  }
+
+  std::printf("%s\n", failures == 0 ? "OK" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Latency-bound checks for the debouncer behind immediate event dispatch,
+// on simulated time.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_debouncer_test SDKMeasurementPlugin/Tools/MPDispatchDebouncerTest.cpp
+//   ./mp_debouncer_test [--delay S] [--max-wait S]
+//
+// Each request stream is replayed the way MPEventManager drives the
+// debouncer: a request re-arms the flush timer at the returned deadline, and
+// the flush resets the debouncer. One line per stream gives the flush count
+// and the delivery latency of its requests. A request delivered later than
+// the max wait prints a FAIL line and makes the exit status non-zero.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "MPDispatchDebouncer.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char *stream, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s: %s\n", stream, what);
+    failures++;
+  }
+}
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed) {}
+
+  double uniform(double low, double high)
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return low + (high - low) * (double)(_state >> 11) / (double)(1ULL << 53);
+  }
+
+ private:
+  uint64_t _state;
+};
+
+std::vector<double> steadyStream(double interval, double duration)
+{
+  std::vector<double> times;
+  for (double time = 0; time < duration; time += interval) {
+    times.push_back(time);
+  }
+  return times;
+}
+
+// Bursts of closely spaced requests separated by quiet gaps.
+std::vector<double> burstyStream(Random &random, double duration)
+{
+  std::vector<double> times;
+  for (double time = 0; time < duration;) {
+    const int burst = (int)random.uniform(1, 40);
+    for (int i = 0; i < burst; i++) {
+      times.push_back(time);
+      time += random.uniform(0.001, 0.05);
+    }
+    time += random.uniform(0.1, 5);
+  }
+  return times;
+}
+
+// Poisson arrivals at `rate` per second.
+std::vector<double> poissonStream(Random &random, double rate, double duration)
+{
+  std::vector<double> times;
+  for (double time = 0; time < duration; time -= std::log(random.uniform(1e-12, 1)) / rate) {
+    times.push_back(time);
+  }
+  return times;
+}
+
+double percentile(std::vector<double> values, double fraction)
+{
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[std::min(values.size() - 1, (std::size_t)(fraction * values.size()))];
+}
+
+void replay(const char *name, const std::vector<double> &requests, double delay, double maxWait)
+{
+  mp::DispatchDebouncer debouncer;
+  std::vector<double> pending;
+  std::vector<double> latencies;
+  std::size_t flushes = 0;
+  double timer = INFINITY;
+  bool deadlinesOk = true;
+
+  auto flushUntil = [&](double time) {
+    if (!pending.empty() && timer <= time) {
+      for (double requested : pending) {
+        latencies.push_back(timer - requested);
+      }
+      pending.clear();
+      debouncer.reset();
+      timer = INFINITY;
+      flushes++;
+    }
+  };
+
+  for (double now : requests) {
+    flushUntil(now);
+    const double previous = debouncer.armed() ? debouncer.deadline() : -INFINITY;
+    const double deadline = debouncer.request(now, delay, maxWait);
+    // A request may only postpone the flush, never pull it in or let it
+    // fire before `delay` has passed for the first request.
+    deadlinesOk &= deadline >= previous && deadline >= now && (pending.empty() ? deadline == now + delay : true);
+    pending.push_back(now);
+    timer = deadline;
+  }
+  flushUntil(INFINITY);
+
+  const double bound = std::max(delay, maxWait);
+  const double worst = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+  check(latencies.size() == requests.size(), name, "every request is delivered");
+  check(worst <= bound + 1e-9, name, "latency stays within the max wait");
+  check(deadlinesOk, name, "deadlines only move out, and start at now + delay");
+  std::printf("%-16s requests=%-6zu flushes=%-6zu latency p50=%.3fs p99=%.3fs max=%.3fs (bound %.3fs)\n",
+              name, requests.size(), flushes, percentile(latencies, 0.5), percentile(latencies, 0.99), worst, bound);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  double delay = 0.5;
+  double maxWait = 2;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+      delay = std::max(0.0, std::strtod(argv[++i], nullptr));
+    } else if (std::strcmp(argv[i], "--max-wait") == 0 && i + 1 < argc) {
+      maxWait = std::max(0.0, std::strtod(argv[++i], nullptr));
+    }
+  }
+
+  // The case the debouncer was written for: requests closer together than
+  // the delay used to postpone delivery forever.
+  mp::DispatchDebouncer debouncer;
+  double deadline = 0;
+  for (double now = 0; now < 10 && !(debouncer.armed() && now >= deadline); now += 0.3) {
+    deadline = debouncer.request(now, 0.5, 2);
+  }
+  check(deadline == 2, "steady-0.3s", "a stream every 0.3 s with delay 0.5 s flushes at the 2 s max wait");
+
+  Random random(0x9e3779b97f4a7c15ULL);
+  replay("single", {0}, delay, maxWait);
+  replay("steady-fast", steadyStream(delay / 10, 60), delay, maxWait);
+  replay("steady-slow", steadyStream(delay * 3, 60), delay, maxWait);
+  replay("bursty", burstyStream(random, 600), delay, maxWait);
+  replay("poisson-1/s", poissonStream(random, 1, 600), delay, maxWait);
+  replay("poisson-50/s", poissonStream(random, 50, 600), delay, maxWait);
+  replay("max-below-delay", steadyStream(delay / 10, 60), delay, delay / 2);
+  return failures == 0 ? 0 : 1;
+}
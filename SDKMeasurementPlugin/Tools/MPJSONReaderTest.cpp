@@ -0,0 +1,242 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Conformance checks and throughput benchmark for the on-demand JSON reader
+// used for dispatch responses and stored event extra data.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_json_reader_test SDKMeasurementPlugin/Tools/MPJSONReaderTest.cpp
+//   ./mp_json_reader_test [--repeat N] [file.json...]
+//
+// Documents must be accepted or rejected as RFC 8259 says, with two
+// deliberate departures: unpaired surrogate escapes are rejected, and UTF-8
+// validity is left to the NSString conversion that follows. Failures print
+// FAIL lines and make the exit status non-zero. Throughput lines follow, for
+// a synthetic dispatch response and for any files given.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "MPJSONReader.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string &what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what.c_str());
+    failures++;
+  }
+}
+
+// How MPPayloadDecoder validates stored extra data, for any top-level type.
+bool accepts(const std::string &json)
+{
+  mp::JSONReader reader(json.data(), json.size());
+  return reader.peek() != mp::JSONReader::Type::Invalid && reader.skipValue() && reader.atEnd();
+}
+
+void checkDocuments()
+{
+  const char *valid[] = {
+    "{}", "[]", "\"\"", "0", "-0", "1", "-1", "0.5", "-0.5e10", "1E+2", "1e-2", "123456789012345678901234567890",
+    "true", "false", "null", " \t\r\n[ 1 , 2 ] \n",
+    "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}",
+    "[[],{},[[]],[{}],{\"a\":[]}]",
+    "[{},1]", "[[],1]", "{\"a\":{},\"b\":1}",
+    "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"", "\"\\u0000\"", "\"\\u00e9\\uD83D\\uDE00\"",
+    "\"caf\xc3\xa9\"", "{\"\":\"\"}", "{\"a\":1,\"a\":2}",
+  };
+  for (const char *json : valid) {
+    check(accepts(json), std::string("accepts ") + json);
+  }
+
+  const std::string withNul("\"a\0b\"", 5);
+  const char *invalid[] = {
+    "", " ", "{", "}", "[", "]", "[1,]", "[,1]", "[1 2]", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "{,}", "{a:1}",
+    "{'a':1}", "{\"a\" 1}", "{1:1}", "[\"a\"", "\"abc", "\"\\x\"", "\"\\u12\"", "\"\\u12G4\"",
+    "\"tab\there\"", "\"new\nline\"", "01", "-", "+1", ".5", "1.", "1.e5", "1e", "1e+", "0x10", "NaN",
+    "Infinity", "-Infinity", "tru", "truex", "nul", "True", "[1]x", "{}{}", "[]]", "\"\\uD83D\"",
+    "\"\\uDE00\"", "\"\\uD83D\\u0041\"", "[1,,2]", "/* comment */ 1",
+  };
+  for (const char *json : invalid) {
+    check(!accepts(json), std::string("rejects ") + json);
+  }
+  check(!accepts(withNul), "rejects a raw NUL in a string");
+
+  std::string deep(mp::JSONReader::kMaxDepth + 1, '[');
+  deep += std::string(mp::JSONReader::kMaxDepth + 1, ']');
+  check(accepts(deep), "accepts nesting up to the depth limit");
+  std::string tooDeep(100000, '[');
+  tooDeep += std::string(100000, ']');
+  check(!accepts(tooDeep), "rejects nesting past the depth limit without overflowing the stack");
+
+  // Every prefix of a valid document is invalid, and must fail without
+  // reading past the end.
+  const std::string document = "{\"a\":[1,-2.5e3,\"x\\u00e9\",true,false,null,{\"b\":{}}]}";
+  for (std::size_t length = 0; length < document.size(); length++) {
+    const std::string prefix = document.substr(0, length);
+    std::vector<char> exact(prefix.begin(), prefix.end());
+    mp::JSONReader reader(exact.data(), exact.size());
+    check(!(reader.peek() != mp::JSONReader::Type::Invalid && reader.skipValue() && reader.atEnd()),
+          "rejects truncated document of length " + std::to_string(length));
+  }
+}
+
+std::string readString(const std::string &json)
+{
+  mp::JSONReader reader(json.data(), json.size());
+  std::string scratch;
+  const char *value;
+  std::size_t length;
+  if (!reader.readString(value, length, scratch) || !reader.atEnd()) {
+    return "<invalid>";
+  }
+  return std::string(value, length);
+}
+
+void checkStrings()
+{
+  check(readString("\"plain\"") == "plain", "reads an unescaped string");
+  check(readString("\"a\\\"b\\\\c\\/d\"") == "a\"b\\c/d", "decodes simple escapes");
+  check(readString("\"\\b\\f\\n\\r\\t\"") == "\b\f\n\r\t", "decodes control escapes");
+  check(readString("\"\\u0041\\u00e9\\u20AC\"") == "A\xc3\xa9\xe2\x82\xac", "decodes BMP escapes to UTF-8");
+  check(readString("\"\\uD83D\\uDE00\"") == "\xf0\x9f\x98\x80", "decodes surrogate pairs to UTF-8");
+  check(readString("\"x\\u0000y\"") == std::string("x\0y", 3), "decodes an escaped NUL");
+  check(readString("\"\xc3\xa9\\n\"") == "\xc3\xa9\n", "keeps raw UTF-8 before an escape");
+
+  const std::string json = "{\"key\":\"value\"}";
+  mp::JSONReader reader(json.data(), json.size());
+  std::string scratch;
+  const char *key;
+  std::size_t keyLength;
+  const char *value;
+  std::size_t valueLength;
+  check(reader.beginObject() && reader.nextKey(key, keyLength, scratch) && reader.readString(value, valueLength, scratch),
+        "walks a one-member object");
+  check(key == json.data() + 2 && value == json.data() + 8, "unescaped strings point into the input");
+  check(!reader.nextKey(key, keyLength, scratch) && !reader.failed() && reader.atEnd(), "closing brace ends the object");
+
+  const std::string raw = "[ {\"a\" : [1, 2]} , 3]";
+  mp::JSONReader rawReader(raw.data(), raw.size());
+  const char *begin;
+  std::size_t length;
+  check(rawReader.beginArray() && rawReader.nextElement() && rawReader.rawValue(begin, length) &&
+        std::string(begin, length) == "{\"a\" : [1, 2]}", "rawValue returns the exact bytes of a value");
+}
+
+void checkDispatchResults()
+{
+  std::vector<mp::DispatchResult> results;
+  const std::string response =
+    "[{\"id\":\"e1\",\"code\":\"200\"},"
+    " {\"code\":500,\"id\":\"e\\u0032\",\"extra\":{\"nested\":[1,2,{}]}},"
+    " 7, \"skip\", null,"
+    " {\"id\":\"e3\",\"id\":[\"not a string\"]},"
+    " {\"id\":1.5e2}]";
+  check(mp::parseDispatchResults(response.data(), response.size(), results), "parses a dispatch response");
+  check(results.size() == 4, "one result per object element");
+  if (results.size() == 4) {
+    check(results[0].hasEventId && results[0].eventId == "e1" && results[0].hasCode && results[0].code == "200",
+          "reads string id and code");
+    check(results[1].eventId == "e2" && results[1].code == "500", "reads numbers as their text and unescapes ids");
+    check(!results[2].hasEventId, "a later non-string duplicate clears the id");
+    check(results[3].eventId == "1.5e2" && !results[3].hasCode, "keeps number literals and reports missing codes");
+  }
+  const char *malformed[] = {"", "{}", "[{\"id\":\"e1\"}", "[{\"id\":\"e1\"},]", "[{\"id\":\"e1\"}] x"};
+  for (const char *json : malformed) {
+    check(!mp::parseDispatchResults(json, std::strlen(json), results) && results.empty(),
+          std::string("drops malformed response ") + json);
+  }
+}
+
+std::string syntheticResponse(std::size_t entries)
+{
+  std::string json = "[";
+  for (std::size_t i = 0; i < entries; i++) {
+    if (i) {
+      json += ",";
+    }
+    json += "{\"id\":\"018f3c2a-7b1e-7c4d-9a2b-" + std::to_string(100000000000 + i) +
+            "\",\"code\":\"" + (i % 10 ? "200" : "500") +
+            "\",\"message\":\"event \\\"" + std::to_string(i) + "\\\" accepted\",\"debug\":{\"shard\":" +
+            std::to_string(i % 16) + ",\"trace\":[1,2,3]}}";
+  }
+  return json + "]";
+}
+
+void benchmark(const std::string &name, const std::string &json, long repeat)
+{
+  std::size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < repeat; i++) {
+    sink += accepts(json);
+  }
+  const double validateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::vector<mp::DispatchResult> results;
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < repeat; i++) {
+    mp::parseDispatchResults(json.data(), json.size(), results);
+    sink += results.size();
+  }
+  const double dispatchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double megabytes = (double)json.size() * repeat / 1e6;
+  std::printf("%-24s bytes=%-8zu validate=%8.1f MB/s  dispatch=%8.1f MB/s%s\n", name.c_str(), json.size(),
+              megabytes / validateSeconds, megabytes / dispatchSeconds, sink == 0 ? " " : "");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long repeat = 200;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+
+  checkDocuments();
+  checkStrings();
+  checkDispatchResults();
+
+  benchmark("dispatch-response-100", syntheticResponse(100), repeat * 10);
+  benchmark("dispatch-response-10k", syntheticResponse(10000), repeat / 10 + 1);
+  for (const char *path : paths) {
+    std::ifstream file(path, std::ios::binary);
+    const std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof()) {
+      std::fprintf(stderr, "%s: cannot read\n", path);
+      failures++;
+      continue;
+    }
+    benchmark(path, json, repeat);
+  }
+  return failures == 0 ? 0 : 1;
+}
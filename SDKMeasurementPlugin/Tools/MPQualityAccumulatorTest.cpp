@@ -0,0 +1,191 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Window merge checks for mp::QualityAccumulator, the state behind
+// MPQualityMetric.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_quality_accumulator_test SDKMeasurementPlugin/Tools/MPQualityAccumulatorTest.cpp
+//   ./mp_quality_accumulator_test [--rounds N] [--seed S]
+//
+// Each round registers a random tick stream on one accumulator, and the same
+// stream cut into consecutive windows on one accumulator per window, then
+// merges the windows in order. Every field, the histogram and the P50/P90 of
+// the merged result must match the single accumulator; mismatches print FAIL
+// lines and make the exit status non-zero.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "MPQualityAccumulator.hpp"
+
+namespace {
+
+constexpr float kEligibleThreshold = 0.5f;
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed ? seed : 1) {}
+
+  uint64_t next()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  std::size_t below(std::size_t bound)
+  {
+    return (std::size_t)(next() % bound);
+  }
+
+  float unit()
+  {
+    return (float)(next() >> 40) / (float)(1 << 24);
+  }
+
+ private:
+  uint64_t _state;
+};
+
+struct Tick {
+  double progress;
+  float value;
+};
+
+// Long eligible and ineligible stretches, so runs cross window boundaries,
+// with the exact 0 and 1 that real viewability and volume are full of.
+std::vector<Tick> randomTicks(Random &random, std::size_t count)
+{
+  std::vector<Tick> ticks;
+  bool eligible = random.below(2) == 0;
+  for (std::size_t i = 0; i < count; i++) {
+    if (random.below(8) == 0) {
+      eligible = !eligible;
+    }
+    const std::size_t roll = random.below(10);
+    float value;
+    if (roll == 0) {
+      value = eligible ? 1.0f : 0.0f;
+    } else {
+      value = eligible ? kEligibleThreshold + random.unit() * (1.0f - kEligibleThreshold)
+                       : random.unit() * kEligibleThreshold * 0.999f;
+    }
+    ticks.push_back({0.05 + 0.01 * (double)random.below(30), value});
+  }
+  return ticks;
+}
+
+bool near(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-6 * std::fmax(1.0, std::fmax(std::fabs(a), std::fabs(b)));
+}
+
+// `sum` and `avg` are floats, so adding the window sums rounds differently
+// from adding every tick.
+bool nearFloat(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-4 * std::fmax(1.0, std::fmax(std::fabs(a), std::fabs(b)));
+}
+
+void compare(const mp::QualityAccumulator &merged, const mp::QualityAccumulator &whole)
+{
+  check(merged.measurementCount == whole.measurementCount, "measurementCount");
+  check(merged.min == whole.min && merged.max == whole.max, "min and max");
+  check(merged.current == whole.current, "current");
+  check(near(merged.measurementSeconds, whole.measurementSeconds), "measurementSeconds");
+  check(near(merged.eligibleSeconds, whole.eligibleSeconds), "eligibleSeconds");
+  check(near(merged.continuousEligibleSeconds, whole.continuousEligibleSeconds), "continuousEligibleSeconds");
+  check(near(merged.maxContinuousEligibleSeconds, whole.maxContinuousEligibleSeconds), "maxContinuousEligibleSeconds");
+  check(nearFloat(merged.sum, whole.sum) && nearFloat(merged.avg, whole.avg), "sum and avg");
+  bool histogramMatches = near(merged.histogram.total(), whole.histogram.total());
+  for (std::size_t i = 0; i < mp::UnitHistogram::kBucketCount; i++) {
+    histogramMatches = histogramMatches && near(merged.histogram.weight(i), whole.histogram.weight(i));
+  }
+  check(histogramMatches, "histogram");
+  check(std::fabs(merged.percentile(0.5f) - whole.percentile(0.5f)) <= 1e-5f &&
+        std::fabs(merged.percentile(0.9f) - whole.percentile(0.9f)) <= 1e-5f, "p50 and p90");
+}
+
+void checkMerge(Random &random, int rounds)
+{
+  for (int round = 0; round < rounds; round++) {
+    const std::vector<Tick> ticks = randomTicks(random, 1 + random.below(400));
+    mp::QualityAccumulator whole(kEligibleThreshold);
+    for (const Tick &tick : ticks) {
+      whole.registerProgress(tick.progress, tick.value);
+    }
+
+    // Two windows at a random cut, empty windows included.
+    const std::size_t cut = random.below(ticks.size() + 1);
+    mp::QualityAccumulator first(kEligibleThreshold);
+    mp::QualityAccumulator second(kEligibleThreshold);
+    for (std::size_t i = 0; i < ticks.size(); i++) {
+      (i < cut ? first : second).registerProgress(ticks[i].progress, ticks[i].value);
+    }
+    first.merge(second);
+    compare(first, whole);
+
+    // Many short windows folded in one after another.
+    mp::QualityAccumulator merged(kEligibleThreshold);
+    std::size_t i = 0;
+    while (i < ticks.size()) {
+      const std::size_t end = i + 1 + random.below(12);
+      mp::QualityAccumulator window(kEligibleThreshold);
+      for (; i < end && i < ticks.size(); i++) {
+        window.registerProgress(ticks[i].progress, ticks[i].value);
+      }
+      merged.merge(window);
+    }
+    compare(merged, whole);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int rounds = 2000;
+  uint64_t seed = 0x5EEDull;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--rounds") == 0) {
+      rounds = std::atoi(argv[i + 1]);
+    } else if (std::strcmp(argv[i], "--seed") == 0) {
+      seed = std::strtoull(argv[i + 1], nullptr, 0);
+    }
+  }
+  Random random(seed);
+
+  checkMerge(random, rounds);
+
+  std::printf("%s\n", failures == 0 ? "OK" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
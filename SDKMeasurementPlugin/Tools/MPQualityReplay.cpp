@@ -0,0 +1,406 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Replays quality traces recorded with -[MPQualityManager startTraceRecording]
+// through the portable metric and rule core, off device.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_quality_replay SDKMeasurementPlugin/Tools/MPQualityReplay.cpp
+//   ./mp_quality_replay [--repeat N] [--adaptive MAX_ERROR_FRACTION] [--expect golden.txt] trace.bin... > golden.txt
+//   ./mp_quality_replay --synthesize trace.bin
+//
+// stdout gets one line per logged action and per finished rule, in the
+// parameter names of MPVideoLoggingEvent. Throughput goes to stderr. With
+// --expect, that output must match the golden file line for line; the first
+// difference is reported and the exit status is non-zero.
+//
+// Tools/Fixtures holds a synthetic session and its golden output, the
+// regression check for the metric and rule core:
+//
+//   ./mp_quality_replay --expect SDKMeasurementPlugin/Tools/Fixtures/quality_synthetic.golden SDKMeasurementPlugin/Tools/Fixtures/quality_synthetic.mpqt
+//
+// --synthesize writes that session again. Regenerate the golden file only
+// for an intended change in the output, and say why in the commit.
+//
+// --adaptive also replays every trace through AdaptiveSampler, with the given
+// fraction of the seconds played as its error allowance, holding the last measured ratio for the ticks it
+// skips, and compares eligible seconds at each threshold with the full-rate
+// ticks of the trace. The trace must have been recorded without adaptive
+// sampling. Fails if any drift exceeds the bound.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MPAdaptiveSampler.hpp"
+#include "MPQualityAccumulator.hpp"
+#include "MPQualityRuleEngine.hpp"
+#include "MPQualityTrace.hpp"
+
+namespace {
+
+// MPQualityStatistics defaults, which MPQualityManager uses
+constexpr float kViewableThreshold = 0.5f;
+constexpr float kAudibleThreshold = 0.05f;
+
+std::string histogramString(const mp::UnitHistogram &histogram)
+{
+  std::size_t count = mp::UnitHistogram::kBucketCount;
+  while (count > 0 && (unsigned long)(histogram.weight(count - 1) * 1000) == 0) {
+    count--;
+  }
+  std::string string;
+  char number[32];
+  for (std::size_t i = 0; i < count; i++) {
+    std::snprintf(number, sizeof(number), i ? ",%lu" : "%lu", (unsigned long)(histogram.weight(i) * 1000));
+    string += number;
+  }
+  return string;
+}
+
+void appendMetric(std::string &line, const char *prefix, const char *timeKey, const char *continuousKey, const mp::QualityAccumulator &metric)
+{
+  char fields[512];
+  std::snprintf(fields, sizeof(fields), " %sa=%f %sm=%f %smax=%f %sp50=%f %sp90=%f %s=%lu %s=%lu %sh=%s",
+                prefix, metric.avg, prefix, metric.min, prefix, metric.max,
+                prefix, metric.percentile(0.5f), prefix, metric.percentile(0.9f),
+                timeKey, (unsigned long)(metric.eligibleSeconds * 1000),
+                continuousKey, (unsigned long)(metric.maxContinuousEligibleSeconds * 1000),
+                prefix, histogramString(metric.histogram).c_str());
+  line += fields;
+}
+
+struct ReplayResult {
+  std::size_t records = 0;
+  std::size_t ticks = 0;
+  std::size_t outputs = 0;
+  bool ok = true;
+};
+
+// Mirrors -[MPQualityManager registerProgress:volume:time:] and its statistics.
+ReplayResult replay(const std::vector<uint8_t> &trace, std::string *golden)
+{
+  ReplayResult result;
+  mp::QualityTraceReader reader(trace.data(), trace.size());
+  std::vector<std::pair<std::string, mp::QualityRuleSpec>> rules;
+  if (reader.failed() || !mp::parseQualityRuleSpecs(reader.ruleSpecs().c_str(), rules)) {
+    result.ok = false;
+    return result;
+  }
+  std::vector<mp::QualityRuleSpec> specs;
+  for (const auto &rule : rules) {
+    specs.push_back(rule.second);
+  }
+  mp::QualityRuleEngine engine(specs, kAudibleThreshold);
+  mp::QualityAccumulator viewability(kViewableThreshold);
+  mp::QualityAccumulator audibility(kAudibleThreshold);
+
+  auto onRuleEnd = [&](std::size_t index, bool complete, bool passed, const mp::QualityAccumulator &ruleViewability, const mp::QualityAccumulator &ruleAudibility) {
+    result.outputs++;
+    if (golden) {
+      std::string line = "rule=" + rules[index].first + (complete ? " completed=1" : " completed=0") + (passed ? " passed=1" : " passed=0");
+      appendMetric(line, "vw", "vtime_ms", "mcvt_ms", ruleViewability);
+      appendMetric(line, "vl", "atime_ms", "mcat_ms", ruleAudibility);
+      *golden += line + "\n";
+    }
+  };
+
+  mp::QualityTraceRecord record;
+  while (reader.next(record)) {
+    result.records++;
+    switch (record.kind) {
+      case mp::QualityTraceKind::Tick:
+        result.ticks++;
+        if (record.volume >= 0) {
+          audibility.registerProgress(record.seconds, record.volume);
+        }
+        viewability.registerProgress(record.seconds, record.viewableRatio);
+        engine.registerProgress(record.seconds, record.viewableRatio, record.volume, onRuleEnd);
+        break;
+      case mp::QualityTraceKind::Reset:
+        viewability.resetTotals();
+        audibility.resetTotals();
+        break;
+      case mp::QualityTraceKind::Duration:
+        engine.setDuration(record.seconds);
+        break;
+      case mp::QualityTraceKind::Activity:
+        break;
+      case mp::QualityTraceKind::Action:
+        result.outputs++;
+        if (golden) {
+          std::string line = "action=" + std::to_string(record.action);
+          appendMetric(line, "vw", "vtime_ms", "mcvt_ms", viewability);
+          appendMetric(line, "vl", "atime_ms", "mcat_ms", audibility);
+          *golden += line + "\n";
+        }
+        break;
+    }
+  }
+  result.ok = !reader.failed();
+  return result;
+}
+
+// Deterministic session touching every record kind and rule flag: full and
+// partial visibility, hidden stretches, muted and unknown volume, a pause,
+// and statistics resets after the time actions. Values are multiples of 1/64,
+// so they are exact in a float.
+std::vector<uint8_t> synthesizeTrace()
+{
+  mp::QualityTraceWriter writer("mrc:0.5:2:c;groupm:1:50%:ca0.05;brief:0.8:1;loud:0.25:3:a0.5");
+  uint64_t state = 0x5EEDull;
+  auto nextSixtyFourths = [&state](int below) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (float)(state % (uint64_t)below) / 64.0f;
+  };
+  writer.duration(30);
+  writer.action(0); // MPVideoActionPlay
+  for (int tick = 0; tick < 150; tick++) {
+    float viewableRatio;
+    float volume;
+    if (tick < 25) {
+      viewableRatio = 1;
+      volume = 1;
+    } else if (tick < 40) {
+      viewableRatio = 0.5f + nextSixtyFourths(32);
+      volume = 0.25f;
+    } else if (tick < 50) {
+      viewableRatio = 0;
+      volume = 0;
+    } else if (tick < 80) {
+      viewableRatio = nextSixtyFourths(65);
+      volume = nextSixtyFourths(65);
+    } else if (tick < 100) {
+      viewableRatio = 0.75f;
+      volume = -1; // no audio state
+    } else {
+      viewableRatio = tick % 10 < 7 ? 1.0f : 0.25f;
+      volume = 0.5f;
+    }
+    if (tick % 25 == 0 || tick == 40 || tick == 50) {
+      writer.activity();
+    }
+    if (tick == 60) {
+      writer.action(4); // MPVideoActionPause
+      writer.action(5); // MPVideoActionResume
+    }
+    writer.tick(0.2, viewableRatio, volume);
+    if (tick % 50 == 49) {
+      writer.action(2); // MPVideoActionTime
+      writer.reset();
+    }
+  }
+  writer.action(3); // MPVideoActionMRC
+  const mp::ByteBuffer &buffer = writer.buffer();
+  return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.size());
+}
+
+// The first line where `actual` and `expected` differ, 0 if they match.
+std::size_t firstDifference(const std::string &actual, const std::string &expected, std::string &actualLine, std::string &expectedLine)
+{
+  std::size_t actualStart = 0;
+  std::size_t expectedStart = 0;
+  for (std::size_t line = 1;; line++) {
+    if (actualStart >= actual.size() && expectedStart >= expected.size()) {
+      return 0;
+    }
+    std::size_t actualEnd = actual.find('\n', actualStart);
+    std::size_t expectedEnd = expected.find('\n', expectedStart);
+    actualEnd = actualEnd == std::string::npos ? actual.size() : actualEnd;
+    expectedEnd = expectedEnd == std::string::npos ? expected.size() : expectedEnd;
+    actualLine = actualStart < actual.size() ? actual.substr(actualStart, actualEnd - actualStart) : "(end of output)";
+    expectedLine = expectedStart < expected.size() ? expected.substr(expectedStart, expectedEnd - expectedStart) : "(end of golden file)";
+    if (actualStart >= actual.size() || expectedStart >= expected.size() || actualLine != expectedLine) {
+      return line;
+    }
+    actualStart = actualEnd + 1;
+    expectedStart = expectedEnd + 1;
+  }
+}
+
+struct AdaptiveResult {
+  std::size_t ticks = 0;
+  std::size_t measurements = 0;
+  double maxDriftSeconds = 0;
+  double chargedSeconds = 0;
+  double boundSeconds = 0;
+  bool ok = true;
+};
+
+// Eligible seconds at the statistics threshold and every rule's, full rate
+// against adaptive. Resets are ignored: the drift is over the whole session.
+AdaptiveResult compareAdaptive(const std::vector<uint8_t> &trace, const mp::AdaptiveSamplerConfig &config)
+{
+  AdaptiveResult result;
+  mp::QualityTraceReader reader(trace.data(), trace.size());
+  std::vector<std::pair<std::string, mp::QualityRuleSpec>> rules;
+  if (reader.failed() || !mp::parseQualityRuleSpecs(reader.ruleSpecs().c_str(), rules)) {
+    result.ok = false;
+    return result;
+  }
+  std::vector<float> thresholds = {kViewableThreshold};
+  for (const auto &rule : rules) {
+    thresholds.push_back(rule.second.viewableRatio);
+  }
+  mp::AdaptiveSampler sampler(config, thresholds);
+  std::vector<double> fullSeconds(thresholds.size()), adaptiveSeconds(thresholds.size());
+
+  bool active = false;
+  mp::QualityTraceRecord record;
+  while (reader.next(record)) {
+    if (record.kind == mp::QualityTraceKind::Activity) {
+      active = true;
+      continue;
+    }
+    if (record.kind != mp::QualityTraceKind::Tick) {
+      continue;
+    }
+    float ratio = sampler.heldRatio();
+    if (sampler.shouldMeasure(record.seconds, active)) {
+      ratio = record.viewableRatio;
+      sampler.measured(ratio);
+    }
+    active = false;
+    for (std::size_t i = 0; i < thresholds.size(); i++) {
+      if (record.viewableRatio >= thresholds[i]) {
+        fullSeconds[i] += record.seconds;
+      }
+      if (ratio >= thresholds[i]) {
+        adaptiveSeconds[i] += record.seconds;
+      }
+    }
+  }
+  for (std::size_t i = 0; i < thresholds.size(); i++) {
+    result.maxDriftSeconds = std::max(result.maxDriftSeconds, std::fabs(fullSeconds[i] - adaptiveSeconds[i]));
+  }
+  result.ticks = sampler.ticks();
+  result.measurements = sampler.measurements();
+  result.chargedSeconds = sampler.errorSeconds();
+  result.boundSeconds = sampler.errorBound();
+  result.ok = !reader.failed();
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long repeat = 1;
+  bool adaptive = false;
+  mp::AdaptiveSamplerConfig adaptiveConfig;
+  const char *expectPath = nullptr;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--synthesize") == 0 && i + 1 < argc) {
+      const std::vector<uint8_t> trace = synthesizeTrace();
+      std::ofstream file(argv[++i], std::ios::binary);
+      file.write((const char *)trace.data(), (std::streamsize)trace.size());
+      if (!file.good()) {
+        std::fprintf(stderr, "%s: cannot write\n", argv[i]);
+        return 1;
+      }
+      return 0;
+    } else if (std::strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+      expectPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--adaptive") == 0 && i + 1 < argc) {
+      adaptive = true;
+      adaptiveConfig.maxErrorFraction = std::strtod(argv[++i], nullptr);
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    std::fprintf(stderr, "usage: %s [--repeat N] [--adaptive MAX_ERROR_FRACTION] [--expect GOLDEN] trace...\n"
+                 "       %s --synthesize TRACE\n", argv[0], argv[0]);
+    return 2;
+  }
+
+  int status = 0;
+  std::string output;
+  for (const char *path : paths) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof()) {
+      std::fprintf(stderr, "%s: cannot read\n", path);
+      status = 1;
+      continue;
+    }
+
+    std::string golden;
+    const ReplayResult first = replay(trace, &golden);
+    if (!first.ok) {
+      std::fprintf(stderr, "%s: malformed trace after %zu records\n", path, first.records);
+      status = 1;
+    }
+    if (paths.size() > 1) {
+      output += std::string("# ") + path + "\n";
+    }
+    output += golden;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t ticks = 0;
+    for (long i = 0; i < repeat; i++) {
+      ticks += replay(trace, nullptr).ticks;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%s: %zu records, %zu ticks, %zu outputs; %.0f ticks/s over %ld run%s\n",
+                 path, first.records, first.ticks, first.outputs,
+                 seconds > 0 ? ticks / seconds : 0.0, repeat, repeat == 1 ? "" : "s");
+
+    if (adaptive) {
+      const AdaptiveResult result = compareAdaptive(trace, adaptiveConfig);
+      const bool withinBound = result.maxDriftSeconds <= result.boundSeconds + 1e-9;
+      std::fprintf(stderr, "%s: adaptive measured %zu of %zu ticks; eligible seconds drift %.3f s (charged %.3f s, bound %.3f s)%s\n",
+                   path, result.measurements, result.ticks, result.maxDriftSeconds, result.chargedSeconds,
+                   result.boundSeconds, withinBound ? "" : " EXCEEDED");
+      if (!result.ok || !withinBound) {
+        status = 1;
+      }
+    }
+  }
+  std::fputs(output.c_str(), stdout);
+
+  if (expectPath) {
+    std::ifstream file(expectPath, std::ios::binary);
+    const std::string expected((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string actualLine;
+    std::string expectedLine;
+    if (!file.good() && !file.eof()) {
+      std::fprintf(stderr, "%s: cannot read\n", expectPath);
+      status = 1;
+    } else if (const std::size_t line = firstDifference(output, expected, actualLine, expectedLine)) {
+      std::fprintf(stderr, "%s:%zu: output differs\n  expected: %s\n  actual:   %s\n",
+                   expectPath, line, expectedLine.c_str(), actualLine.c_str());
+      status = 1;
+    } else {
+      std::fprintf(stderr, "%s: output matches\n", expectPath);
+    }
+  }
+  return status;
+}
@@ -0,0 +1,314 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Model check and per-rule cost benchmark for mp::QualityRuleEngine, the
+// evaluator behind MPQualityTest.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_quality_rule_bench SDKMeasurementPlugin/Tools/MPQualityRuleEngineBench.cpp
+//   ./mp_quality_rule_bench [--ticks N] [--seed S]
+//
+// The model check runs random rule sets over random tick streams through the
+// engine and through a direct per-rule reference, and compares when each
+// rule ends, whether it passed, and the viewable and audible seconds of the
+// window it reports; mismatches print FAIL lines and make the exit status
+// non-zero. The benchmark then times 0.2 s ticks against 1 to 64 rules that
+// never finish, once as a single engine and once as one engine per rule, the
+// layout of the old one-MPQualityTest-per-rule code.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "MPQualityRuleEngine.hpp"
+
+namespace {
+
+constexpr float kAudibleThreshold = 0.05f;
+constexpr double kTickSeconds = 0.2;
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed ? seed : 1) {}
+
+  uint64_t next()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  std::size_t below(std::size_t bound)
+  {
+    return (std::size_t)(next() % bound);
+  }
+
+  float unit()
+  {
+    return (float)(next() >> 40) / (float)(1 << 24);
+  }
+
+ private:
+  uint64_t _state;
+};
+
+struct Tick {
+  double progress;
+  float viewableRatio;
+  float volume;
+};
+
+struct Outcome {
+  long endTick = -1;
+  bool complete = false;
+  bool passed = false;
+  double viewableSeconds = 0;
+  double audibleSeconds = 0;
+  double audibleMeasuredSeconds = 0;
+};
+
+// Ratios cluster on 0, 1 and the common thresholds; a few ticks have an
+// unknown volume.
+std::vector<Tick> randomTicks(Random &random, std::size_t count)
+{
+  static const float kRatios[] = {0.0f, 0.5f, 0.8f, 1.0f};
+  std::vector<Tick> ticks;
+  ticks.reserve(count);
+  float ratio = 1.0f;
+  float volume = 1.0f;
+  for (std::size_t i = 0; i < count; i++) {
+    if (random.below(8) == 0) {
+      ratio = random.below(2) ? kRatios[random.below(4)] : random.unit();
+    }
+    if (random.below(10) == 0) {
+      volume = random.below(5) == 0 ? -1.0f : (random.below(2) ? 0.0f : random.unit());
+    }
+    ticks.push_back({kTickSeconds * (0.5 + random.unit()), ratio, volume});
+  }
+  return ticks;
+}
+
+mp::QualityRuleSpec randomSpec(Random &random)
+{
+  mp::QualityRuleSpec spec;
+  spec.viewableRatio = random.below(3) ? 0.5f * (float)random.below(3) : random.unit();
+  if (random.below(3) == 0) {
+    spec.durationFraction = 0.25 * (double)(1 + random.below(4));
+  } else {
+    spec.viewableSeconds = (double)random.below(8);
+  }
+  spec.continuous = random.below(2) == 0;
+  spec.audibleVolume = random.below(3) == 0 ? 0.05f * (float)(1 + random.below(4)) : 0.0f;
+  return spec;
+}
+
+// One rule evaluated on its own, written straight from the rule's
+// definition rather than from the engine.
+Outcome referenceOutcome(const mp::QualityRuleSpec &spec, const std::vector<Tick> &ticks, double duration, long durationTick)
+{
+  Outcome outcome;
+  double testViewable = 0, testAudible = 0, testMeasured = 0;
+  double runViewable = 0, runAudible = 0, runMeasured = 0;
+  double required = spec.durationFraction > 0 ? INFINITY : spec.viewableSeconds;
+  for (std::size_t i = 0; i < ticks.size(); i++) {
+    if ((long)i == durationTick && spec.durationFraction > 0) {
+      required = std::fmax(spec.viewableSeconds, spec.durationFraction * duration);
+    }
+    const Tick &tick = ticks[i];
+    const bool eligible = tick.viewableRatio >= spec.viewableRatio && (spec.audibleVolume <= 0 || tick.volume >= spec.audibleVolume);
+    const double viewable = eligible ? tick.progress : 0;
+    const double measured = tick.volume >= 0 ? tick.progress : 0;
+    const double audible = tick.volume >= kAudibleThreshold ? tick.progress : 0;
+    testViewable += viewable;
+    testAudible += audible;
+    testMeasured += measured;
+    runViewable += viewable;
+    runAudible += audible;
+    runMeasured += measured;
+    // The pass is judged before a continuity break clears the window, but
+    // the window reported is the cleared one, as in the original MPQualityTest.
+    const double passingViewable = runViewable;
+    if (spec.continuous && !eligible) {
+      runViewable = runAudible = runMeasured = 0;
+    }
+    if (passingViewable >= required) {
+      outcome.endTick = (long)i;
+      outcome.complete = true;
+      outcome.passed = true;
+      outcome.viewableSeconds = runViewable;
+      outcome.audibleSeconds = runAudible;
+      outcome.audibleMeasuredSeconds = runMeasured;
+      return outcome;
+    }
+  }
+  outcome.endTick = (long)ticks.size();
+  outcome.viewableSeconds = testViewable;
+  outcome.audibleSeconds = testAudible;
+  outcome.audibleMeasuredSeconds = testMeasured;
+  return outcome;
+}
+
+bool near(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-6 * (1 + std::fabs(b));
+}
+
+void checkAgainstReference(Random &random, int rounds)
+{
+  for (int round = 0; round < rounds; round++) {
+    std::vector<mp::QualityRuleSpec> specs(1 + random.below(8));
+    for (mp::QualityRuleSpec &spec : specs) {
+      spec = randomSpec(random);
+    }
+    const std::vector<Tick> ticks = randomTicks(random, 20 + random.below(300));
+    const double duration = 1.0 + (double)random.below(60);
+    const long durationTick = random.below(4) == 0 ? -1 : (long)random.below(ticks.size());
+
+    std::vector<Outcome> outcomes(specs.size());
+    long tickIndex = 0;
+    auto onEnd = [&](std::size_t index, bool complete, bool passed, const mp::QualityAccumulator &viewability, const mp::QualityAccumulator &audibility) {
+      Outcome &outcome = outcomes[index];
+      check(outcome.endTick < 0, "a rule ends once");
+      outcome.endTick = tickIndex;
+      outcome.complete = complete;
+      outcome.passed = passed;
+      outcome.viewableSeconds = viewability.eligibleSeconds;
+      outcome.audibleSeconds = audibility.eligibleSeconds;
+      outcome.audibleMeasuredSeconds = audibility.measurementSeconds;
+    };
+    mp::QualityRuleEngine engine(specs, kAudibleThreshold);
+    for (const Tick &tick : ticks) {
+      if (tickIndex == durationTick) {
+        engine.setDuration(duration);
+      }
+      engine.registerProgress(tick.progress, tick.viewableRatio, tick.volume, onEnd);
+      tickIndex++;
+    }
+    engine.registerEnd(onEnd);
+
+    for (std::size_t i = 0; i < specs.size(); i++) {
+      const Outcome expected = referenceOutcome(specs[i], ticks, duration, durationTick);
+      const Outcome &actual = outcomes[i];
+      const bool same = actual.endTick == expected.endTick && actual.complete == expected.complete &&
+                        actual.passed == expected.passed && near(actual.viewableSeconds, expected.viewableSeconds) &&
+                        near(actual.audibleSeconds, expected.audibleSeconds) &&
+                        near(actual.audibleMeasuredSeconds, expected.audibleMeasuredSeconds);
+      if (!same) {
+        std::printf("FAIL round %d rule %s: end %ld/%ld passed %d/%d viewable %f/%f audible %f/%f\n", round,
+                    mp::formatQualityRuleSpec("r", specs[i]).c_str(), actual.endTick, expected.endTick, actual.passed,
+                    expected.passed, actual.viewableSeconds, expected.viewableSeconds, actual.audibleSeconds,
+                    expected.audibleSeconds);
+        failures++;
+      }
+    }
+  }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Rules that stay active for the whole run, so every tick pays for all of
+// them: a spread of thresholds, half continuous, a quarter audible.
+std::vector<mp::QualityRuleSpec> runningSpecs(std::size_t count)
+{
+  std::vector<mp::QualityRuleSpec> specs(count);
+  for (std::size_t i = 0; i < count; i++) {
+    specs[i].viewableRatio = (float)(i % 5) * 0.25f;
+    specs[i].viewableSeconds = 1e12;
+    specs[i].continuous = i % 2 == 0;
+    specs[i].audibleVolume = i % 4 == 3 ? 0.05f : 0.0f;
+  }
+  return specs;
+}
+
+void benchmark(Random &random, std::size_t tickCount)
+{
+  const std::vector<Tick> ticks = randomTicks(random, tickCount);
+  std::size_t ended = 0;
+  auto onEnd = [&ended](std::size_t, bool, bool, const mp::QualityAccumulator &, const mp::QualityAccumulator &) {
+    ended++;
+  };
+  std::printf("rules  engine ns/tick  ns/rule  |  per-rule ns/tick  ns/rule\n");
+  for (std::size_t count = 1; count <= 64; count *= 2) {
+    const std::vector<mp::QualityRuleSpec> specs = runningSpecs(count);
+
+    mp::QualityRuleEngine engine(specs, kAudibleThreshold);
+    auto start = std::chrono::steady_clock::now();
+    for (const Tick &tick : ticks) {
+      engine.registerProgress(tick.progress, tick.viewableRatio, tick.volume, onEnd);
+    }
+    const double packedSeconds = secondsSince(start);
+
+    std::vector<std::unique_ptr<mp::QualityRuleEngine>> separate;
+    for (const mp::QualityRuleSpec &spec : specs) {
+      separate.emplace_back(new mp::QualityRuleEngine({spec}, kAudibleThreshold));
+    }
+    start = std::chrono::steady_clock::now();
+    for (const Tick &tick : ticks) {
+      for (const std::unique_ptr<mp::QualityRuleEngine> &single : separate) {
+        single->registerProgress(tick.progress, tick.viewableRatio, tick.volume, onEnd);
+      }
+    }
+    const double separateSeconds = secondsSince(start);
+
+    const double packedTick = packedSeconds * 1e9 / (double)ticks.size();
+    const double separateTick = separateSeconds * 1e9 / (double)ticks.size();
+    std::printf("%5zu  %14.1f  %7.2f  |  %16.1f  %7.2f\n", count, packedTick, packedTick / (double)count,
+                separateTick, separateTick / (double)count);
+  }
+  check(ended == 0, "benchmark rules stay active");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t ticks = 200000;
+  uint64_t seed = 0x5EEDull;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--ticks") == 0) {
+      ticks = (std::size_t)std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--seed") == 0) {
+      seed = std::strtoull(argv[i + 1], nullptr, 0);
+    }
+  }
+  Random random(seed);
+
+  checkAgainstReference(random, 2000);
+  benchmark(random, ticks < 1 ? 1 : ticks);
+
+  std::printf("%s\n", failures == 0 ? "OK" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
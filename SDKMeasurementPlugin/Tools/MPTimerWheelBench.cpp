@@ -0,0 +1,424 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Model check and reschedule-churn benchmark for the timer wheel behind
+// MPTimer.
+//
+//   c++ -std=c++14 -O2 -pthread -I SDKMeasurementPlugin/Classes -o mp_timer_wheel_bench SDKMeasurementPlugin/Tools/MPTimerWheelBench.cpp SDKMeasurementPlugin/Classes/MPTimerWheel.cpp
+//   ./mp_timer_wheel_bench [--operations N] [--seconds S]
+//
+// The model check drives the wheel and a brute-force reference with the same
+// random schedule/reschedule/cancel/advance sequence and compares what fires
+// and when; mismatches print FAIL lines and make the exit status non-zero.
+// The benchmark reschedules random timers the way the event manager re-arms
+// its dispatch timer, against an ordered-set scheduler, then measures the
+// threaded scheduler front end.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MPTimerWheel.hpp"
+
+namespace {
+
+using Tick = mp::TimerWheel::Tick;
+using TimerId = mp::TimerWheel::TimerId;
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed) {}
+
+  uint64_t next()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  uint64_t below(uint64_t bound)
+  {
+    return next() % bound;
+  }
+
+ private:
+  uint64_t _state;
+};
+
+// Reference semantics of TimerWheel, one timer at a time.
+class ModelWheel {
+ public:
+  struct Timer {
+    Tick deadline;
+    Tick expiry;
+    Tick leeway;
+    Tick interval;
+  };
+
+  static Tick coalescedExpiry(Tick deadline, Tick leeway)
+  {
+    if (leeway < 2) {
+      return deadline;
+    }
+    Tick granularity = 1;
+    while (granularity * 2 <= leeway) {
+      granularity *= 2;
+    }
+    return (deadline + granularity - 1) / granularity * granularity;
+  }
+
+  void schedule(TimerId timerId, Tick deadline, Tick leeway, Tick interval)
+  {
+    timers[timerId] = {deadline, std::max(coalescedExpiry(deadline, leeway), now + 1), leeway, interval};
+  }
+
+  bool reschedule(TimerId timerId, Tick deadline, Tick leeway)
+  {
+    auto it = timers.find(timerId);
+    if (it == timers.end()) {
+      return false;
+    }
+    it->second.deadline = deadline;
+    it->second.leeway = leeway;
+    it->second.expiry = std::max(coalescedExpiry(deadline, leeway), now + 1);
+    return true;
+  }
+
+  bool cancel(TimerId timerId)
+  {
+    return timers.erase(timerId) > 0;
+  }
+
+  Tick nextExpiry() const
+  {
+    Tick next = mp::TimerWheel::kNever;
+    for (const auto &timer : timers) {
+      next = std::min(next, timer.second.expiry);
+    }
+    return next;
+  }
+
+  // Appends (expiry, timer) for everything that fires up to `until`.
+  void advance(Tick until, std::vector<std::pair<Tick, TimerId>> &fired)
+  {
+    while (true) {
+      const Tick next = nextExpiry();
+      if (next > until) {
+        break;
+      }
+      now = next;
+      for (auto it = timers.begin(); it != timers.end();) {
+        Timer &timer = it->second;
+        if (timer.expiry != now) {
+          ++it;
+          continue;
+        }
+        fired.emplace_back(now, it->first);
+        if (!timer.interval) {
+          it = timers.erase(it);
+          continue;
+        }
+        timer.deadline += timer.interval;
+        if (timer.deadline <= now) {
+          timer.deadline = now + timer.interval;
+        }
+        timer.expiry = std::max(coalescedExpiry(timer.deadline, timer.leeway), now + 1);
+        ++it;
+      }
+    }
+    now = std::max(now, until);
+  }
+
+  Tick now = 0;
+  std::map<TimerId, Timer> timers;
+};
+
+// Deadlines mostly within a level or two, with the occasional one past the
+// wheel's span so the clamping path is exercised too.
+Tick randomDelay(Random &random)
+{
+  switch (random.below(8)) {
+    case 0:
+      return random.below(4);
+    case 1:
+      return mp::TimerWheel::kMaxSpan + random.below(mp::TimerWheel::kMaxSpan);
+    case 2:
+      return random.below(1 << 18);
+    default:
+      return random.below(1 << 10);
+  }
+}
+
+void modelCheck(long operations)
+{
+  Random random(0x2545f4914f6cdd1dULL);
+  mp::TimerWheel wheel(1000);
+  ModelWheel model;
+  model.now = 1000;
+  std::vector<TimerId> live;
+  std::vector<std::pair<Tick, TimerId>> expected;
+  std::vector<mp::TimerWheel::Callback> callbacks;
+  std::vector<TimerId> actual;
+  bool nextEventOk = true;
+  bool firedOk = true;
+  bool bookkeepingOk = true;
+
+  for (long operation = 0; operation < operations && firedOk; operation++) {
+    const uint64_t kind = random.below(16);
+    if (kind < 6 || live.empty()) {
+      const Tick deadline = wheel.now() + randomDelay(random);
+      const Tick leeway = random.below(3) == 0 ? 0 : random.below(200);
+      const Tick interval = random.below(4) == 0 ? 1 + random.below(500) : 0;
+      // Callbacks only run after advance() returns, by which time the id
+      // they report has been filled in.
+      auto timerId = std::make_shared<TimerId>(0);
+      *timerId = wheel.schedule(deadline, leeway, interval, [&actual, timerId] {
+        actual.push_back(*timerId);
+      });
+      const TimerId id = *timerId;
+      model.schedule(id, deadline, leeway, interval);
+      live.push_back(id);
+    } else if (kind < 9) {
+      const TimerId timerId = live[random.below(live.size())];
+      const Tick deadline = wheel.now() + randomDelay(random);
+      const Tick leeway = random.below(200);
+      bookkeepingOk &= wheel.reschedule(timerId, deadline, leeway) == model.reschedule(timerId, deadline, leeway);
+    } else if (kind < 11) {
+      const std::size_t index = random.below(live.size());
+      bookkeepingOk &= wheel.cancel(live[index]) == model.cancel(live[index]);
+      live[index] = live.back();
+      live.pop_back();
+    } else {
+      const Tick next = wheel.nextEventTick();
+      const Tick modelNext = model.nextExpiry();
+      nextEventOk &= modelNext == mp::TimerWheel::kNever ? next == mp::TimerWheel::kNever : next <= modelNext;
+      Tick until = wheel.now() + random.below(300);
+      if (random.below(8) == 0) {
+        // A long jump, reaching timers parked past the wheel's span. Repeating
+        // timers would fire for every interval on the way, so drop them first.
+        for (TimerId timerId : live) {
+          if (model.timers.count(timerId) && model.timers[timerId].interval) {
+            bookkeepingOk &= wheel.cancel(timerId) && model.cancel(timerId);
+          }
+        }
+        until = wheel.now() + randomDelay(random);
+      }
+      expected.clear();
+      callbacks.clear();
+      actual.clear();
+      model.advance(until, expected);
+      wheel.advance(until, callbacks);
+      for (auto &callback : callbacks) {
+        callback();
+      }
+      // Timers sharing an expiry may fire in any order among themselves.
+      firedOk &= actual.size() == expected.size();
+      for (std::size_t begin = 0; firedOk && begin < expected.size();) {
+        std::size_t end = begin;
+        while (end < expected.size() && expected[end].first == expected[begin].first) {
+          end++;
+        }
+        std::vector<TimerId> want;
+        for (std::size_t i = begin; i < end; i++) {
+          want.push_back(expected[i].second);
+        }
+        std::vector<TimerId> got(actual.begin() + begin, actual.begin() + end);
+        std::sort(want.begin(), want.end());
+        std::sort(got.begin(), got.end());
+        firedOk &= want == got;
+        begin = end;
+      }
+      bookkeepingOk &= wheel.now() == model.now && wheel.size() == model.timers.size();
+      live.erase(std::remove_if(live.begin(), live.end(), [&](TimerId timerId) {
+        return model.timers.count(timerId) == 0;
+      }), live.end());
+    }
+  }
+  check(firedOk, "wheel fires the model's timers at the model's ticks");
+  check(nextEventOk, "nextEventTick never passes the earliest expiry");
+  check(bookkeepingOk, "wheel and model agree on ids, size and time");
+}
+
+// The same workload on a deadline-ordered set, the usual O(log n) design.
+class OrderedScheduler {
+ public:
+  void schedule(TimerId timerId, Tick expiry)
+  {
+    _byDeadline.emplace(expiry, timerId);
+    _expiry[timerId] = expiry;
+  }
+
+  void reschedule(TimerId timerId, Tick expiry)
+  {
+    auto it = _expiry.find(timerId);
+    _byDeadline.erase({it->second, timerId});
+    it->second = expiry;
+    _byDeadline.emplace(expiry, timerId);
+  }
+
+  std::size_t advance(Tick now)
+  {
+    std::size_t fired = 0;
+    while (!_byDeadline.empty() && _byDeadline.begin()->first <= now) {
+      const TimerId timerId = _byDeadline.begin()->second;
+      _byDeadline.erase(_byDeadline.begin());
+      _expiry.erase(timerId);
+      fired++;
+    }
+    return fired;
+  }
+
+ private:
+  std::set<std::pair<Tick, TimerId>> _byDeadline;
+  std::map<TimerId, Tick> _expiry;
+};
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Each operation pushes one random timer out by up to a second at 1 ms
+// ticks with 100 ms leeway; every 64 operations time moves by one tick.
+void benchmarkChurn(std::size_t timers, long operations)
+{
+  Random random(timers);
+  mp::TimerWheel wheel;
+  std::vector<TimerId> ids;
+  for (std::size_t i = 0; i < timers; i++) {
+    ids.push_back(wheel.schedule(1000 + random.below(1000), 100, 0, [] {}));
+  }
+  std::vector<mp::TimerWheel::Callback> fired;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < operations; i++) {
+    wheel.reschedule(ids[random.below(ids.size())], wheel.now() + 1000 + random.below(1000), 100);
+    if (i % 64 == 0) {
+      wheel.advance(wheel.now() + 1, fired);
+    }
+  }
+  const double wheelSeconds = seconds(start);
+
+  OrderedScheduler ordered;
+  Random orderedRandom(timers);
+  for (std::size_t i = 0; i < timers; i++) {
+    ordered.schedule(i, 1000 + orderedRandom.below(1000));
+  }
+  Tick now = 0;
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < operations; i++) {
+    ordered.reschedule(orderedRandom.below(timers), now + 1000 + orderedRandom.below(1000));
+    if (i % 64 == 0) {
+      ordered.advance(++now);
+    }
+  }
+  const double orderedSeconds = seconds(start);
+  std::printf("churn      timers=%-7zu wheel=%7.1f ns/op  ordered-set=%7.1f ns/op\n",
+              timers, wheelSeconds * 1e9 / operations, orderedSeconds * 1e9 / operations);
+}
+
+// One-shot timers scheduled and cancelled before they fire, as the
+// debounced dispatch timer does between events.
+void benchmarkScheduleCancel(long operations)
+{
+  mp::TimerWheel wheel;
+  Random random(7);
+  const auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < operations; i++) {
+    wheel.cancel(wheel.schedule(wheel.now() + random.below(1 << 16), 100, 0, [] {}));
+  }
+  std::printf("schedule+cancel       wheel=%7.1f ns/op\n", seconds(start) * 1e9 / operations);
+}
+
+// The threaded front end: several threads re-arming their own timer, the
+// driver firing whichever ones come due.
+void benchmarkScheduler(int threads, double duration)
+{
+  mp::TimerScheduler scheduler;
+  std::atomic<long> fired(0);
+  std::atomic<long> rescheduled(0);
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> pool;
+  for (int i = 0; i < threads; i++) {
+    pool.emplace_back([&] {
+      const auto timerId = scheduler.schedule(std::chrono::milliseconds(5), std::chrono::milliseconds(1),
+                                              std::chrono::milliseconds(5), [&] { fired++; });
+      long count = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        scheduler.reschedule(timerId, std::chrono::milliseconds(5), std::chrono::milliseconds(1));
+        count++;
+      }
+      scheduler.cancel(timerId);
+      rescheduled += count;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(duration));
+  stop = true;
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+  check(scheduler.size() == 0, "scheduler is empty once every timer is cancelled");
+  std::printf("scheduler  threads=%-3d %8.2f M reschedules/s, %ld fired\n",
+              threads, rescheduled.load() / duration / 1e6, fired.load());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long operations = 200000;
+  double duration = 0.5;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--operations") == 0 && i + 1 < argc) {
+      operations = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      duration = std::max(0.01, std::strtod(argv[++i], nullptr));
+    }
+  }
+
+  modelCheck(operations);
+
+  for (std::size_t timers : {16, 1024, 65536}) {
+    benchmarkChurn(timers, operations * 10);
+  }
+  benchmarkScheduleCancel(operations * 10);
+  for (int threads : {1, 4}) {
+    benchmarkScheduler(threads, duration);
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Differential fuzz test and throughput benchmark for the percent encoder
+// behind fb_URLEncodedString and the form encoder.
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_url_encoding_fuzz SDKMeasurementPlugin/Tools/MPURLEncodingFuzz.cpp SDKMeasurementPlugin/Classes/MPURLEncoding.cpp
+//   ./mp_url_encoding_fuzz [--iterations N] [--seed S]
+//
+// Add -U__SSE2__ (x86) or -U__ARM_NEON (arm64) to the build line to check the
+// scalar path on its own. Every input is compared with a port of the
+// per-byte branch chain fb_URLEncodedString used before; a mismatch prints
+// the input in hex and makes the exit status non-zero. Throughput lines
+// follow for a few input shapes.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MPURLEncoding.h"
+
+namespace {
+
+int failures = 0;
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed ? seed : 1) {}
+
+  uint64_t next()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  std::size_t below(std::size_t bound)
+  {
+    return (std::size_t)(next() % bound);
+  }
+
+ private:
+  uint64_t _state;
+};
+
+// The loop body of the old -[NSString fb_URLEncodedString], with
+// appendFormat: replaced by its std::string equivalent.
+std::string referenceEncode(const char *bytes, std::size_t length)
+{
+  std::string output;
+  for (std::size_t i = 0; i < length; ++i) {
+    const unsigned char currentChar = (unsigned char)bytes[i];
+    if (currentChar == ' ') {
+      output += '+';
+    } else if (currentChar == '.' || currentChar == '-' || currentChar == '_' || currentChar == '~' ||
+               (currentChar >= 'a' && currentChar <= 'z') ||
+               (currentChar >= 'A' && currentChar <= 'Z') ||
+               (currentChar >= '0' && currentChar <= '9')) {
+      output += (char)currentChar;
+    } else {
+      char escaped[4];
+      std::snprintf(escaped, sizeof(escaped), "%%%02X", currentChar);
+      output += escaped;
+    }
+  }
+  return output;
+}
+
+// Input shapes: mostly unreserved (the SIMD fast path), text with spaces,
+// URL-ish punctuation, UTF-8 heavy, and every byte value.
+std::string randomInput(Random &random, std::size_t length)
+{
+  static const char kUnreserved[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-._~";
+  static const char kPunctuation[] = " :/?#[]@!$&'()*+,;=%\"<>\\^`{|}";
+  const std::size_t shape = random.below(5);
+  std::string input;
+  input.reserve(length);
+  for (std::size_t i = 0; i < length; i++) {
+    const std::size_t roll = random.below(100);
+    char byte;
+    if (shape == 4) {
+      byte = (char)random.below(256);
+    } else if (shape == 3 && roll < 40) {
+      byte = (char)(0x80 + random.below(0x80));
+    } else if (shape == 2 && roll < 30) {
+      byte = kPunctuation[random.below(sizeof(kPunctuation) - 1)];
+    } else if (shape == 1 && roll < 15) {
+      byte = ' ';
+    } else if (shape == 0 && roll == 0) {
+      byte = (char)random.below(256);
+    } else {
+      byte = kUnreserved[random.below(sizeof(kUnreserved) - 1)];
+    }
+    input += byte;
+  }
+  return input;
+}
+
+bool check(const char *bytes, std::size_t length)
+{
+  const std::string expected = referenceEncode(bytes, length);
+  const std::size_t predicted = FBURLEncodedLength(bytes, length);
+  // Guard bytes catch writes past the predicted length.
+  std::vector<char> output(3 * length + 16, '\x5a');
+  const std::size_t written = FBURLEncode(bytes, length, output.data());
+  bool ok = predicted == expected.size() && written == expected.size() &&
+            std::memcmp(output.data(), expected.data(), expected.size()) == 0;
+  for (std::size_t i = written; ok && i < output.size(); i++) {
+    ok = output[i] == '\x5a';
+  }
+  if (!ok) {
+    std::printf("FAIL length=%zu predicted=%zu written=%zu expected=%zu input=", length, predicted, written, expected.size());
+    for (std::size_t i = 0; i < length; i++) {
+      std::printf("%02x", (unsigned char)bytes[i]);
+    }
+    std::printf("\n");
+    failures++;
+  }
+  return ok;
+}
+
+void fuzz(long iterations, uint64_t seed)
+{
+  // Every single byte, then every length around the block size at every
+  // alignment, then random inputs up to a few blocks past the tail.
+  for (int byte = 0; byte < 256; byte++) {
+    const char input = (char)byte;
+    check(&input, 1);
+  }
+  Random random(seed);
+  std::vector<char> aligned(128 + 16);
+  for (std::size_t offset = 0; offset < 16; offset++) {
+    for (std::size_t length = 0; length <= 64; length++) {
+      const std::string input = randomInput(random, length);
+      std::memcpy(aligned.data() + offset, input.data(), length);
+      check(aligned.data() + offset, length);
+    }
+  }
+  for (long i = 0; i < iterations && failures < 10; i++) {
+    const std::string input = randomInput(random, random.below(i % 100 == 0 ? 4096 : 80));
+    check(input.data(), input.size());
+  }
+}
+
+void benchmark(const char *name, const std::string &input, long repeat)
+{
+  std::vector<char> output(3 * input.size());
+  std::size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < repeat; i++) {
+    sink += FBURLEncode(input.data(), input.size(), output.data());
+  }
+  const double encoderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < repeat; i++) {
+    sink += referenceEncode(input.data(), input.size()).size();
+  }
+  const double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double megabytes = (double)input.size() * repeat / 1e6;
+  std::printf("%-12s bytes=%-6zu encoder=%8.1f MB/s  branch-chain=%7.1f MB/s%s\n", name, input.size(),
+              megabytes / encoderSeconds, megabytes / referenceSeconds, sink == 0 ? " " : "");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long iterations = 1000000;
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = std::max(0L, std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = std::strtoull(argv[++i], nullptr, 0);
+    }
+  }
+
+  fuzz(iterations, seed);
+
+  const std::string token = "1234567890|abcdefABCDEF0123456789";
+  std::string text;
+  std::string url;
+  std::string utf8;
+  for (int i = 0; i < 64; i++) {
+    text += "the quick brown fox jumps over the lazy dog ";
+    url += "https://example.com/path?a=1&b=two%20words#frag";
+    utf8 += "\xc3\xbc\xc3\xb1\xc3\xad \xe6\x97\xa5\xe6\x9c\xac ";
+  }
+  benchmark("token", token, 2000000);
+  benchmark("text", text, 20000);
+  benchmark("url", url, 20000);
+  benchmark("utf8", utf8, 20000);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Ordering and format checks for MPUUID, plus an insert/scan benchmark of
+// random (v4) against time-ordered (v7) keys in the events table.
+//
+//   c++ -std=c++14 -O2 -pthread -I SDKMeasurementPlugin/Classes -o mp_uuid_test SDKMeasurementPlugin/Tools/MPUUIDTest.cpp SDKMeasurementPlugin/Classes/MPUUID.cpp -lsqlite3
+//   ./mp_uuid_test [--rows N] [--threads T] [--seed S]
+//
+// The checks run first; any failure is printed and makes the exit status
+// non-zero. The benchmark inserts N rows keyed by each kind of id into an
+// in-memory copy of the events table, then scans them in key order.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "MPUUID.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed ? seed : 1) {}
+
+  uint64_t next()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  std::size_t below(std::size_t bound)
+  {
+    return (std::size_t)(next() % bound);
+  }
+
+ private:
+  uint64_t _state;
+};
+
+std::string format(MPUUID uuid)
+{
+  char text[MPUUIDStringLength + 1];
+  MPUUIDFormat(uuid, text);
+  return std::string(text, MPUUIDStringLength);
+}
+
+uint64_t timestampOf(MPUUID uuid)
+{
+  return uuid.high >> 16;
+}
+
+bool hasVersion(MPUUID uuid, unsigned version)
+{
+  return ((uuid.high >> 12) & 0xF) == version && (uuid.low >> 62) == 0x2;
+}
+
+// Byte order, string order and the embedded timestamp must all agree, even
+// when the clock stalls, steps back or more than 4096 ids share a
+// millisecond.
+void checkTimeOrdering(Random &random)
+{
+  uint64_t clock = 1700000000000ull;
+  MPUUID previous = MPUUIDGenerateV7(clock);
+  std::string previousText = format(previous);
+  bool ordered = true;
+  bool textOrdered = true;
+  bool versioned = hasVersion(previous, 7);
+  bool notBehindClock = timestampOf(previous) >= clock;
+  for (int i = 0; i < 200000; i++) {
+    const std::size_t roll = random.below(100);
+    uint64_t input = clock;
+    if (roll < 30) {
+      clock += 1 + random.below(5);
+      input = clock;
+    } else if (roll < 32) {
+      // A step back only affects this call; the clock itself keeps going.
+      input = clock - random.below(2000);
+    }
+    const MPUUID uuid = MPUUIDGenerateV7(input);
+    const std::string text = format(uuid);
+    ordered = ordered && previous < uuid;
+    textOrdered = textOrdered && previousText < text;
+    versioned = versioned && hasVersion(uuid, 7);
+    notBehindClock = notBehindClock && timestampOf(uuid) >= input;
+    previous = uuid;
+    previousText = text;
+  }
+  check(ordered, "v7 ids are strictly increasing");
+  check(textOrdered, "v7 strings are strictly increasing");
+  check(versioned, "v7 version and variant bits");
+  check(notBehindClock, "v7 timestamp never behind the input clock");
+
+  // 5000 ids in one millisecond overflow the 12-bit sequence into the next one.
+  clock = timestampOf(previous) + 10;
+  MPUUID first = MPUUIDGenerateV7(clock);
+  MPUUID last = first;
+  bool burstOrdered = true;
+  for (int i = 0; i < 5000; i++) {
+    const MPUUID uuid = MPUUIDGenerateV7(clock);
+    burstOrdered = burstOrdered && last < uuid;
+    last = uuid;
+  }
+  check(burstOrdered, "v7 burst is strictly increasing");
+  check(timestampOf(first) == clock, "v7 burst starts at the clock");
+  check(timestampOf(last) == clock + 1, "v7 sequence overflow carries into the timestamp");
+}
+
+// Concurrent callers never see the same id, and each thread's ids increase.
+void checkConcurrentGeneration(int threads)
+{
+  const int perThread = 50000;
+  std::vector<std::vector<MPUUID>> results((std::size_t)threads);
+  std::vector<std::thread> workers;
+  const uint64_t base = timestampOf(MPUUIDGenerateV7(0)) + 1;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&results, t, base, perThread] {
+      std::vector<MPUUID> &ids = results[(std::size_t)t];
+      ids.reserve((std::size_t)perThread);
+      for (int i = 0; i < perThread; i++) {
+        ids.push_back(MPUUIDGenerateV7(base + (uint64_t)i / 100));
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  std::vector<MPUUID> all;
+  bool perThreadOrdered = true;
+  for (const std::vector<MPUUID> &ids : results) {
+    perThreadOrdered = perThreadOrdered && std::is_sorted(ids.begin(), ids.end()) &&
+                       std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+    all.insert(all.end(), ids.begin(), ids.end());
+  }
+  std::sort(all.begin(), all.end());
+  check(perThreadOrdered, "v7 ids increase within each thread");
+  check(std::adjacent_find(all.begin(), all.end()) == all.end(), "v7 ids are unique across threads");
+}
+
+void checkFormatAndParse(Random &random)
+{
+  bool roundTrips = true;
+  bool lowercaseParses = true;
+  bool bytesRoundTrip = true;
+  bool versioned = true;
+  for (int i = 0; i < 10000; i++) {
+    const MPUUID uuid = MPUUIDGenerateV4();
+    versioned = versioned && hasVersion(uuid, 4);
+    std::string text = format(uuid);
+    MPUUID parsed = {0, 0};
+    roundTrips = roundTrips && MPUUIDParse(text.data(), text.size(), &parsed) && parsed == uuid;
+    std::transform(text.begin(), text.end(), text.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+    parsed = {0, 0};
+    lowercaseParses = lowercaseParses && MPUUIDParse(text.data(), text.size(), &parsed) && parsed == uuid;
+    uint8_t bytes[16];
+    MPUUIDGetBytes(uuid, bytes);
+    bytesRoundTrip = bytesRoundTrip && MPUUIDFromBytes(bytes) == uuid;
+  }
+  check(versioned, "v4 version and variant bits");
+  check(roundTrips, "format then parse returns the same id");
+  check(lowercaseParses, "lowercase strings parse");
+  check(bytesRoundTrip, "bytes round trip");
+
+  const uint8_t bytes[16] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+  check(format(MPUUIDFromBytes(bytes)) == "01234567-89AB-CDEF-FEDC-BA9876543210", "known bytes format");
+
+  const std::string valid = format(MPUUIDGenerateV4());
+  MPUUID untouched = {1, 2};
+  bool rejects = !MPUUIDParse(nullptr, 0, &untouched) && !MPUUIDParse(valid.data(), valid.size() - 1, &untouched);
+  for (int i = 0; i < 2000; i++) {
+    std::string broken = valid;
+    const std::size_t position = random.below(broken.size());
+    char replacement;
+    do {
+      replacement = (char)random.below(256);
+    } while (std::isxdigit((unsigned char)replacement) && broken[position] != '-');
+    if (broken[position] == '-' && replacement == '-') {
+      continue;
+    }
+    broken[position] = replacement;
+    rejects = rejects && !MPUUIDParse(broken.data(), broken.size(), &untouched);
+  }
+  check(rejects, "malformed strings are rejected");
+  check(untouched.high == 1 && untouched.low == 2, "rejected parse leaves the output untouched");
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool execute(sqlite3 *db, const char *sql)
+{
+  char *error = nullptr;
+  if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+    std::printf("FAIL sqlite: %s\n", error ? error : "unknown error");
+    sqlite3_free(error);
+    failures++;
+    return false;
+  }
+  return true;
+}
+
+// Same columns as +[MPEventManager eventTableString], minus the tokens
+// reference; the rows get a payload of typical size.
+void benchmarkTable(const char *label, const std::vector<std::string> &ids)
+{
+  sqlite3 *db = nullptr;
+  if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+    std::printf("FAIL sqlite open\n");
+    failures++;
+    return;
+  }
+  execute(db, "CREATE TABLE events(eventId TEXT PRIMARY KEY NOT NULL, tokenId TEXT, priority BIGINT, type TEXT, "
+              "time DOUBLE, sessionId TEXT, sessionStartTime DOUBLE, data TEXT, attempt BIGINT);");
+  const std::string data(200, 'x');
+  sqlite3_stmt *insert = nullptr;
+  sqlite3_prepare_v2(db, "INSERT INTO events VALUES (?, NULL, 0, 'impression', 0, 'session', 0, ?, 0);", -1, &insert, nullptr);
+  auto start = std::chrono::steady_clock::now();
+  execute(db, "BEGIN;");
+  for (const std::string &id : ids) {
+    sqlite3_bind_text(insert, 1, id.data(), (int)id.size(), SQLITE_STATIC);
+    sqlite3_bind_text(insert, 2, data.data(), (int)data.size(), SQLITE_STATIC);
+    if (sqlite3_step(insert) != SQLITE_DONE) {
+      std::printf("FAIL insert %s\n", id.c_str());
+      failures++;
+      break;
+    }
+    sqlite3_reset(insert);
+  }
+  execute(db, "COMMIT;");
+  const double insertSeconds = secondsSince(start);
+  sqlite3_finalize(insert);
+
+  sqlite3_stmt *scan = nullptr;
+  sqlite3_prepare_v2(db, "SELECT eventId, data FROM events ORDER BY eventId;", -1, &scan, nullptr);
+  start = std::chrono::steady_clock::now();
+  std::size_t rows = 0;
+  while (sqlite3_step(scan) == SQLITE_ROW) {
+    rows++;
+  }
+  const double scanSeconds = secondsSince(start);
+  sqlite3_finalize(scan);
+
+  sqlite3_int64 pages = 0;
+  sqlite3_stmt *pageCount = nullptr;
+  sqlite3_prepare_v2(db, "PRAGMA page_count;", -1, &pageCount, nullptr);
+  if (sqlite3_step(pageCount) == SQLITE_ROW) {
+    pages = sqlite3_column_int64(pageCount, 0);
+  }
+  sqlite3_finalize(pageCount);
+  sqlite3_close(db);
+
+  check(rows == ids.size(), "scan returns every inserted row");
+  std::printf("%-3s insert %8.0f rows/s  scan %9.0f rows/s  %lld pages\n", label, ids.size() / insertSeconds,
+              rows / scanSeconds, (long long)pages);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::size_t rows = 200000;
+  int threads = 4;
+  uint64_t seed = 0x5EEDull;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--rows") == 0) {
+      rows = (std::size_t)std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--threads") == 0) {
+      threads = std::atoi(argv[i + 1]);
+    } else if (std::strcmp(argv[i], "--seed") == 0) {
+      seed = std::strtoull(argv[i + 1], nullptr, 0);
+    }
+  }
+  Random random(seed);
+
+  checkFormatAndParse(random);
+  checkTimeOrdering(random);
+  checkConcurrentGeneration(threads < 1 ? 1 : threads);
+
+  // One id every few microseconds, as a burst of logged events would get.
+  std::vector<std::string> v4Ids;
+  std::vector<std::string> v7Ids;
+  v4Ids.reserve(rows);
+  v7Ids.reserve(rows);
+  const uint64_t clock = timestampOf(MPUUIDGenerateV7(0)) + 1;
+  for (std::size_t i = 0; i < rows; i++) {
+    v4Ids.push_back(format(MPUUIDGenerateV4()));
+    v7Ids.push_back(format(MPUUIDGenerateV7(clock + i / 200)));
+  }
+  benchmarkTable("v4", v4Ids);
+  benchmarkTable("v7", v7Ids);
+
+  std::printf("%s\n", failures == 0 ? "OK" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
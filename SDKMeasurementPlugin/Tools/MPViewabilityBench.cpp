@@ -0,0 +1,299 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+//
+// You are hereby granted a non-exclusive, worldwide, royalty-free license to use,
+// copy, modify, and distribute this software in source code or binary form for use
+// in connection with the web services and APIs provided by Facebook.
+//
+// As with any software that integrates with the Facebook platform, your use of
+// this software is subject to the Facebook Developer Principles and Policies
+// [http://developers.facebook.com/policy/]. This copyright notice shall be
+// included in all copies or substantial portions of the software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Measures the portable viewability engine on view hierarchy snapshots, off
+// device: a synthetic corpus of 10 to 10,000 views in three shapes, plus any
+// snapshots captured with -[MPQualityViewabilityMeasurement viewHierarchySnapshot].
+//
+//   c++ -std=c++14 -O2 -I SDKMeasurementPlugin/Classes -o mp_viewability_bench SDKMeasurementPlugin/Tools/MPViewabilityBench.cpp
+//   ./mp_viewability_bench [--repeat N] [--emit DIR] [snapshot...]
+//
+// One line per snapshot: view count, views visited, rects in the union, the
+// viewable ratio, and the time per measurement. --emit writes the synthetic
+// corpus to DIR as snapshot files.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MPViewSnapshot.hpp"
+#include "MPViewabilityEngine.hpp"
+
+namespace {
+
+constexpr double kScreenWidth = 375;
+constexpr double kScreenHeight = 812;
+
+// Fixed seed, so the corpus is the same on every run.
+class Random {
+ public:
+  explicit Random(uint64_t seed) : _state(seed) {}
+
+  double uniform(double low, double high)
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return low + (high - low) * (double)(_state >> 11) / (double)(1ULL << 53);
+  }
+
+  bool chance(double probability)
+  {
+    return uniform(0, 1) < probability;
+  }
+
+ private:
+  uint64_t _state;
+};
+
+mp::ViewRect rect(double x, double y, double width, double height)
+{
+  mp::ViewRect rect;
+  rect.x = x;
+  rect.y = y;
+  rect.width = width;
+  rect.height = height;
+  return rect;
+}
+
+mp::ViewSnapshot emptySnapshot()
+{
+  mp::ViewSnapshot snapshot;
+  snapshot.screenBounds = rect(0, 0, kScreenWidth, kScreenHeight);
+  return snapshot;
+}
+
+void leaf(mp::ViewSnapshotBuilder &builder, const mp::ViewRect &frame, float backgroundAlpha, uint8_t flags = 0)
+{
+  builder.beginView(frame, 1, backgroundAlpha, flags);
+  builder.endView();
+}
+
+void setTarget(mp::ViewSnapshot &snapshot, uint32_t index)
+{
+  snapshot.target = index;
+  snapshot.targetFrameWidth = snapshot.nodes[index].screenRect.width;
+  snapshot.targetFrameHeight = snapshot.nodes[index].screenRect.height;
+}
+
+// One window holding a grid of tiles, the target among them; the tiles after
+// it are drawn above it and about half are opaque.
+mp::ViewSnapshot flatHierarchy(std::size_t views, Random &random)
+{
+  mp::ViewSnapshot snapshot = emptySnapshot();
+  mp::ViewSnapshotBuilder builder(snapshot);
+  builder.beginView(snapshot.screenBounds, 1, 1, mp::ViewSnapshotFlagWindow);
+  const std::size_t tiles = views > 2 ? views - 2 : 1;
+  const std::size_t columns = (std::size_t)std::max(1.0, std::sqrt((double)tiles * kScreenWidth / kScreenHeight));
+  const double tileWidth = kScreenWidth / columns;
+  const double tileHeight = kScreenHeight / ((tiles + columns - 1) / columns);
+  uint32_t target = mp::kNoView;
+  for (std::size_t i = 0; i < tiles; i++) {
+    const double x = (i % columns) * tileWidth + random.uniform(-tileWidth, tileWidth);
+    const double y = (i / columns) * tileHeight + random.uniform(-tileHeight, tileHeight);
+    const mp::ViewRect frame = rect(x, y, tileWidth * random.uniform(0.5, 2), tileHeight * random.uniform(0.5, 2));
+    if (i == tiles / 2) {
+      target = builder.beginView(rect(kScreenWidth / 4, kScreenHeight / 3, kScreenWidth / 2, kScreenHeight / 4), 1, 1, 0);
+      builder.endView();
+    }
+    leaf(builder, frame, random.chance(0.5) ? 1 : 0);
+  }
+  builder.endView();
+  setTarget(snapshot, target);
+  return snapshot;
+}
+
+// Nested containers, the target at the bottom of the deepest one, each level
+// adding a sibling overlay above the path to the target.
+mp::ViewSnapshot deepHierarchy(std::size_t views, Random &random)
+{
+  mp::ViewSnapshot snapshot = emptySnapshot();
+  mp::ViewSnapshotBuilder builder(snapshot);
+  builder.beginView(snapshot.screenBounds, 1, 1, mp::ViewSnapshotFlagWindow);
+  const std::size_t depth = std::max<std::size_t>(1, (views - 1) / 2);
+  mp::ViewRect frame = snapshot.screenBounds;
+  for (std::size_t i = 0; i < depth; i++) {
+    builder.beginView(frame, 1, 0, random.chance(0.1) ? mp::ViewSnapshotFlagClipsToBounds : 0);
+    frame = rect(frame.x + random.uniform(0, 0.02), frame.y + random.uniform(0, 0.05), frame.width - 0.04, frame.height - 0.1);
+  }
+  const uint32_t target = builder.beginView(rect(frame.x, frame.y, std::max(frame.width, 100.0), std::max(frame.height, 60.0)), 1, 1, 0);
+  builder.endView();
+  for (std::size_t i = 0; i < depth; i++) {
+    leaf(builder, rect(random.uniform(0, kScreenWidth), random.uniform(0, kScreenHeight), 24, 24), random.chance(0.3) ? 1 : 0);
+    builder.endView();
+  }
+  builder.endView();
+  setTarget(snapshot, target);
+  return snapshot;
+}
+
+// A feed: a clipping scroll view of cells with a dozen subviews each, the
+// target video in a cell near the middle, a toolbar above, and a second
+// window for an overlay banner.
+mp::ViewSnapshot feedHierarchy(std::size_t views, Random &random)
+{
+  mp::ViewSnapshot snapshot = emptySnapshot();
+  mp::ViewSnapshotBuilder builder(snapshot);
+  constexpr std::size_t kCellViews = 13;
+  const std::size_t cells = std::max<std::size_t>(1, views / kCellViews);
+  const double cellHeight = 320;
+  const double offset = cells * cellHeight / 2 - kScreenHeight / 2;
+
+  builder.beginView(snapshot.screenBounds, 1, 1, mp::ViewSnapshotFlagWindow);
+  builder.beginView(snapshot.screenBounds, 1, 0, 0);
+  builder.beginView(rect(0, 88, kScreenWidth, kScreenHeight - 171), 1, 1, mp::ViewSnapshotFlagClipsToBounds);
+  uint32_t target = mp::kNoView;
+  for (std::size_t cell = 0; cell < cells; cell++) {
+    const double top = 88 + cell * cellHeight - offset;
+    builder.beginView(rect(0, top, kScreenWidth, cellHeight), 1, 1, mp::ViewSnapshotFlagClipsToBounds);
+    leaf(builder, rect(12, top + 12, 40, 40), 1, mp::ViewSnapshotFlagClipsToBounds);
+    leaf(builder, rect(60, top + 14, 200, 18), 0);
+    leaf(builder, rect(60, top + 34, 120, 14), 0);
+    if (cell == cells / 2) {
+      target = builder.beginView(rect(0, top + 60, kScreenWidth, 211), 1, 1, 0);
+      builder.endView();
+    } else {
+      leaf(builder, rect(0, top + 60, kScreenWidth, 211), 1, mp::ViewSnapshotFlagClipsToBounds);
+    }
+    // Play button and captions over the media.
+    leaf(builder, rect(kScreenWidth / 2 - 22, top + 143, 44, 44), random.chance(0.5) ? 0.6f : 0);
+    leaf(builder, rect(12, top + 240, 180, 20), 0);
+    builder.beginView(rect(0, top + 276, kScreenWidth, 44), 1, 0, 0);
+    for (int button = 0; button < 5; button++) {
+      leaf(builder, rect(12 + button * 72, top + 282, 60, 32), 0);
+    }
+    builder.endView();
+    builder.endView();
+  }
+  builder.endView();
+  leaf(builder, rect(0, kScreenHeight - 83, kScreenWidth, 83), 0.9f);
+  builder.endView();
+  builder.endView();
+
+  builder.beginView(snapshot.screenBounds, 1, 0, mp::ViewSnapshotFlagWindow);
+  leaf(builder, rect(16, 100, kScreenWidth - 32, 64), random.chance(0.5) ? 1 : 0);
+  builder.endView();
+  setTarget(snapshot, target);
+  return snapshot;
+}
+
+struct CorpusEntry {
+  std::string name;
+  mp::ViewSnapshot snapshot;
+};
+
+std::vector<CorpusEntry> syntheticCorpus()
+{
+  std::vector<CorpusEntry> corpus;
+  Random random(0x9e3779b97f4a7c15ULL);
+  const std::pair<const char *, mp::ViewSnapshot (*)(std::size_t, Random &)> shapes[] = {
+    {"flat", flatHierarchy},
+    {"deep", deepHierarchy},
+    {"feed", feedHierarchy},
+  };
+  for (const auto &shape : shapes) {
+    for (std::size_t views : {10, 100, 1000, 10000}) {
+      corpus.push_back({std::string(shape.first) + "-" + std::to_string(views), shape.second(views, random)});
+    }
+  }
+  return corpus;
+}
+
+bool readFile(const char *path, std::vector<uint8_t> &bytes)
+{
+  std::ifstream file(path, std::ios::binary);
+  bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return file.good() || file.eof();
+}
+
+bool writeFile(const std::string &path, const mp::ByteBuffer &buffer)
+{
+  std::ofstream file(path, std::ios::binary);
+  file.write((const char *)buffer.data(), (std::streamsize)buffer.size());
+  return file.good();
+}
+
+void measure(const std::string &name, const mp::ViewSnapshot &snapshot, long repeat)
+{
+  mp::ViewabilityEngine engine;
+  const float ratio = engine.viewableRatio(snapshot);
+  const std::size_t visited = engine.visitedViews();
+  const std::size_t rects = engine.unionRectCount();
+
+  float sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < repeat; i++) {
+    sink += engine.viewableRatio(snapshot);
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%-24s views=%-6zu visited=%-6zu rects=%-5zu ratio=%.4f %10.2f us/op%s\n",
+              name.c_str(), snapshot.nodes.size(), visited, rects, ratio,
+              seconds * 1e6 / repeat, sink < 0 ? " " : "");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long repeat = 100;
+  const char *emitDirectory = nullptr;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--emit") == 0 && i + 1 < argc) {
+      emitDirectory = argv[++i];
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+
+  int status = 0;
+  for (const CorpusEntry &entry : syntheticCorpus()) {
+    if (emitDirectory) {
+      mp::ByteBuffer buffer;
+      mp::writeViewSnapshot(entry.snapshot, buffer);
+      const std::string path = std::string(emitDirectory) + "/" + entry.name + ".mpvs";
+      if (!writeFile(path, buffer)) {
+        std::fprintf(stderr, "%s: cannot write\n", path.c_str());
+        status = 1;
+      }
+    }
+    measure(entry.name, entry.snapshot, repeat);
+  }
+
+  for (const char *path : paths) {
+    std::vector<uint8_t> bytes;
+    mp::ViewSnapshot snapshot;
+    if (!readFile(path, bytes) || !mp::readViewSnapshot(bytes.data(), bytes.size(), snapshot)) {
+      std::fprintf(stderr, "%s: malformed snapshot\n", path);
+      status = 1;
+      continue;
+    }
+    measure(path, snapshot, repeat);
+  }
+  return status;
+}